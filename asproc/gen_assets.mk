@@ -20,7 +20,7 @@ ASPROC_BIN=$(ASPROC_HOME)/bin/asproc
 
 define create_rule
 gen/objects/$(1).cpp: assets/objects/$(1)/$(1).gltf
-	@$(ASPROC_BIN) --convert-to-srgb -o assets/objects/$(1) gen/objects
+	@$(ASPROC_BIN) --convert-to-srgb --bake-colliders -o assets/objects/$(1) gen/objects
 endef
 
 gen/shaders/%_frag.cpp : assets/shaders/%.frag
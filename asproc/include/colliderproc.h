@@ -0,0 +1,11 @@
+#pragma once
+
+#include "common.h"
+#include "gltftypes.h"
+
+namespace colliderproc {
+// Convex hull of the mesh positions with what the engine needs to collide
+// with it, nullptr when they don't span a volume. The collider lives as long
+// as the process.
+const gltf::Collider *bakeCollider(const gltf::Mesh &mesh);
+} // namespace colliderproc
@@ -15,6 +15,10 @@ inline std::string meshName(const gltf::Mesh &mesh) {
     return common::variableName(mesh.name) + "_mesh";
 }
 
+inline std::string colliderName(const gltf::Mesh &mesh) {
+    return common::variableName(mesh.name) + "_collider";
+}
+
 inline std::string nodeName(const gltf::Node &node) {
     return common::variableName(node.name) + "_node";
 }
@@ -53,6 +57,9 @@ void exportMaterial(std::ofstream &ofs, const std::string &scope,
 void exportAnimation(std::ofstream &ofs, const std::string &scope,
                      const gltf::Animation &animation);
 
+void exportCollider(std::ofstream &ofs, const std::string &scope,
+                    const gltf::Mesh &mesh);
+
 void exportMesh(std::ofstream &ofs, const std::string &scope,
                 const gltf::Mesh &mesh);
 
@@ -3,5 +3,7 @@
 #include "common.h"
 
 namespace objectproc {
-void procObject(fs::path inputDir, fs::path outputDir, bool convertToSrgb);
+// With bakeColliders each mesh also gets a gltf::Collider of its hull.
+void procObject(fs::path inputDir, fs::path outputDir, bool convertToSrgb,
+                bool bakeColliders);
 }
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <list>
 #include <string>
 #include <vector>
@@ -43,10 +44,24 @@ struct Primitive {
     const Buffer *indices;
 };
 
+// Convex hull of a mesh baked by asproc --bake-colliders, in model space.
+struct Collider {
+    const glm::vec3 *points; // unique hull vertices
+    size_t points_size;
+    // Hull edges: the neighbours of points[i] are neighbours[offsets[i]] up to
+    // neighbours[offsets[i + 1]].
+    const uint32_t *offsets;
+    const uint32_t *neighbours;
+    size_t neighbours_size;
+    glm::vec3 min;
+    glm::vec3 max;
+};
+
 struct Mesh {
     std::string name;
     const Primitive *primitives;
     size_t primitives_size;
+    const Collider *collider; // nullptr unless baked
 };
 
 struct Node {
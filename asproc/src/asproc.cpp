@@ -22,6 +22,7 @@ int main(int argc, const char *argv[]) {
     Mode mode{Mode::NONE};
     bool flipOnLoad{false};
     bool convertToSrgb{false};
+    bool bakeColliders{false};
     if (argc < 2) {
         usage();
         return 0;
@@ -51,6 +52,8 @@ int main(int argc, const char *argv[]) {
             i += 2;
         } else if (strcmp(argv[i], "--convert-to-srgb") == 0) {
             convertToSrgb = true;
+        } else if (strcmp(argv[i], "--bake-colliders") == 0) {
+            bakeColliders = true;
         } else if (strcmp(argv[i], "-o") == 0) {
             if (i + 2 >= argc) {
                 std::cerr << "Failed to parse arguments for option -o"
@@ -124,7 +127,8 @@ int main(int argc, const char *argv[]) {
         imageproc::procImage(inputDir, outputDir, flipOnLoad, convertToSrgb);
         break;
     case Mode::OBJECTS:
-        objectproc::procObject(inputDir, outputDir, convertToSrgb);
+        objectproc::procObject(inputDir, outputDir, convertToSrgb,
+                               bakeColliders);
         break;
     case Mode::PLY:
         plyproc::procPLY(inputDir, outputDir);
@@ -0,0 +1,76 @@
+#include "colliderproc.h"
+
+#include <cstring>
+#include <list>
+
+#include "primer.h"
+#include "quickhull.h"
+
+namespace {
+constexpr int FLOAT{5126}; // GL_FLOAT
+
+// The arrays a gltf::Collider points to.
+struct ColliderData {
+    std::vector<glm::vec3> points;
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> neighbours;
+};
+
+std::vector<glm::vec3> meshPositions(const gltf::Mesh &mesh) {
+    std::vector<glm::vec3> positions;
+    for (size_t i{0}; i < mesh.primitives_size; ++i) {
+        const gltf::Primitive &primitive = mesh.primitives[i];
+        if (primitive.attributes_size == 0) {
+            continue;
+        }
+        // POSITION is the first attribute, see loadMeshes.
+        const gltf::Buffer &buffer = *primitive.attributes[0];
+        if (buffer.type != gltf::Buffer::VEC3 ||
+            buffer.componentType != FLOAT) {
+            continue;
+        }
+        const size_t count = buffer.data_size / sizeof(glm::vec3);
+        positions.resize(positions.size() + count);
+        std::memcpy(&positions[positions.size() - count], buffer.data,
+                    count * sizeof(glm::vec3));
+    }
+    return positions;
+}
+} // namespace
+
+const gltf::Collider *colliderproc::bakeCollider(const gltf::Mesh &mesh) {
+    static std::list<ColliderData> colliderData;
+    static std::list<gltf::Collider> colliders;
+
+    std::vector<uint32_t> remap;
+    lix::QuickHull hull;
+    if (!hull.build(lix::weldVertices(meshPositions(mesh), remap))) {
+        common::log("No collider for flat mesh: " + mesh.name);
+        return nullptr;
+    }
+    ColliderData &data = colliderData.emplace_back();
+    data.points = hull.vertices();
+    auto [min, max] = lix::extremePoints(data.points);
+
+    // Every edge is walked once in each direction by the two triangles
+    // along it.
+    const std::vector<uint32_t> &indices = hull.indices();
+    std::vector<std::vector<uint32_t>> adjacent(data.points.size());
+    for (size_t i{0}; i < indices.size(); i += 3) {
+        for (size_t k{0}; k < 3; ++k) {
+            adjacent[indices[i + k]].push_back(indices[i + (k + 1) % 3]);
+        }
+    }
+    data.offsets.push_back(0);
+    for (const auto &neighbours : adjacent) {
+        data.neighbours.insert(data.neighbours.end(), neighbours.begin(),
+                               neighbours.end());
+        data.offsets.push_back(static_cast<uint32_t>(data.neighbours.size()));
+    }
+
+    common::log("Collider: " + mesh.name + " " +
+                std::to_string(data.points.size()) + " points");
+    return &colliders.emplace_back(gltf::Collider{
+        data.points.data(), data.points.size(), data.offsets.data(),
+        data.neighbours.data(), data.neighbours.size(), min, max});
+}
@@ -145,6 +145,43 @@ void exportAnimation(std::ofstream &ofs, const std::string &scope,
         << "_channels, " << animation.channels_size << " \n};\n";
 }
 
+void exportCollider(std::ofstream &ofs, const std::string &scope,
+                    const gltf::Mesh &mesh) {
+    const gltf::Collider &collider = *mesh.collider;
+    const std::string name = colliderName(mesh);
+    std::string delim{""};
+    ofs << "static const glm::vec3 " << name << "_points[] = {\n";
+    for (size_t i{0}; i < collider.points_size; ++i) {
+        ofs << delim << "    ";
+        exportVec3(ofs, collider.points[i]);
+        delim = ",\n";
+    }
+    ofs << "\n};\n";
+    delim = "";
+    ofs << "static const uint32_t " << name << "_offsets[] = {";
+    for (size_t i{0}; i <= collider.points_size; ++i) {
+        ofs << delim << collider.offsets[i];
+        delim = ", ";
+    }
+    ofs << "};\n";
+    delim = "";
+    ofs << "static const uint32_t " << name << "_neighbours[] = {";
+    for (size_t i{0}; i < collider.neighbours_size; ++i) {
+        ofs << delim << collider.neighbours[i];
+        delim = ", ";
+    }
+    ofs << "};\n";
+
+    ofs << "const gltf::Collider " << scope << name << "{\n"
+        << "    " << name << "_points, " << collider.points_size << ",\n"
+        << "    " << name << "_offsets, " << name << "_neighbours, "
+        << collider.neighbours_size << ",\n    ";
+    exportVec3(ofs, collider.min);
+    ofs << ",\n    ";
+    exportVec3(ofs, collider.max);
+    ofs << "\n};\n";
+}
+
 void exportMesh(std::ofstream &ofs, const std::string &scope,
                 const gltf::Mesh &mesh) {
     std::string primitiveDelim{""};
@@ -189,7 +226,10 @@ void exportMesh(std::ofstream &ofs, const std::string &scope,
     ofs << "const gltf::Mesh " << scope << meshName(mesh) << "{\n"
         << "    \"" << mesh.name << "\",\n"
         << "    " << meshName(mesh) << "_primitives,\n"
-        << "    " << mesh.primitives_size << "\n};\n";
+        << "    " << mesh.primitives_size << ",\n"
+        << "    "
+        << (mesh.collider ? ("&" + scope + colliderName(mesh)) : "nullptr")
+        << "\n};\n";
 }
 
 void exportSkin(std::ofstream &ofs, const std::string &scope,
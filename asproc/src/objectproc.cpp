@@ -5,6 +5,7 @@
 #include <unordered_set>
 #include <vector>
 
+#include "colliderproc.h"
 #include "glm/gtc/quaternion.hpp"
 #include "gltfexport.h"
 #include "gltftypes.h"
@@ -55,6 +56,9 @@ void exportSceneDefinition(
         exportMaterial(ofs, scope, mat);
     }
     for (const auto &mesh : meshes) {
+        if (mesh.collider) {
+            exportCollider(ofs, scope, mesh);
+        }
         exportMesh(ofs, scope, mesh);
     }
     for (const auto &node : nodes) {
@@ -120,6 +124,10 @@ void exportSceneHeader(const gltf::Scene &scene, const std::string &sceneName,
         ofs << "    extern const gltf::Material " << materialName(mat) << ";\n";
     }
     for (const auto &mesh : meshes) {
+        if (mesh.collider) {
+            ofs << "    extern const gltf::Collider " << colliderName(mesh)
+                << ";\n";
+        }
         ofs << "    extern const gltf::Mesh " << meshName(mesh) << ";\n";
     }
     for (const auto &node : nodes) {
@@ -275,6 +283,9 @@ void loadBuffers(const json::Json &obj, const fs::path &filePath,
         int b = a + numBytes;
         // buffer.data.insert(buffer.data.end(), bufIt->begin() + a,
         // bufIt->begin() + b);
+        // Only read while baking, the export refers to binaryData instead.
+        buffer.data = reinterpret_cast<unsigned char *>(bufIt->data()) +
+                      static_cast<size_t>(a);
         pair.second.first = bufferIndex;
         pair.second.second = static_cast<size_t>(a);
         buffer.data_size = static_cast<size_t>(numBytes);
@@ -472,7 +483,8 @@ void loadSkins(
     }
 }
 
-void procGltf(fs::path filePath, fs::path outputDir, bool convertToSrgb) {
+void procGltf(fs::path filePath, fs::path outputDir, bool convertToSrgb,
+              bool bakeColliders) {
     json::Json obj;
 
     std::ifstream ifs{filePath};
@@ -495,6 +507,11 @@ void procGltf(fs::path filePath, fs::path outputDir, bool convertToSrgb) {
     loadBuffers(obj, filePath, buffers, bufferViews);
     // std::cout << "loading meshes" << std::endl;
     loadMeshes(obj, bufferViews, materials, meshes);
+    if (bakeColliders) {
+        for (auto &mesh : meshes) {
+            mesh.collider = colliderproc::bakeCollider(mesh);
+        }
+    }
     // std::cout << "loading animations" << std::endl;
     loadNodes(obj, meshes, nodes);
     // std::cout << "loading animations" << std::endl;
@@ -530,18 +547,19 @@ void procGltf(fs::path filePath, fs::path outputDir, bool convertToSrgb) {
 }
 
 void objectproc::procObject(fs::path inputDir, fs::path outputDir,
-                            bool convertToSrgb) {
+                            bool convertToSrgb, bool bakeColliders) {
     for (const auto &entry : fs::directory_iterator(inputDir)) {
         const auto filePath = entry.path();
         if (fs::is_directory(filePath)) {
             for (const auto &entry2 : fs::directory_iterator(filePath)) {
                 const auto filePath2 = entry2.path();
                 if (filePath2.extension().string() == ".gltf") {
-                    procGltf(filePath2, outputDir, convertToSrgb);
+                    procGltf(filePath2, outputDir, convertToSrgb,
+                             bakeColliders);
                 }
             }
         } else if (filePath.extension().string() == ".gltf") {
-            procGltf(filePath, outputDir, convertToSrgb);
+            procGltf(filePath, outputDir, convertToSrgb, bakeColliders);
         }
     }
 }
\ No newline at end of file
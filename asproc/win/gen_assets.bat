@@ -6,5 +6,5 @@ set ASPROC=%ASPROC_HOME%\bin\asproc
 
 %ASPROC% --version-override "" -s assets/shaders gen/shaders
 %ASPROC% --flip-y --convert-to-srgb -i assets/images gen/images
-%ASPROC% --convert-to-srgb -o assets/objects gen/objects
+%ASPROC% --convert-to-srgb --bake-colliders -o assets/objects gen/objects
 %ASPROC% -f assets/fonts gen/fonts
\ No newline at end of file
@@ -1,8 +1,47 @@
+#include "ecscommandbuffer.h"
 #include "ecscomponent.h"
 
+#include <mutex>
+
 uint32_t ecs::_nextComponentNumber{0};
 
 ecs::EntityRegistry &ecs::EntityRegistry::instance() {
     static ecs::EntityRegistry entityRegistry;
     return entityRegistry;
-}
\ No newline at end of file
+}
+
+namespace {
+std::mutex &buffersMutex() {
+    static std::mutex mutex;
+    return mutex;
+}
+
+std::vector<ecs::CommandBuffer *> &buffers() {
+    static std::vector<ecs::CommandBuffer *> commandBuffers;
+    return commandBuffers;
+}
+} // namespace
+
+ecs::CommandBuffer::~CommandBuffer() noexcept {
+    std::lock_guard<std::mutex> lock{buffersMutex()};
+    auto &list = buffers();
+    list.erase(std::remove(list.begin(), list.end(), this), list.end());
+}
+
+ecs::CommandBuffer &ecs::CommandBuffer::local() {
+    thread_local ecs::CommandBuffer commandBuffer;
+    thread_local bool registered{[]() {
+        std::lock_guard<std::mutex> lock{buffersMutex()};
+        buffers().push_back(&commandBuffer);
+        return true;
+    }()};
+    (void)registered;
+    return commandBuffer;
+}
+
+void ecs::CommandBuffer::applyAll() {
+    std::lock_guard<std::mutex> lock{buffersMutex()};
+    for (ecs::CommandBuffer *commandBuffer : buffers()) {
+        commandBuffer->apply();
+    }
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "ecsentity.h"
+
+namespace ecs {
+// Append-only list of the entities whose component changed, read by the
+// systems that subscribe to it. Every subscriber owns a cursor into the log.
+// Entries all subscribers have read are dropped. A subscriber that falls
+// too far behind loses its entries and has to rescan instead.
+class ChangeLog {
+  public:
+    using Cursor = uint64_t;
+
+    static constexpr size_t MIN_CAPACITY{4096};
+    static constexpr size_t MAX_CAPACITY{size_t{1} << 22};
+
+    ChangeLog() : _entries{}, _subscribers{} {}
+
+    ChangeLog(const ChangeLog &other) = delete;
+    ChangeLog &operator=(const ChangeLog &other) = delete;
+
+    void record(Entity entity) {
+        if (_subscribers.empty()) {
+            return;
+        }
+        _entries.push_back(entity);
+        if (_entries.size() >= _capacity) {
+            trim();
+        }
+    }
+
+    // Forgets every entry; all subscribers have to rescan.
+    void invalidate() {
+        if (_subscribers.empty()) {
+            return;
+        }
+        _base += _entries.size() + 1;
+        _entries.clear();
+    }
+
+    Cursor end() const { return _base + _entries.size(); }
+
+    // Calls callback for every entity recorded since cursor. Returns false if
+    // those entries are gone, in which case nothing is called.
+    template <typename F> bool since(Cursor cursor, F &&callback) const {
+        if (cursor < _base) {
+            return false;
+        }
+        for (size_t i = static_cast<size_t>(cursor - _base);
+             i < _entries.size(); ++i) {
+            callback(_entries[i]);
+        }
+        return true;
+    }
+
+    // The subscriber starts out behind, so its first read asks for a rescan.
+    void subscribe(Cursor *cursor) {
+        *cursor = 0;
+        _subscribers.push_back(cursor);
+    }
+
+    void unsubscribe(Cursor *cursor) {
+        _subscribers.erase(
+            std::remove(_subscribers.begin(), _subscribers.end(), cursor),
+            _subscribers.end());
+    }
+
+  private:
+    void trim() {
+        Cursor oldest = end();
+        for (const Cursor *cursor : _subscribers) {
+            oldest = std::max(std::min(oldest, *cursor), _base);
+        }
+        size_t consumed = static_cast<size_t>(oldest - _base);
+        _entries.erase(_entries.begin(), _entries.begin() + consumed);
+        _base += consumed;
+        if (_entries.size() * 2 >= _capacity) {
+            _capacity *= 2;
+        }
+        if (_capacity > MAX_CAPACITY) {
+            // Too far behind to be worth keeping; laggards rescan.
+            invalidate();
+            _capacity = MIN_CAPACITY;
+        }
+    }
+
+    std::vector<Entity> _entries;
+    std::vector<Cursor *> _subscribers;
+    Cursor _base{1}; // cursor of _entries[0], 0 means "never read"
+    size_t _capacity{MIN_CAPACITY};
+};
+} // namespace ecs
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+#include "ecsentity.h"
+
+namespace ecs {
+// Records structural changes (create, destroy, attach, detach, set) so that
+// they can be made from inside a System callback and applied later, at a
+// sync point, in one pass sorted by entity. Use one buffer per thread, see
+// CommandBuffer::local().
+class CommandBuffer {
+  public:
+    // Handle to an entity that will be created when the buffer is applied.
+    struct Pending {
+        uint32_t id;
+    };
+
+    CommandBuffer() : _commands{}, _payloads{} {}
+    ~CommandBuffer() noexcept;
+
+    CommandBuffer(const CommandBuffer &other) = delete;
+    CommandBuffer &operator=(const CommandBuffer &other) = delete;
+
+    Pending create() { return {_creates++}; }
+
+    void destroy(Entity entity) { record(Op::DESTROY, entity, false); }
+
+    template <class C> void attach(Entity entity) {
+        record(Op::APPLY, entity, false, &attachComponent<C>);
+    }
+
+    template <class C> void attach(Pending pending) {
+        record(Op::APPLY, pending.id, true, &attachComponent<C>);
+    }
+
+    template <class C> void detach(Entity entity) {
+        record(Op::APPLY, entity, false, &detachComponent<C>);
+    }
+
+    template <class C>
+    void set(Entity entity, const typename C::value_type &value) {
+        record(Op::APPLY, entity, false, &setComponent<C>, &value,
+               sizeof(value));
+    }
+
+    template <class C>
+    void set(Pending pending, const typename C::value_type &value) {
+        record(Op::APPLY, pending.id, true, &setComponent<C>, &value,
+               sizeof(value));
+    }
+
+    bool empty() const { return _commands.empty() && _creates == 0; }
+
+    // Applies and clears the recorded commands. Returns the created entities
+    // indexed by Pending::id. Commands on entities that are no longer alive
+    // are dropped.
+    std::vector<Entity> apply();
+
+    // The calling thread's buffer.
+    static CommandBuffer &local();
+
+    // Applies every thread's buffer. Must not race with recording.
+    static void applyAll();
+
+  private:
+    enum class Op : uint8_t { DESTROY, APPLY };
+    using Apply = void (*)(Entity, const unsigned char *);
+
+    struct Command {
+        Op op;
+        bool pending;
+        uint32_t target;
+        Apply apply;
+        size_t payload;
+    };
+
+    void record(Op op, uint32_t target, bool pending, Apply apply = nullptr,
+                const void *data = nullptr, size_t size = 0) {
+        size_t payload = _payloads.size();
+        if (size > 0) {
+            _payloads.resize(payload + size);
+            std::memcpy(_payloads.data() + payload, data, size);
+        }
+        _commands.push_back({op, pending, target, apply, payload});
+    }
+
+    template <class C>
+    static void attachComponent(Entity entity, const unsigned char *) {
+        C::attach(entity);
+    }
+
+    template <class C>
+    static void detachComponent(Entity entity, const unsigned char *) {
+        C::detach(entity);
+    }
+
+    template <class C>
+    static void setComponent(Entity entity, const unsigned char *data) {
+        using T = typename C::value_type;
+        static_assert(std::is_trivially_copyable_v<T>,
+                      "ecs::CommandBuffer: set() needs a trivially copyable "
+                      "component");
+        T value;
+        std::memcpy(&value, data, sizeof(T));
+        C::set(value, entity);
+    }
+
+    std::vector<Command> _commands;
+    std::vector<unsigned char> _payloads;
+    uint32_t _creates{0};
+};
+
+inline std::vector<Entity> CommandBuffer::apply() {
+    auto &registry = EntityRegistry::instance();
+    std::vector<Entity> created(_creates);
+    for (auto &entity : created) {
+        entity = EntityRegistry::createEntity();
+    }
+    for (auto &command : _commands) {
+        if (command.pending) {
+            command.target = created[command.target];
+            command.pending = false;
+        }
+    }
+    // Group edits by entity so that each entity's mask and component pages
+    // are touched once, keeping the recorded order per entity.
+    std::stable_sort(_commands.begin(), _commands.end(),
+                     [](const Command &a, const Command &b) {
+                         return entityIndex(a.target) < entityIndex(b.target);
+                     });
+    for (const auto &command : _commands) {
+        if (!registry.alive(command.target)) {
+            continue;
+        }
+        if (command.op == Op::DESTROY) {
+            EntityRegistry::destroyEntity(command.target);
+        } else {
+            command.apply(command.target, _payloads.data() + command.payload);
+        }
+    }
+    _commands.clear();
+    _payloads.clear();
+    _creates = 0;
+    return created;
+}
+} // namespace ecs
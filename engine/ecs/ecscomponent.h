@@ -1,7 +1,9 @@
 #pragma once
 
+#include "ecschangelog.h"
 #include "ecsconstants.h"
 #include "ecsentity.h"
+#include "ecsstorage.h"
 #include <algorithm>
 #include <iostream>
 #include <vector>
@@ -14,26 +16,27 @@ extern uint32_t _nextComponentNumber;
 template <class T, uint32_t Variant = 0, bool Static = false> class Component {
   public:
     using value_type = T;
+    static constexpr bool is_static = Static;
 
     Component() {}
 
     static void attach(Entity entity) {
-        /*if(_bitSignature == 0)
-        {
-            //_number = _nextComponentNumber++;
-            //_bitSignature = (1 << _number);
-            if(_number >= 32)
-            {
-                std::cerr << "Error: Reached maximum amount of Components. (32).
-        Consider chaning underlying type to uint64_t." << std::endl; exit(1);
-            }
-        }*/
 #ifdef ECS_TRACE
         std::cout << "attaching component#" << _number << " b" << bitSignature()
                   << " " << typeid(T).name() << std::endl;
 #endif
+        uint32_t index = entityIndex(entity);
+        _ts.ensure(Static ? 0 : index);
+        _versions.ensure(index);
+        if (!has(entity)) {
+            // The slot may be recycled from a destroyed entity.
+            if (!Static) {
+                _ts[index] = T{};
+            }
+            ++_versions[index];
+            _changes.record(entity);
+        }
         EntityRegistry::instance().addComponent(entity, bitSignature());
-        //_ts.push_back(T{});
     }
 
     template <typename... Args>
@@ -47,66 +50,92 @@ template <class T, uint32_t Variant = 0, bool Static = false> class Component {
     }
 
     static void detach(Entity entity) {
-        // assert(_bitSignature != 0);
         EntityRegistry::instance().removeComponent(entity, bitSignature());
-        //_ts.push_back(T{}); REMOVE?!!
     }
 
-    static void increment(Entity entity, bool dirty) {
+    // record=false leaves the change log alone; see recordChange().
+    static void increment(Entity entity, bool dirty, bool record = true) {
         if (dirty) {
-            ++_versions[entity];
+            ++_versions[entityIndex(entity)];
+            if (record) {
+                _changes.record(entity);
+            }
 #ifdef ECS_TRACE
-            std::cout << "component#" << _number
-                      << " version=" << (int)_versions[entity.id()] << " "
+            std::cout << "component#" << _number << " version="
+                      << (int)_versions[entityIndex(entity)] << " "
                       << typeid(T).name() << std::endl;
 #endif
         }
     }
 
-    static T &get(size_t index = 0) { return Static ? _ts[0] : _ts[index]; }
+    static void recordChange(Entity entity) { _changes.record(entity); }
 
-    static void set(T &t, size_t index = 0) {
+    // A component that was never attached or set reads as T{}.
+    static T &get(Entity entity = 0) {
+        uint32_t index = Static ? 0 : entityIndex(entity);
+        _ts.ensure(index);
+        return _ts[index];
+    }
+
+    static void set(T &t, Entity entity = 0) {
         if (Static) {
+            _ts.ensure(0);
             _ts[0] = t;
             refreshAll();
         } else {
+            uint32_t index = entityIndex(entity);
+            _ts.ensure(index);
+            _versions.ensure(index);
             _ts[index] = t;
             ++_versions[index];
+            _changes.record(entity);
         }
     }
 
-    static uint8_t version(size_t index = 0) { return _versions[index]; }
+    static Version version(Entity entity = 0) {
+        return _versions[entityIndex(entity)];
+    }
 
-    static bool compare(Entity entity, const uint8_t &version) {
-        return _versions[entity] == version;
+    static bool compare(Entity entity, const Version &version) {
+        return _versions[entityIndex(entity)] == version;
     }
 
     static void refreshAll() {
-        for (auto i{0}; i < ecs::GLOBAL_MAX_ENTITIES; ++i) {
-            refresh(i);
+        for (size_t i{0}; i < _versions.capacity(); ++i) {
+            ++_versions[i];
         }
+        _changes.invalidate();
     }
 
-    static void refresh(size_t index = 0) {
-        ++_versions[index];
+    static void refresh(Entity entity = 0) {
+        ++_versions[entityIndex(entity)];
+        _changes.record(entity);
         // std::cout << "component#" << _number << " version=" <<
         // (int)_versions[index] << std::endl;
     }
 
-    static uint32_t bitSignature() {
-        if (_bitSignature == 0) {
-            _bitSignature = (1 << _number);
+    static Signature bitSignature() {
+        if (_bitSignature == Signature{}) {
+            if (_number >= static_cast<uint32_t>(ecs::GLOBAL_MAX_COMPONENTS)) {
+                std::cerr << "Error: Reached maximum amount of Components ("
+                          << ecs::GLOBAL_MAX_COMPONENTS
+                          << "). Consider raising ECS_MAX_COMPONENTS."
+                          << std::endl;
+                exit(1);
+            }
+            _bitSignature = signatureBit(_number);
         }
         return _bitSignature;
     }
 
     static uint32_t _number;
-    static T _ts[];
-    static uint8_t
-        _versions[]; // Version of this component for a specific entity.
+    static PagedStorage<T, Static ? 0 : ecs::COMPONENT_PAGE_SHIFT> _ts;
+    static PagedStorage<Version>
+        _versions; // Version of this component for a specific entity.
+    static ChangeLog _changes; // Entities whose version was bumped.
 
   private:
-    static uint32_t _bitSignature;
+    static Signature _bitSignature;
 };
 
 template <typename... T> void attach(Entity entity) {
@@ -116,17 +145,19 @@ template <typename... T> void attach(Entity entity) {
 /*template <class T, uint32_t U>
 std::vector<T> Component<T,U>::_ts{};*/
 template <class T, uint32_t Variant, bool Static>
-T Component<T, Variant, Static>::_ts[Static ? 1 : ecs::GLOBAL_MAX_ENTITIES] =
-    {};
+PagedStorage<T, Static ? 0 : ecs::COMPONENT_PAGE_SHIFT>
+    Component<T, Variant, Static>::_ts{};
+
+template <class T, uint32_t Variant, bool Static>
+PagedStorage<Version> Component<T, Variant, Static>::_versions{};
 
 template <class T, uint32_t Variant, bool Static>
-uint8_t Component<T, Variant, Static>::_versions[ecs::GLOBAL_MAX_ENTITIES] = {};
+ChangeLog Component<T, Variant, Static>::_changes{};
 
 template <class T, uint32_t Variant, bool Static>
 uint32_t Component<T, Variant, Static>::_number{_nextComponentNumber++};
 
 template <class T, uint32_t Variant, bool Static>
-uint32_t Component<T, Variant, Static>::_bitSignature{
-    0}; //(uint32_t)((uint32_t)0x00000001 << (uint32_t)_number)}; This doesn't
-        //work on Windows.
+Signature Component<T, Variant, Static>::_bitSignature{}; // lazy, depends on
+                                                          // _number
 } // namespace ecs
\ No newline at end of file
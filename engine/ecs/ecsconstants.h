@@ -1,6 +1,16 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+
+#ifndef ECS_MAX_COMPONENTS
+#define ECS_MAX_COMPONENTS 64
+#endif
+
 namespace ecs {
-static constexpr int GLOBAL_MAX_ENTITIES{100};
-static constexpr int GLOBAL_MAX_COMPONENTS{32};
+static constexpr size_t COMPONENT_PAGE_SHIFT{10}; // 1024 entities per page
+static constexpr unsigned ENTITY_INDEX_BITS{20}; // rest is the generation
+static constexpr int GLOBAL_MAX_COMPONENTS{ECS_MAX_COMPONENTS};
+
+using Version = uint32_t; // wide enough that a stale version never aliases
 } // namespace ecs
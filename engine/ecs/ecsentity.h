@@ -1,14 +1,109 @@
 #pragma once
 
+#include <algorithm>
+#include <cassert>
 #include <cstdint>
 #include <vector>
 
+#include "ecsconstants.h"
+#include "ecssignature.h"
+
 namespace ecs {
+// Low ENTITY_INDEX_BITS are the slot, the rest is the generation of the slot.
+// A fresh slot has generation 0, so its handle equals its index.
 using Entity = uint32_t;
 
+static constexpr Entity ENTITY_INDEX_MASK{(Entity{1} << ENTITY_INDEX_BITS) -
+                                          1};
+
+inline constexpr uint32_t entityIndex(Entity entity) {
+    return entity & ENTITY_INDEX_MASK;
+}
+
+inline constexpr uint32_t entityGeneration(Entity entity) {
+    return entity >> ENTITY_INDEX_BITS;
+}
+
+inline constexpr Entity makeEntity(uint32_t index, uint32_t generation) {
+    return (generation << ENTITY_INDEX_BITS) | index;
+}
+
+// Packed list of the entities whose mask contains a given signature. Kept up
+// to date by the EntityRegistry as components are attached and detached, so
+// a query never has to look at entities that don't match it.
+class QueryIndex {
+  public:
+    QueryIndex(Signature mask) : _mask{mask}, _entities{}, _slots{} {}
+
+    Signature mask() const { return _mask; }
+
+    void onMaskChanged(Entity entity, Signature before, Signature after) {
+        bool had = (before & _mask) == _mask;
+        bool has = (after & _mask) == _mask;
+        if (had == has) {
+            return;
+        }
+        if (has) {
+            insert(entity);
+        } else {
+            erase(entity);
+        }
+    }
+
+    // Matching entities in ascending slot order, so that component pages are
+    // visited front to back.
+    const std::vector<Entity> &entities() {
+        if (_unsorted) {
+            std::sort(_entities.begin(), _entities.end(),
+                      [](Entity a, Entity b) {
+                          return entityIndex(a) < entityIndex(b);
+                      });
+            for (uint32_t i{0}; i < _entities.size(); ++i) {
+                _slots[entityIndex(_entities[i])] = i;
+            }
+            _unsorted = false;
+        }
+        return _entities;
+    }
+
+  private:
+    static constexpr uint32_t NO_SLOT{UINT32_MAX};
+
+    void insert(Entity entity) {
+        uint32_t index = entityIndex(entity);
+        if (index >= _slots.size()) {
+            _slots.resize(index + 1, NO_SLOT);
+        }
+        if (!_entities.empty() && entityIndex(_entities.back()) > index) {
+            _unsorted = true;
+        }
+        _slots[index] = static_cast<uint32_t>(_entities.size());
+        _entities.push_back(entity);
+    }
+
+    void erase(Entity entity) {
+        uint32_t index = entityIndex(entity);
+        uint32_t slot = _slots[index];
+        Entity last = _entities.back();
+        _entities[slot] = last;
+        _slots[entityIndex(last)] = slot;
+        _entities.pop_back();
+        _slots[index] = NO_SLOT;
+        if (slot != _entities.size()) {
+            _unsorted = true;
+        }
+    }
+
+    Signature _mask;
+    std::vector<Entity> _entities;
+    std::vector<uint32_t> _slots; // entity index -> index in _entities
+    bool _unsorted{false};
+};
+
 class EntityRegistry {
   public:
-    EntityRegistry() : _componentMasks{}, _nextId{0} {}
+    EntityRegistry()
+        : _componentMasks{}, _entities{}, _freeList{}, _queries{} {}
 
     virtual ~EntityRegistry() noexcept {}
 
@@ -20,20 +115,55 @@ class EntityRegistry {
 
     EntityRegistry &operator=(EntityRegistry &&other) = delete;
 
-    void addComponent(uint32_t id, uint32_t componentId) {
-        _componentMasks[id] |= componentId;
+    void addComponent(Entity id, Signature componentId) {
+        assert(alive(id));
+        uint32_t index = entityIndex(id);
+        Signature before = _componentMasks[index];
+        _componentMasks[index] |= componentId;
+        notifyQueries(id, before);
     }
 
-    void removeComponent(uint32_t id, uint32_t componentId) {
-        _componentMasks[id] &= ~componentId;
+    void removeComponent(Entity id, Signature componentId) {
+        assert(alive(id));
+        uint32_t index = entityIndex(id);
+        Signature before = _componentMasks[index];
+        _componentMasks[index] &= ~componentId;
+        notifyQueries(id, before);
     }
 
-    bool hasComponents(uint32_t id, uint32_t component) const {
-        return (_componentMasks[id] & component) == component;
+    // Starts tracking query and fills it with the entities that already
+    // match. The index must outlive the registry.
+    void registerQuery(QueryIndex *query) {
+        for (uint32_t index{0}; index < _entities.size(); ++index) {
+            query->onMaskChanged(_entities[index], Signature{},
+                                 _componentMasks[index]);
+        }
+        _queries.push_back(query);
     }
 
+    // False for destroyed entities and for stale handles to recycled slots.
+    bool hasComponents(Entity id, Signature component) const {
+        uint32_t index = entityIndex(id);
+        return _entities[index] == id &&
+               (_componentMasks[index] & component) == component;
+    }
+
+    bool alive(Entity id) const {
+        uint32_t index = entityIndex(id);
+        return index < _entities.size() && _entities[index] == id;
+    }
+
+    // Number of slots ever handed out, live or free.
+    size_t slots() const { return _entities.size(); }
+
     static Entity createEntity() { return instance().create(); }
 
+    // Detaches every component and recycles the slot under a new
+    // generation. Returns false if entity was already destroyed.
+    static bool destroyEntity(Entity entity) {
+        return instance().destroy(entity);
+    }
+
     static EntityRegistry &instance();
 
     template <typename T> static typename T::value_type *get(uint32_t id) {
@@ -50,13 +180,45 @@ class EntityRegistry {
     }
 
   private:
+    void notifyQueries(Entity id, Signature before) {
+        Signature after = _componentMasks[entityIndex(id)];
+        if (before == after) {
+            return;
+        }
+        for (QueryIndex *query : _queries) {
+            query->onMaskChanged(id, before, after);
+        }
+    }
+
     Entity create() {
-        Entity e = _nextId++;
-        _componentMasks.emplace_back(0);
-        return e;
+        if (!_freeList.empty()) {
+            uint32_t index = _freeList.back();
+            _freeList.pop_back();
+            return _entities[index];
+        }
+        uint32_t index = static_cast<uint32_t>(_entities.size());
+        assert(index <= ENTITY_INDEX_MASK);
+        _componentMasks.emplace_back();
+        return _entities.emplace_back(makeEntity(index, 0));
+    }
+
+    bool destroy(Entity entity) {
+        if (!alive(entity)) {
+            return false;
+        }
+        uint32_t index = entityIndex(entity);
+        Signature before = _componentMasks[index];
+        _componentMasks[index] = Signature{};
+        notifyQueries(entity, before);
+        // The generation wraps around once it runs out of bits.
+        _entities[index] = makeEntity(index, entityGeneration(entity) + 1);
+        _freeList.push_back(index);
+        return true;
     }
 
-    std::vector<uint32_t> _componentMasks;
-    Entity _nextId;
+    std::vector<Signature> _componentMasks; // by entity index
+    std::vector<Entity> _entities;          // current handle of every slot
+    std::vector<uint32_t> _freeList;
+    std::vector<QueryIndex *> _queries;
 };
-} // namespace ecs
\ No newline at end of file
+} // namespace ecs
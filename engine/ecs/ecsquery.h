@@ -0,0 +1,38 @@
+#pragma once
+
+#include <type_traits>
+#include <vector>
+
+#include "ecsentity.h"
+
+namespace ecs {
+// Iterates only the entities that have all of T..., using a packed entity list
+// that the EntityRegistry maintains on attach/detach. The callback is a
+// template parameter so it can be inlined into the loop.
+template <class... T> class Query {
+  public:
+    template <typename F> static void forEach(F &&callback) {
+        for (ecs::Entity entity : entities()) {
+            callback(entity, T::get(entity)...);
+        }
+    }
+
+    static const std::vector<ecs::Entity> &entities() {
+        return index().entities();
+    }
+
+    static Signature mask() { return (T::bitSignature() | ...); }
+
+  private:
+    static QueryIndex &index() {
+        static QueryIndex queryIndex{mask()};
+        static bool registered{
+            (EntityRegistry::instance().registerQuery(&queryIndex), true)};
+        (void)registered;
+        return queryIndex;
+    }
+};
+
+template <class... T>
+using QueryOf = Query<std::remove_const_t<T>...>; // const T shares the index
+} // namespace ecs
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <ostream>
+#include <type_traits>
+
+#include "ecsconstants.h"
+
+namespace ecs {
+// Fixed-width bit set for more than 64 components. The words are kept in a
+// plain array so that AND/compare loops vectorize.
+template <size_t Words> struct WideSignature {
+    std::array<uint64_t, Words> words{};
+
+    WideSignature operator&(const WideSignature &other) const {
+        WideSignature rval;
+        for (size_t i{0}; i < Words; ++i) {
+            rval.words[i] = words[i] & other.words[i];
+        }
+        return rval;
+    }
+
+    WideSignature operator|(const WideSignature &other) const {
+        WideSignature rval;
+        for (size_t i{0}; i < Words; ++i) {
+            rval.words[i] = words[i] | other.words[i];
+        }
+        return rval;
+    }
+
+    WideSignature operator~() const {
+        WideSignature rval;
+        for (size_t i{0}; i < Words; ++i) {
+            rval.words[i] = ~words[i];
+        }
+        return rval;
+    }
+
+    WideSignature &operator&=(const WideSignature &other) {
+        return *this = *this & other;
+    }
+
+    WideSignature &operator|=(const WideSignature &other) {
+        return *this = *this | other;
+    }
+
+    bool operator==(const WideSignature &other) const {
+        uint64_t diff{0};
+        for (size_t i{0}; i < Words; ++i) {
+            diff |= words[i] ^ other.words[i];
+        }
+        return diff == 0;
+    }
+
+    bool operator!=(const WideSignature &other) const {
+        return !(*this == other);
+    }
+};
+
+// Hex, most significant word first, for ECS_TRACE.
+template <size_t Words>
+std::ostream &operator<<(std::ostream &os,
+                         const WideSignature<Words> &signature) {
+    const std::ios_base::fmtflags flags = os.flags();
+    const char fill = os.fill('0');
+    os << "0x" << std::hex;
+    for (size_t i{Words}; i-- > 0;) {
+        os << std::setw(16) << signature.words[i];
+    }
+    os.fill(fill);
+    os.flags(flags);
+    return os;
+}
+
+// Smallest type able to hold GLOBAL_MAX_COMPONENTS bits. Set
+// ECS_MAX_COMPONENTS at compile time to change it.
+using Signature = std::conditional_t<
+    (GLOBAL_MAX_COMPONENTS <= 32), uint32_t,
+    std::conditional_t<(GLOBAL_MAX_COMPONENTS <= 64), uint64_t,
+                       WideSignature<(GLOBAL_MAX_COMPONENTS + 63) / 64>>>;
+
+template <class S = Signature> inline S signatureBit(uint32_t number) {
+    if constexpr (std::is_integral_v<S>) {
+        return S{1} << number;
+    } else {
+        S rval{};
+        rval.words[number / 64] = uint64_t{1} << (number % 64);
+        return rval;
+    }
+}
+} // namespace ecs
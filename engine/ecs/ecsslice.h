@@ -2,6 +2,8 @@
 
 #include <functional>
 
+#include "ecsquery.h"
+
 namespace ecs {
 template <class... T> class Slice {
   public:
@@ -17,6 +19,12 @@ template <class... T> class Slice {
         }
     }
 
-    static uint32_t mask() { return (T::bitSignature() + ...); }
+    // Visits every matching entity through the packed query index instead of
+    // scanning an entity list.
+    template <typename F> static void forEach(F &&callback) {
+        QueryOf<T...>::forEach(callback);
+    }
+
+    static Signature mask() { return (T::bitSignature() | ...); }
 };
-} // namespace ecs
\ No newline at end of file
+} // namespace ecs
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "ecsconstants.h"
+
+namespace ecs {
+// Growable storage split into fixed-size pages. Pages are never moved once
+// allocated, so references to stored elements stay valid while the storage
+// grows. Lookup is a shift and a mask.
+template <class T, size_t PageShift = ecs::COMPONENT_PAGE_SHIFT>
+class PagedStorage {
+  public:
+    static constexpr size_t PAGE_SIZE{size_t{1} << PageShift};
+    static constexpr size_t PAGE_MASK{PAGE_SIZE - 1};
+
+    PagedStorage() : _pages{} {}
+
+    PagedStorage(const PagedStorage &other) = delete;
+    PagedStorage &operator=(const PagedStorage &other) = delete;
+
+    T &operator[](size_t index) {
+        return _pages[index >> PageShift][index & PAGE_MASK];
+    }
+
+    const T &operator[](size_t index) const {
+        return _pages[index >> PageShift][index & PAGE_MASK];
+    }
+
+    // Makes sure index is addressable, allocating pages as needed.
+    void ensure(size_t index) {
+        size_t page = index >> PageShift;
+        if (page < _pages.size() && _pages[page]) {
+            return;
+        }
+        if (page >= _pages.size()) {
+            _pages.resize(page + 1);
+        }
+        for (auto &p : _pages) {
+            if (!p) {
+                p.reset(new T[PAGE_SIZE]{});
+            }
+        }
+    }
+
+    bool contains(size_t index) const {
+        size_t page = index >> PageShift;
+        return page < _pages.size() && _pages[page] != nullptr;
+    }
+
+    size_t capacity() const { return _pages.size() * PAGE_SIZE; }
+
+  private:
+    std::vector<std::unique_ptr<T[]>> _pages;
+};
+} // namespace ecs
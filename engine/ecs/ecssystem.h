@@ -1,19 +1,34 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <iostream>
+#include <type_traits>
 #include <typeinfo>
+#include <utility>
 #include <vector>
 
 #include "ecscomponent.h"
 #include "ecsconstants.h"
 #include "ecsentity.h"
 #include "ecsslice.h"
+#include "ecsstorage.h"
+#include "glthreadpool.h"
 
 namespace ecs {
 
 template <class... T> class System : public Slice<T...> {
   public:
-    System() : _versions{} {}
+    System() : _versions{}, _cursors{}, _changed{} {}
+
+    // The change logs hold on to the addresses of _cursors.
+    System(const System &other) = delete;
+
+    System(System &&other) = delete;
+
+    System &operator=(const System &other) = delete;
+
+    System &operator=(System &&other) = delete;
 
     void update(std::vector<ecs::Entity> &entities,
                 std::function<void(ecs::Entity, typename T::value_type &...)>
@@ -21,38 +36,162 @@ template <class... T> class System : public Slice<T...> {
         auto mask = Slice<T...>::mask();
         for (ecs::Entity entity : entities) {
             if (EntityRegistry::instance().hasComponents(entity, mask)) {
-                // bool test = ((_versions[entityId][T::_number] !=
-                // T::version(entityId)) && ...);
-                bool test =
-                    (T::compare(entity, _versions[entity][T::_number]) && ...);
-#ifdef ECS_TRACE
-                // std::cout << "ecs::System: Testing mask=" << mask << ",
-                // entity=" << entityId << ": " << (test ? "[ ]" : "[X]") <<
-                // std::endl;
-#endif
-                if (!test) // Check if NOT all versions match
-                {
-#ifdef ECS_TRACE
-                    std::cout << "ecs::System: Updating mask=" << mask
-                              << ", entity=" << entityId << std::endl;
-#endif
-                    (callback(entity, T::get(entity)...));
-                    (T::increment(entity, std::is_const_v<T> == false),
-                     ...); // Increment version of NON-const components
-                    (setVersion(entity, T::_number, T::version(entity)),
-                     ...); // Update own version to match latest-greatest.
+                visit<true>(entity, callback, Slots{});
+            }
+        }
+    }
+
+    // Same as above, but only visits the entities in the query index for T...
+    template <typename F> void update(F &&callback) {
+        for (ecs::Entity entity : QueryOf<T...>::entities()) {
+            visit<true>(entity, callback, Slots{});
+        }
+    }
+
+    // Only visits the entities where one of T... changed since the last
+    // call, read from the components' change logs. Falls back to a full
+    // update(callback) on the first call, after a Static component was set,
+    // or when this system fell too far behind.
+    template <typename F> void updateChanged(F &&callback) {
+        subscribe(Slots{});
+        _changed.clear();
+        bool complete = collectChanges(Slots{});
+        if (!complete) {
+            update(callback);
+            return;
+        }
+        std::sort(_changed.begin(), _changed.end());
+        _changed.erase(std::unique(_changed.begin(), _changed.end()),
+                       _changed.end());
+        auto &registry = EntityRegistry::instance();
+        auto mask = QueryOf<T...>::mask();
+        for (ecs::Entity entity : _changed) {
+            if (registry.alive(entity) &&
+                registry.hasComponents(entity, mask)) {
+                visit<true>(entity, callback, Slots{});
+            }
+        }
+    }
+
+    // Opt-in parallel version of update(callback). The matching entities are
+    // split into chunks that run on pool, each entity on exactly one thread,
+    // so callback must not touch other entities' components.
+    template <typename F>
+    void updateParallel(F &&callback,
+                        lix::ThreadPool &pool = lix::ThreadPool::global(),
+                        size_t chunkSize = 1024) {
+        static_assert(((std::is_const_v<T> || !T::is_static) && ...),
+                      "ecs::System: static components are shared by all "
+                      "entities and must be const in a parallel update");
+        const auto &entities = QueryOf<T...>::entities();
+        if (entities.empty()) {
+            return;
+        }
+        // Entities are sorted, so this allocates every page up front and no
+        // worker has to grow the version table or the components.
+        _versions.ensure(entityIndex(entities.back()));
+        (T::get(entities.back()), ...);
+        size_t numChunks = (entities.size() + chunkSize - 1) / chunkSize;
+        std::vector<std::vector<ecs::Entity>> visited(numChunks);
+        pool.parallelFor(
+            entities.size(), chunkSize,
+            [this, &entities, &callback, &visited, chunkSize](size_t begin,
+                                                              size_t end) {
+                auto &chunkVisited = visited[begin / chunkSize];
+                for (size_t i{begin}; i < end; ++i) {
+                    if (visit<false>(entities[i], callback, Slots{})) {
+                        chunkVisited.push_back(entities[i]);
+                    }
                 }
+            });
+        // Change logs aren't thread safe, fill them in afterwards.
+        for (const auto &chunkVisited : visited) {
+            for (ecs::Entity entity : chunkVisited) {
+                ((std::is_const_v<T> ? void() : T::recordChange(entity)), ...);
             }
         }
     }
 
-    void setVersion(Entity entity, size_t componentNumber, uint8_t version) {
-        _versions[entity][componentNumber] = version;
+    // slot is the position of the component in T...
+    void setVersion(Entity entity, size_t slot, Version version) {
+        _versions[entityIndex(entity)][slot] = version;
     }
 
-    virtual ~System() noexcept {}
+    virtual ~System() noexcept { unsubscribe(Slots{}); }
 
   private:
-    uint8_t _versions[ecs::GLOBAL_MAX_ENTITIES][ecs::GLOBAL_MAX_COMPONENTS];
+    using Slots = std::index_sequence_for<T...>;
+
+    template <bool Record, typename F, size_t... Slot>
+    bool visit(ecs::Entity entity, F &callback, std::index_sequence<Slot...>) {
+        uint32_t index = entityIndex(entity);
+        _versions.ensure(index);
+        bool test = (T::compare(entity, _versions[index][Slot]) && ...);
+        if (!test) // Check if NOT all versions match
+        {
+#ifdef ECS_TRACE
+            std::cout << "ecs::System: Updating entity=" << entity << std::endl;
+#endif
+            (callback(entity, T::get(entity)...));
+            (T::increment(entity, std::is_const_v<T> == false, Record),
+             ...); // Increment version of NON-const components
+            (setVersion(entity, Slot, T::version(entity)),
+             ...); // Update own version to match latest-greatest.
+            return true;
+        }
+        return false;
+    }
+
+    template <size_t... Slot> void subscribe(std::index_sequence<Slot...>) {
+        if (!_subscribed) {
+            (T::_changes.subscribe(&_cursors[Slot]), ...);
+            _subscribed = true;
+        }
+    }
+
+    template <size_t... Slot> void unsubscribe(std::index_sequence<Slot...>) {
+        if (_subscribed) {
+            (T::_changes.unsubscribe(&_cursors[Slot]), ...);
+            _subscribed = false;
+        }
+    }
+
+    // Appends the entities logged since the last call to _changed and moves
+    // the cursors to the end. False if any log could not be read.
+    template <size_t... Slot>
+    bool collectChanges(std::index_sequence<Slot...>) {
+        bool complete{true};
+        auto append = [this](ecs::Entity entity) {
+            _changed.push_back(entity);
+        };
+        ((complete = T::_changes.since(_cursors[Slot], append) && complete),
+         ...);
+        ((_cursors[Slot] = T::_changes.end()), ...);
+        return complete;
+    }
+
+    // Last seen version of each of T... per entity, so the table grows with
+    // the number of components this system reads, not the global count.
+    PagedStorage<std::array<Version, sizeof...(T)>> _versions;
+    std::array<ChangeLog::Cursor, sizeof...(T)> _cursors;
+    std::vector<ecs::Entity> _changed;
+    bool _subscribed{false};
+};
+
+// True if the two systems can't run at the same time because one of them
+// writes (non-const) a component that the other one reads or writes.
+template <class A, class B> struct Conflicts;
+
+template <class... A, class... B>
+struct Conflicts<System<A...>, System<B...>> {
+  private:
+    template <class W, class... R>
+    static constexpr bool writesAny =
+        !std::is_const_v<W> &&
+        (std::is_same_v<W, std::remove_const_t<R>> || ...);
+
+  public:
+    static constexpr bool value =
+        (writesAny<A, B...> || ...) || (writesAny<B, A...> || ...);
 };
 } // namespace ecs
\ No newline at end of file
@@ -0,0 +1,93 @@
+#include "glthreadpool.h"
+
+#include <algorithm>
+
+namespace {
+// Set while the thread runs chunks. The workers are taken then, and the
+// caller holds the submit lock, so a nested parallelFor runs inline.
+thread_local bool inChunk{false};
+} // namespace
+
+lix::ThreadPool::ThreadPool(size_t numThreads) {
+    for (size_t i{1}; i < numThreads; ++i) {
+        _workers.emplace_back([this]() { workerLoop(); });
+    }
+}
+
+lix::ThreadPool::~ThreadPool() noexcept {
+    {
+        std::lock_guard<std::mutex> lock{_mutex};
+        _stop = true;
+    }
+    _wake.notify_all();
+    for (auto &worker : _workers) {
+        worker.join();
+    }
+}
+
+size_t lix::ThreadPool::size() const { return _workers.size() + 1; }
+
+void lix::ThreadPool::parallelFor(size_t count, size_t chunkSize,
+                                  const Range &callback) {
+    if (count == 0) {
+        return;
+    }
+    chunkSize = chunkSize == 0 ? 1 : chunkSize;
+    if (_workers.empty() || count <= chunkSize || inChunk) {
+        callback(0, count);
+        return;
+    }
+    std::lock_guard<std::mutex> submitLock{_submitMutex};
+    {
+        std::lock_guard<std::mutex> lock{_mutex};
+        _callback = &callback;
+        _count = count;
+        _chunkSize = chunkSize;
+        _nextChunk.store(0);
+        _busy = _workers.size();
+        ++_generation;
+    }
+    _wake.notify_all();
+    runChunks();
+    std::unique_lock<std::mutex> lock{_mutex};
+    _done.wait(lock, [this]() { return _busy == 0; });
+    _callback = nullptr;
+}
+
+lix::ThreadPool &lix::ThreadPool::global() {
+    static lix::ThreadPool threadPool;
+    return threadPool;
+}
+
+void lix::ThreadPool::workerLoop() {
+    uint64_t seen{0};
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock{_mutex};
+            _wake.wait(lock,
+                       [this, seen]() { return _stop || _generation != seen; });
+            if (_stop) {
+                return;
+            }
+            seen = _generation;
+        }
+        runChunks();
+        {
+            std::lock_guard<std::mutex> lock{_mutex};
+            --_busy;
+        }
+        _done.notify_one();
+    }
+}
+
+void lix::ThreadPool::runChunks() {
+    inChunk = true;
+    size_t numChunks = (_count + _chunkSize - 1) / _chunkSize;
+    for (size_t chunk = _nextChunk.fetch_add(1); chunk < numChunks;
+         chunk = _nextChunk.fetch_add(1)) {
+        size_t begin = chunk * _chunkSize;
+        size_t end = std::min(begin + _chunkSize, _count);
+        (*_callback)(begin, end);
+    }
+    inChunk = false;
+}
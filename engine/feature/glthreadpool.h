@@ -0,0 +1,52 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace lix {
+// Fixed set of worker threads for data-parallel loops. The calling thread
+// takes part in the work, so a pool of size 1 runs everything inline.
+class ThreadPool {
+  public:
+    using Range = std::function<void(size_t begin, size_t end)>;
+
+    ThreadPool(size_t numThreads = std::thread::hardware_concurrency());
+    ~ThreadPool() noexcept;
+
+    ThreadPool(const ThreadPool &other) = delete;
+    ThreadPool &operator=(const ThreadPool &other) = delete;
+
+    // Threads taking part in parallelFor, including the caller.
+    size_t size() const;
+
+    // Splits [0, count) into chunks of chunkSize and calls callback once per
+    // chunk. Returns when every chunk is done. Called from inside a chunk, of
+    // this pool or another, it runs the whole range inline.
+    void parallelFor(size_t count, size_t chunkSize, const Range &callback);
+
+    static ThreadPool &global();
+
+  private:
+    void workerLoop();
+    void runChunks();
+
+    std::vector<std::thread> _workers;
+    std::mutex _submitMutex;
+    std::mutex _mutex;
+    std::condition_variable _wake;
+    std::condition_variable _done;
+    uint64_t _generation{0};
+    size_t _busy{0};
+    bool _stop{false};
+
+    const Range *_callback{nullptr};
+    size_t _count{0};
+    size_t _chunkSize{1};
+    std::atomic<size_t> _nextChunk{0};
+};
+} // namespace lix
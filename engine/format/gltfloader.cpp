@@ -1,9 +1,12 @@
 #include "gltfloader.h"
 
+#include "box.h"
 #include "convexhull.h"
 #include "glm/gtc/type_ptr.hpp"
 #include "primer.h"
+#include <map>
 #include <stdexcept>
+#include <tuple>
 #include <unordered_map>
 
 template <typename T> std::vector<T> toVector(const gltf::Buffer &buffer) {
@@ -258,10 +261,32 @@ std::vector<glm::vec3> gltf::loadVertexPositions(const gltf::Mesh &mesh) {
 std::shared_ptr<lix::Polygon> gltf::loadMeshCollider(const gltf::Mesh &gltfMesh,
                                                      bool generateConvexHull) {
     uint64_t addr = (uint64_t)&gltfMesh;
+    if (generateConvexHull && gltfMesh.collider) {
+        // Baked by asproc. Copied into a graph once per mesh, Polygon keeps
+        // its points in a std::vector.
+        static std::unordered_map<uint64_t, lix::VertexGraph> bakedGraphs;
+        const gltf::Collider &collider = *gltfMesh.collider;
+        auto [graphIt, inserted] = bakedGraphs.try_emplace(addr);
+        lix::VertexGraph &graph = graphIt->second;
+        if (inserted) {
+            graph.points.assign(collider.points,
+                                collider.points + collider.points_size);
+            graph.offsets.assign(collider.offsets,
+                                 collider.offsets + collider.points_size + 1);
+            graph.neighbours.assign(collider.neighbours,
+                                    collider.neighbours +
+                                        collider.neighbours_size);
+        }
+        auto polygon = std::make_shared<lix::Polygon>(nullptr, graph);
+        polygon->setSimplified(std::make_shared<lix::Box>(
+            nullptr, (collider.max - collider.min) * 0.5f,
+            (collider.max + collider.min) * 0.5f));
+        return polygon;
+    }
     static std::unordered_map<uint64_t, std::vector<glm::vec3>>
         loadedMeshVertices;
-    static std::unordered_map<uint64_t, std::vector<glm::vec3>>
-        convexHullVertices;
+    // Hull graphs, so the runtime hulls hill climb like the baked ones.
+    static std::unordered_map<uint64_t, lix::VertexGraph> convexHullGraphs;
     auto it = loadedMeshVertices.find(addr);
     if (it == loadedMeshVertices.end()) {
         std::vector<glm::vec3> vertices;
@@ -271,20 +296,41 @@ std::shared_ptr<lix::Polygon> gltf::loadMeshCollider(const gltf::Mesh &gltfMesh,
         loadedMeshVertices.emplace(addr, unique);
     }
     if (generateConvexHull) {
-        auto chIt = convexHullVertices.find(addr);
-        if (chIt == convexHullVertices.end()) {
+        auto chIt = convexHullGraphs.find(addr);
+        if (chIt == convexHullGraphs.end()) {
             lix::ConvexHull convexHull{loadedMeshVertices[addr]};
-            auto pts = convexHull.points();
-            convexHullVertices.emplace(addr, pts);
-            printf("pts: %s uniuque=#%zu pts=#%zu\n", gltfMesh.name.c_str(),
-                   loadedMeshVertices[addr].size(), pts.size());
+            chIt = convexHullGraphs.emplace(addr, convexHull.vertexGraph())
+                       .first;
         }
-
-        return std::make_shared<lix::Polygon>(nullptr,
-                                              convexHullVertices[addr]);
+        return std::make_shared<lix::Polygon>(nullptr, chIt->second);
     } else {
         return std::make_shared<lix::Polygon>(nullptr,
                                               loadedMeshVertices[addr]);
     }
     return nullptr;
-}
\ No newline at end of file
+}
+
+std::shared_ptr<lix::Polygon>
+gltf::loadDecomposedCollider(const gltf::Mesh &gltfMesh,
+                             const lix::DecompositionSettings &settings) {
+    // Hulls per mesh and settings.
+    using Key =
+        std::tuple<const gltf::Mesh *, uint32_t, float, uint32_t, uint32_t>;
+    static std::map<Key, std::vector<std::vector<glm::vec3>>> decomposedHulls;
+    const Key key{&gltfMesh, settings.resolution, settings.concavity,
+                  settings.maxHulls, settings.planesPerAxis};
+    auto it = decomposedHulls.find(key);
+    if (it == decomposedHulls.end()) {
+        std::vector<glm::vec3> vertices;
+        std::vector<GLushort> indices;
+        gltf::loadAttributes(gltfMesh, 0, gltf::A_POSITION, vertices, indices);
+        it = decomposedHulls
+                 .emplace(key, lix::convexDecomposition(
+                                   vertices,
+                                   std::vector<uint32_t>(indices.begin(),
+                                                         indices.end()),
+                                   settings))
+                 .first;
+    }
+    return lix::compoundShape(nullptr, it->second);
+}
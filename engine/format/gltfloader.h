@@ -2,6 +2,7 @@
 
 #include <memory>
 
+#include "convexdecomposition.h"
 #include "glmesh.h"
 #include "glnode.h"
 #include "glskinanimation.h"
@@ -52,6 +53,16 @@ void loadAttributes(const gltf::Mesh &mesh, int primitiveIdx, uint32_t attribs,
     }
 }
 
+// With generateConvexHull the hull baked by asproc --bake-colliders is used
+// when the mesh has one, and built from the positions otherwise.
 std::shared_ptr<lix::Polygon> loadMeshCollider(const gltf::Mesh &gltfMesh,
                                                bool generateConvexHull);
+
+// Compound collider of convex parts for a concave mesh, see
+// lix::convexDecomposition. The decomposition is slow, it runs on the first
+// call for a mesh and later calls with the same settings share its hulls. Set
+// the TRS on the result. Null when the mesh has no volume.
+std::shared_ptr<lix::Polygon>
+loadDecomposedCollider(const gltf::Mesh &gltfMesh,
+                       const lix::DecompositionSettings &settings = {});
 } // namespace gltf
\ No newline at end of file
@@ -1,51 +1,58 @@
 #include "aabb.h"
 
 #include "primer.h"
-#include <stdexcept>
 
 #include "capsule.h"
 #include "polygon.h"
+#include "primitivecollision.h"
 #include "sphere.h"
 
-static std::pair<glm::vec3, glm::vec3>
-minMaxFromPolygon(lix::Polygon &polygon) {
-    const auto &pts = polygon.points();
-    std::vector<glm::vec3> rotatedPoints(pts.size());
-    std::transform(pts.begin(), pts.end(), rotatedPoints.begin(),
-                   [&polygon](const glm::vec3 &p) {
-                       return glm::vec3(
-                           glm::scale(polygon.trs()->rotationMatrix(),
-                                      polygon.trs()->scale()) *
-                           glm::vec4{p, 1.0f});
-                   });
-    return lix::extremePoints(rotatedPoints);
-}
-
 lix::AABB::AABB(const lix::AABB &other)
-    : Shape{other}, _min{other._min}, _max{other._max} {}
+    : Shape{other}, _min{other._min}, _max{other._max},
+      _localCenter{other._localCenter}, _localHalf{other._localHalf},
+      _fitted{other._fitted}, _fitTRS{other._fitTRS},
+      _modelVersion{other._modelVersion} {}
 
 lix::AABB::AABB(lix::TRS *trs, const glm::vec3 &min, const glm::vec3 &max)
     : Shape{trs}, _min{min}, _max{max} {}
 
 lix::AABB::AABB(lix::TRS *trs, lix::Polygon *polygon)
-    : Shape{trs}, _polygon{polygon} {
-    auto [min, max] = minMaxFromPolygon(*_polygon);
-    _min = min;
-    _max = max;
+    : Shape{trs}, _fitted{true} {
+    auto [min, max] = lix::extremePoints(polygon->points());
+    _localCenter = (min + max) * 0.5f;
+    _localHalf = (max - min) * 0.5f;
 }
 
 lix::AABB::~AABB() noexcept {}
 
 lix::AABB *lix::AABB::clone() const { return new lix::AABB(*this); }
 
+void lix::AABB::fit() {
+    // The box of the turned local box: each world half extent is the local
+    // ones weighed by the absolute rotation * scale matrix.
+    glm::mat3 m = glm::mat3(_trs->rotationMatrix());
+    for (int i = 0; i < 3; ++i) {
+        m[i] *= _trs->scale()[i];
+    }
+    const glm::vec3 center = m * _localCenter;
+    const glm::vec3 half = glm::abs(m[0]) * _localHalf.x +
+                           glm::abs(m[1]) * _localHalf.y +
+                           glm::abs(m[2]) * _localHalf.z;
+    _min = center - half;
+    _max = center + half;
+}
+
 void lix::AABB::updateMinMax() {
-    if (_polygon) {
-        if (_polygon->trs()->rotationVersionSync(_rVersion)) // rotation changed
-        {
-            auto [min, max] = minMaxFromPolygon(*_polygon);
-            _min = min;
-            _max = max;
-        }
+    if (!_fitted) {
+        return;
+    }
+    // Fitted on first use, the TRS may be set after construction. The fit
+    // follows rotation and scale, so any model change refits.
+    _trs->modelMatrix();
+    const bool changed = !_trs->modelVersionSync(_modelVersion);
+    if (changed || _fitTRS != _trs) {
+        _fitTRS = _trs;
+        fit();
     }
 }
 
@@ -62,9 +69,16 @@ glm::vec3 lix::AABB::supportPoint(const glm::vec3 &dir) {
     trs()->translation()), trs()->scale()); glm::vec3 a = glm::vec3(m *
     glm::vec4{_min, 1.0f}); glm::vec3 b = glm::vec3(m *
     glm::vec4{_max, 1.0f});*/
-    auto pts = boundingBox();
-    auto [index, distance] = lix::indexAlongDirection(pts, dir);
-    return trs()->translation() + pts.at(index);
+    updateMinMax();
+    // The corner furthest along dir, picked per axis.
+    return trs()->translation() + glm::vec3{dir.x > 0.0f ? _max.x : _min.x,
+                                            dir.y > 0.0f ? _max.y : _min.y,
+                                            dir.z > 0.0f ? _max.z : _min.z};
+}
+
+lix::Bounds lix::AABB::bounds() {
+    updateMinMax();
+    return {trs()->translation() + _min, trs()->translation() + _max};
 }
 
 bool lix::AABB::intersects(lix::Capsule &capsule) {
@@ -86,7 +100,7 @@ bool lix::AABB::intersects(lix::Capsule &capsule) {
 
     float d = glm::dot(AC, n);
 
-    float r = capsule.radii() * capsule.trs()->scale().x;
+    float r = capsule.worldRadius();
     if (capsule.caps()) {
         if (d < -r || d > (len + r)) {
             return false;
@@ -114,7 +128,7 @@ bool lix::AABB::intersects(Sphere &sphere) {
     updateMinMax();
     glm::vec3 delta = trs()->translation() - sphere.trs()->translation();
     float d2 = glm::dot(delta, delta);
-    float r = sphere.radii() * sphere.trs()->scale().x;
+    float r = sphere.worldRadius();
     if (d2 < (r * r)) {
         return true;
     }
@@ -142,8 +156,8 @@ bool lix::AABB::intersects(AABB &aabb) {
            a0.z <= b1.z && b0.z >= a1.z;
 }
 
-bool lix::AABB::intersects(Polygon & /*polygon*/) {
-    throw std::runtime_error("aabb-polygon collision not implemented");
+bool lix::AABB::intersects(Polygon &polygon) {
+    return lix::overlaps(*this, polygon);
 }
 
 bool lix::AABB::doTest(Shape &shape) { return shape.intersects(*this); }
\ No newline at end of file
@@ -7,6 +7,9 @@ class AABB : public Shape {
   public:
     AABB(const AABB &other);
     AABB(lix::TRS *trs, const glm::vec3 &min, const glm::vec3 &max);
+    // Fitted around the polygon's local points, refits from the TRS when it
+    // turns or scales without going over the points again. trs may be null
+    // until setTRS, the fit waits for the first use.
     AABB(lix::TRS *trs, class Polygon *polygon);
 
     virtual ~AABB() noexcept;
@@ -14,6 +17,7 @@ class AABB : public Shape {
     virtual AABB *clone() const override;
 
     virtual glm::vec3 supportPoint(const glm::vec3 &dir) override;
+    virtual lix::Bounds bounds() override;
     virtual bool intersects(Capsule &capsule) override;
     virtual bool intersects(Sphere &sphere) override;
     virtual bool intersects(AABB &aabb) override;
@@ -22,16 +26,27 @@ class AABB : public Shape {
 
     std::vector<glm::vec3> boundingBox();
 
-    const glm::vec3 &min() const { return _min; }
+    const glm::vec3 &min() {
+        updateMinMax();
+        return _min;
+    }
 
-    const glm::vec3 &max() const { return _max; }
+    const glm::vec3 &max() {
+        updateMinMax();
+        return _max;
+    }
 
   private:
+    void fit();
     void updateMinMax();
 
     glm::vec3 _min;
     glm::vec3 _max;
-    class Polygon *_polygon{nullptr};
-    uint32_t _rVersion{0};
+    // Local box of the fitted polygon.
+    glm::vec3 _localCenter{0.0f};
+    glm::vec3 _localHalf{0.0f};
+    bool _fitted{false};
+    lix::TRS *_fitTRS{nullptr}; // the TRS _min and _max were fitted for
+    uint32_t _modelVersion{0};
 };
 } // namespace lix
\ No newline at end of file
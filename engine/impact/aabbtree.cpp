@@ -0,0 +1,244 @@
+#include "aabbtree.h"
+
+#include <algorithm>
+
+lix::AABBTree::AABBTree() : _nodes{} {}
+
+lix::AABBTree::Proxy lix::AABBTree::insert(const lix::Bounds &bounds,
+                                           uint32_t userData, float margin) {
+    Proxy proxy = allocate();
+    Node &node = _nodes[proxy];
+    node.bounds = bounds.expanded(margin);
+    node.userData = userData;
+    node.height = 0;
+    insertLeaf(proxy);
+    ++_leafCount;
+    return proxy;
+}
+
+void lix::AABBTree::remove(Proxy proxy) {
+    assert(proxy >= 0 && static_cast<size_t>(proxy) < _nodes.size());
+    assert(_nodes[proxy].leaf());
+    removeLeaf(proxy);
+    release(proxy);
+    --_leafCount;
+}
+
+bool lix::AABBTree::move(Proxy proxy, const lix::Bounds &bounds,
+                         float margin) {
+    assert(_nodes[proxy].leaf());
+    if (_nodes[proxy].bounds.contains(bounds)) {
+        return false;
+    }
+    removeLeaf(proxy);
+    _nodes[proxy].bounds = bounds.expanded(margin);
+    insertLeaf(proxy);
+    return true;
+}
+
+lix::AABBTree::Proxy lix::AABBTree::allocate() {
+    Proxy proxy;
+    if (_freeList != NULL_NODE) {
+        proxy = _freeList;
+        _freeList = _nodes[proxy].parent;
+    } else {
+        proxy = static_cast<Proxy>(_nodes.size());
+        _nodes.emplace_back();
+    }
+    Node &node = _nodes[proxy];
+    node.parent = NULL_NODE;
+    node.left = NULL_NODE;
+    node.right = NULL_NODE;
+    node.height = 0;
+    node.userData = 0;
+    return proxy;
+}
+
+void lix::AABBTree::release(Proxy proxy) {
+    _nodes[proxy].parent = _freeList;
+    _nodes[proxy].height = -1;
+    _freeList = proxy;
+}
+
+void lix::AABBTree::insertLeaf(Proxy leaf) {
+    if (_root == NULL_NODE) {
+        _root = leaf;
+        _nodes[leaf].parent = NULL_NODE;
+        return;
+    }
+
+    // Walk down to the cheapest sibling by the surface area heuristic.
+    const lix::Bounds leafBounds = _nodes[leaf].bounds;
+    Proxy index = _root;
+    while (!_nodes[index].leaf()) {
+        const Node &node = _nodes[index];
+        float area = node.bounds.area();
+        float combinedArea = node.bounds.merged(leafBounds).area();
+        float cost = 2.0f * combinedArea;
+        float inheritanceCost = 2.0f * (combinedArea - area);
+
+        auto descendCost = [this, &leafBounds, inheritanceCost](Proxy child) {
+            const Node &c = _nodes[child];
+            float merged = c.bounds.merged(leafBounds).area();
+            return c.leaf() ? merged + inheritanceCost
+                            : merged - c.bounds.area() + inheritanceCost;
+        };
+        float costLeft = descendCost(node.left);
+        float costRight = descendCost(node.right);
+
+        if (cost < costLeft && cost < costRight) {
+            break;
+        }
+        index = costLeft < costRight ? node.left : node.right;
+    }
+
+    Proxy sibling = index;
+    Proxy oldParent = _nodes[sibling].parent;
+    Proxy newParent = allocate(); // may reallocate _nodes
+    _nodes[newParent].parent = oldParent;
+    _nodes[newParent].bounds = leafBounds.merged(_nodes[sibling].bounds);
+    _nodes[newParent].height = _nodes[sibling].height + 1;
+    _nodes[newParent].left = sibling;
+    _nodes[newParent].right = leaf;
+    _nodes[sibling].parent = newParent;
+    _nodes[leaf].parent = newParent;
+
+    if (oldParent == NULL_NODE) {
+        _root = newParent;
+    } else if (_nodes[oldParent].left == sibling) {
+        _nodes[oldParent].left = newParent;
+    } else {
+        _nodes[oldParent].right = newParent;
+    }
+
+    refitUpwards(_nodes[leaf].parent);
+}
+
+void lix::AABBTree::removeLeaf(Proxy leaf) {
+    if (leaf == _root) {
+        _root = NULL_NODE;
+        return;
+    }
+
+    Proxy parent = _nodes[leaf].parent;
+    Proxy grandParent = _nodes[parent].parent;
+    Proxy sibling = _nodes[parent].left == leaf ? _nodes[parent].right
+                                                : _nodes[parent].left;
+
+    if (grandParent == NULL_NODE) {
+        _root = sibling;
+        _nodes[sibling].parent = NULL_NODE;
+        release(parent);
+        return;
+    }
+
+    if (_nodes[grandParent].left == parent) {
+        _nodes[grandParent].left = sibling;
+    } else {
+        _nodes[grandParent].right = sibling;
+    }
+    _nodes[sibling].parent = grandParent;
+    release(parent);
+    refitUpwards(grandParent);
+}
+
+void lix::AABBTree::refitUpwards(Proxy index) {
+    while (index != NULL_NODE) {
+        index = balance(index);
+        Node &node = _nodes[index];
+        const Node &left = _nodes[node.left];
+        const Node &right = _nodes[node.right];
+        node.height = 1 + std::max(left.height, right.height);
+        node.bounds = left.bounds.merged(right.bounds);
+        index = node.parent;
+    }
+}
+
+// Rotates the taller child up if the subtree at index is out of balance.
+// Returns the new root of the subtree.
+lix::AABBTree::Proxy lix::AABBTree::balance(Proxy iA) {
+    Node &A = _nodes[iA];
+    if (A.leaf() || A.height < 2) {
+        return iA;
+    }
+
+    Proxy iB = A.left;
+    Proxy iC = A.right;
+    Node &B = _nodes[iB];
+    Node &C = _nodes[iC];
+    int32_t diff = C.height - B.height;
+
+    auto replaceChild = [this](Proxy parent, Proxy oldChild, Proxy newChild) {
+        if (parent == NULL_NODE) {
+            _root = newChild;
+        } else if (_nodes[parent].left == oldChild) {
+            _nodes[parent].left = newChild;
+        } else {
+            _nodes[parent].right = newChild;
+        }
+    };
+
+    if (diff > 1) { // rotate C up
+        Proxy iF = C.left;
+        Proxy iG = C.right;
+        Node &F = _nodes[iF];
+        Node &G = _nodes[iG];
+
+        C.left = iA;
+        C.parent = A.parent;
+        A.parent = iC;
+        replaceChild(C.parent, iA, iC);
+
+        if (F.height > G.height) {
+            C.right = iF;
+            A.right = iG;
+            G.parent = iA;
+            A.bounds = B.bounds.merged(G.bounds);
+            C.bounds = A.bounds.merged(F.bounds);
+            A.height = 1 + std::max(B.height, G.height);
+            C.height = 1 + std::max(A.height, F.height);
+        } else {
+            C.right = iG;
+            A.right = iF;
+            F.parent = iA;
+            A.bounds = B.bounds.merged(F.bounds);
+            C.bounds = A.bounds.merged(G.bounds);
+            A.height = 1 + std::max(B.height, F.height);
+            C.height = 1 + std::max(A.height, G.height);
+        }
+        return iC;
+    }
+
+    if (diff < -1) { // rotate B up
+        Proxy iD = B.left;
+        Proxy iE = B.right;
+        Node &D = _nodes[iD];
+        Node &E = _nodes[iE];
+
+        B.left = iA;
+        B.parent = A.parent;
+        A.parent = iB;
+        replaceChild(B.parent, iA, iB);
+
+        if (D.height > E.height) {
+            B.right = iD;
+            A.left = iE;
+            E.parent = iA;
+            A.bounds = C.bounds.merged(E.bounds);
+            B.bounds = A.bounds.merged(D.bounds);
+            A.height = 1 + std::max(C.height, E.height);
+            B.height = 1 + std::max(A.height, D.height);
+        } else {
+            B.right = iE;
+            A.left = iD;
+            D.parent = iA;
+            A.bounds = C.bounds.merged(D.bounds);
+            B.bounds = A.bounds.merged(E.bounds);
+            A.height = 1 + std::max(C.height, D.height);
+            B.height = 1 + std::max(A.height, E.height);
+        }
+        return iB;
+    }
+
+    return iA;
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+#include "bounds.h"
+
+namespace lix {
+// Dynamic bounding volume tree. Every leaf holds fat bounds, the tight bounds
+// grown by a margin, so small movements don't need a reinsert. Internal nodes
+// are kept balanced by rotations, as in Box2D's b2DynamicTree.
+class AABBTree {
+  public:
+    using Proxy = int32_t;
+    static constexpr Proxy NULL_NODE{-1};
+
+    AABBTree();
+
+    Proxy insert(const lix::Bounds &bounds, uint32_t userData,
+                 float margin = 0.0f);
+    void remove(Proxy proxy);
+    // Returns true if the leaf had to be reinserted.
+    bool move(Proxy proxy, const lix::Bounds &bounds, float margin = 0.0f);
+
+    const lix::Bounds &fatBounds(Proxy proxy) const {
+        return _nodes[proxy].bounds;
+    }
+
+    uint32_t userData(Proxy proxy) const { return _nodes[proxy].userData; }
+
+    void setUserData(Proxy proxy, uint32_t userData) {
+        _nodes[proxy].userData = userData;
+    }
+
+    // Calls callback(proxy) for every leaf whose fat bounds overlap bounds.
+    template <typename F>
+    void query(const lix::Bounds &bounds, F &&callback) const {
+        if (_root == NULL_NODE) {
+            return;
+        }
+        Proxy stack[MAX_DEPTH];
+        int32_t top{0};
+        stack[top++] = _root;
+        while (top > 0) {
+            Proxy index = stack[--top];
+            const Node &node = _nodes[index];
+            if (!node.bounds.overlaps(bounds)) {
+                continue;
+            }
+            if (node.leaf()) {
+                callback(index);
+            } else {
+                assert(top + 2 <= MAX_DEPTH);
+                stack[top++] = node.left;
+                stack[top++] = node.right;
+            }
+        }
+    }
+
+    // Calls callback(proxy) for every leaf whose fat bounds, grown by radius,
+    // the ray hits within maxDistance. callback returns the distance to clip
+    // the ray to, return maxDistance to keep it.
+    template <typename F>
+    void raycast(const glm::vec3 &origin, const glm::vec3 &direction,
+                 float maxDistance, float radius, F &&callback) const {
+        if (_root == NULL_NODE) {
+            return;
+        }
+        const glm::vec3 inverseDirection = 1.0f / direction;
+        Proxy stack[MAX_DEPTH];
+        int32_t top{0};
+        stack[top++] = _root;
+        while (top > 0) {
+            Proxy index = stack[--top];
+            const Node &node = _nodes[index];
+            if (!node.bounds.expanded(radius).intersectsRay(
+                    origin, inverseDirection, maxDistance)) {
+                continue;
+            }
+            if (node.leaf()) {
+                maxDistance = callback(index, maxDistance);
+            } else {
+                assert(top + 2 <= MAX_DEPTH);
+                stack[top++] = node.left;
+                stack[top++] = node.right;
+            }
+        }
+    }
+
+    // Calls callback(proxy) for every leaf, in proxy order.
+    template <typename F> void forEachLeaf(F &&callback) const {
+        for (size_t i{0}; i < _nodes.size(); ++i) {
+            if (_nodes[i].height == 0) {
+                callback(static_cast<Proxy>(i));
+            }
+        }
+    }
+
+    size_t size() const { return _leafCount; }
+
+    int32_t height() const {
+        return _root == NULL_NODE ? 0 : _nodes[_root].height;
+    }
+
+  private:
+    // The tree is balanced so its height stays far below this.
+    static constexpr int32_t MAX_DEPTH{128};
+
+    struct Node {
+        lix::Bounds bounds;
+        Proxy parent; // next free node while on the free list
+        Proxy left;
+        Proxy right;
+        int32_t height; // leaf = 0, free = -1
+        uint32_t userData;
+
+        bool leaf() const { return left == NULL_NODE; }
+    };
+
+    Proxy allocate();
+    void release(Proxy proxy);
+    void insertLeaf(Proxy leaf);
+    void removeLeaf(Proxy leaf);
+    void refitUpwards(Proxy index);
+    Proxy balance(Proxy index);
+
+    std::vector<Node> _nodes;
+    Proxy _root{NULL_NODE};
+    Proxy _freeList{NULL_NODE};
+    size_t _leafCount{0};
+};
+} // namespace lix
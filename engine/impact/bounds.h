@@ -0,0 +1,54 @@
+#pragma once
+
+#include "glm/glm.hpp"
+
+namespace lix {
+// World space axis aligned bounds. Unlike lix::AABB this is not a Shape, it
+// has no TRS and is cheap to copy, which is what the broad phase wants.
+struct Bounds {
+    glm::vec3 min;
+    glm::vec3 max;
+
+    bool overlaps(const Bounds &other) const {
+        return min.x <= other.max.x && max.x >= other.min.x &&
+               min.y <= other.max.y && max.y >= other.min.y &&
+               min.z <= other.max.z && max.z >= other.min.z;
+    }
+
+    bool contains(const Bounds &other) const {
+        return min.x <= other.min.x && min.y <= other.min.y &&
+               min.z <= other.min.z && max.x >= other.max.x &&
+               max.y >= other.max.y && max.z >= other.max.z;
+    }
+
+    Bounds merged(const Bounds &other) const {
+        return {glm::min(min, other.min), glm::max(max, other.max)};
+    }
+
+    Bounds expanded(float margin) const {
+        return {min - glm::vec3{margin}, max + glm::vec3{margin}};
+    }
+
+    // Half the surface area, all the tree heuristics need is the ordering.
+    float area() const {
+        const glm::vec3 d = max - min;
+        return d.x * d.y + d.y * d.z + d.z * d.x;
+    }
+
+    glm::vec3 center() const { return (min + max) * 0.5f; }
+
+    // Slab test of the ray origin + t * direction for t in [0, maxDistance],
+    // given 1 / direction.
+    bool intersectsRay(const glm::vec3 &origin,
+                       const glm::vec3 &inverseDirection,
+                       float maxDistance) const {
+        const glm::vec3 t0 = (min - origin) * inverseDirection;
+        const glm::vec3 t1 = (max - origin) * inverseDirection;
+        const glm::vec3 lower = glm::min(t0, t1);
+        const glm::vec3 upper = glm::max(t0, t1);
+        const float enter = glm::max(glm::max(lower.x, lower.y), lower.z);
+        const float exit = glm::min(glm::min(upper.x, upper.y), upper.z);
+        return enter <= exit && exit >= 0.0f && enter <= maxDistance;
+    }
+};
+} // namespace lix
@@ -0,0 +1,73 @@
+#include "box.h"
+
+#include "aabb.h"
+#include "capsule.h"
+#include "polygon.h"
+#include "primer.h"
+#include "primitivecollision.h"
+#include "sphere.h"
+
+lix::Box::Box(const lix::Box &other)
+    : Shape{other}, _halfExtents{other._halfExtents}, _center{other._center} {}
+
+lix::Box::Box(lix::TRS *trs, const glm::vec3 &halfExtents,
+              const glm::vec3 &center)
+    : Shape{trs}, _halfExtents{halfExtents}, _center{center} {}
+
+lix::Box::Box(lix::TRS *trs, const lix::Polygon &polygon) : Shape{trs} {
+    auto [min, max] = lix::extremePoints(polygon.points());
+    _halfExtents = (max - min) * 0.5f;
+    _center = (min + max) * 0.5f;
+}
+
+lix::Box::~Box() noexcept {}
+
+lix::Box *lix::Box::clone() const { return new lix::Box(*this); }
+
+glm::vec3 lix::Box::center() const {
+    return _trs->translation() + axes() * (_center * _trs->scale());
+}
+
+glm::mat3 lix::Box::axes() const { return glm::mat3(_trs->rotationMatrix()); }
+
+glm::vec3 lix::Box::extents() const {
+    // A mirrored box has the same extents, the axes don't flip.
+    return _halfExtents * glm::abs(_trs->scale());
+}
+
+glm::vec3 lix::Box::supportPoint(const glm::vec3 &dir) {
+    const glm::mat3 u = axes();
+    const glm::vec3 e = extents();
+    glm::vec3 p = center();
+    for (int i = 0; i < 3; ++i) {
+        p += u[i] * (glm::dot(u[i], dir) > 0.0f ? e[i] : -e[i]);
+    }
+    return p;
+}
+
+lix::Bounds lix::Box::bounds() {
+    const glm::mat3 u = axes();
+    const glm::vec3 e = extents();
+    const glm::vec3 r =
+        glm::abs(u[0]) * e.x + glm::abs(u[1]) * e.y + glm::abs(u[2]) * e.z;
+    const glm::vec3 c = center();
+    return {c - r, c + r};
+}
+
+bool lix::Box::intersects(lix::Capsule &capsule) {
+    return lix::overlaps(*this, capsule);
+}
+
+bool lix::Box::intersects(lix::Sphere &sphere) {
+    return lix::overlaps(*this, sphere);
+}
+
+bool lix::Box::intersects(lix::AABB &aabb) {
+    return lix::overlaps(*this, aabb);
+}
+
+bool lix::Box::intersects(lix::Polygon &polygon) {
+    return lix::overlaps(*this, polygon);
+}
+
+bool lix::Box::doTest(Shape &shape) { return lix::overlaps(*this, shape); }
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "shape.h"
+
+namespace lix {
+// Oriented box around center in model space, halfExtents scaled by the TRS
+// scale and turned by its rotation. Unlike a Polygon cube it keeps its frame,
+// so the narrow phase can test it against spheres, capsules and other boxes
+// without GJK/EPA.
+class Box : public Shape {
+  public:
+    Box(const Box &other);
+    Box(lix::TRS *trs, const glm::vec3 &halfExtents,
+        const glm::vec3 &center = glm::vec3{0.0f});
+    // Oriented bounds of the polygon's local points, as a simplified shape
+    // it follows the TRS with nothing to refit.
+    Box(lix::TRS *trs, const class Polygon &polygon);
+
+    virtual ~Box() noexcept;
+
+    virtual Box *clone() const override;
+
+    virtual lix::ShapeType type() const override {
+        return lix::ShapeType::Box;
+    }
+
+    virtual glm::vec3 supportPoint(const glm::vec3 &dir) override;
+    virtual lix::Bounds bounds() override;
+    virtual bool intersects(Capsule &capsule) override;
+    virtual bool intersects(Sphere &sphere) override;
+    virtual bool intersects(AABB &aabb) override;
+    virtual bool intersects(Polygon &polygon) override;
+    virtual bool doTest(Shape &shape) override;
+
+    const glm::vec3 &halfExtents() const { return _halfExtents; }
+
+    const glm::vec3 &localCenter() const { return _center; }
+
+    glm::vec3 center() const;
+    // World space frame: the columns are the unit axes.
+    glm::mat3 axes() const;
+    // Half extents along axes(), with the TRS scale applied.
+    glm::vec3 extents() const;
+
+  private:
+    glm::vec3 _halfExtents;
+    glm::vec3 _center; // in model space
+};
+} // namespace lix
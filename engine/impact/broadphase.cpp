@@ -0,0 +1,114 @@
+#include "broadphase.h"
+
+#include <algorithm>
+
+lix::BroadPhase::BroadPhase(float margin)
+    : _margin{margin}, _staticTree{}, _dynamicTree{}, _entries{}, _pairs{} {}
+
+void lix::BroadPhase::track(lix::Shape &shape, uint32_t index, bool dynamic) {
+    auto it = _entries.find(&shape);
+    if (it != _entries.end() && it->second.dynamic != dynamic) {
+        untrack(shape);
+        it = _entries.end();
+    }
+    AABBTree &tree = dynamic ? _dynamicTree : _staticTree;
+    float margin = dynamic ? _margin : 0.0f;
+    shape.trs()->modelMatrix(); // flushes the model matrix version
+    if (it == _entries.end()) {
+        Entry entry{AABBTree::NULL_NODE, 0, _frame, dynamic};
+        shape.trs()->modelVersionSync(entry.version);
+        entry.proxy = tree.insert(shape.bounds(), index, margin);
+        _entries.emplace(&shape, entry);
+        return;
+    }
+    Entry &entry = it->second;
+    entry.frame = _frame;
+    tree.setUserData(entry.proxy, index);
+    if (!shape.trs()->modelVersionSync(entry.version)) {
+        tree.move(entry.proxy, shape.bounds(), margin);
+    }
+}
+
+void lix::BroadPhase::untrack(const lix::Shape &shape) {
+    auto it = _entries.find(&shape);
+    if (it == _entries.end()) {
+        return;
+    }
+    (it->second.dynamic ? _dynamicTree : _staticTree).remove(it->second.proxy);
+    _entries.erase(it);
+}
+
+void lix::BroadPhase::prune() {
+    for (auto it = _entries.begin(); it != _entries.end();) {
+        if (it->second.frame != _frame) {
+            (it->second.dynamic ? _dynamicTree : _staticTree)
+                .remove(it->second.proxy);
+            it = _entries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    ++_frame;
+}
+
+void lix::BroadPhase::findPairs(
+    std::vector<Pair> &pairs,
+    const std::vector<lix::DynamicBody> *dynamicBodies) const {
+    auto sleeping = [dynamicBodies](uint32_t index) {
+        return dynamicBodies && (*dynamicBodies)[index].sleeping;
+    };
+    pairs.clear();
+    _dynamicTree.forEachLeaf([&](AABBTree::Proxy proxy) {
+        uint32_t a = _dynamicTree.userData(proxy);
+        if (sleeping(a)) {
+            return;
+        }
+        _staticTree.query(_dynamicTree.fatBounds(proxy),
+                          [this, &pairs, a](AABBTree::Proxy other) {
+                              pairs.push_back(
+                                  {a, _staticTree.userData(other), false});
+                          });
+    });
+    size_t numStaticPairs = pairs.size();
+    // Pairs are found from their awake end, b may be asleep.
+    _dynamicTree.forEachLeaf([&](AABBTree::Proxy proxy) {
+        uint32_t a = _dynamicTree.userData(proxy);
+        if (sleeping(a)) {
+            return;
+        }
+        _dynamicTree.query(_dynamicTree.fatBounds(proxy),
+                           [&](AABBTree::Proxy other) {
+                               uint32_t b = _dynamicTree.userData(other);
+                               if (a < b) {
+                                   pairs.push_back({a, b, true});
+                               } else if (b < a && sleeping(b)) {
+                                   pairs.push_back({b, a, true});
+                               }
+                           });
+    });
+    // Tree layout depends on insertion history, the pair order shouldn't.
+    auto byIndex = [](const Pair &lhs, const Pair &rhs) {
+        return lhs.a < rhs.a || (lhs.a == rhs.a && lhs.b < rhs.b);
+    };
+    std::sort(pairs.begin(), pairs.begin() + numStaticPairs, byIndex);
+    std::sort(pairs.begin() + numStaticPairs, pairs.end(), byIndex);
+}
+
+void lix::BroadPhase::refresh(std::vector<lix::DynamicBody> &dynamicBodies,
+                              std::vector<lix::StaticBody> &staticBodies) {
+    for (size_t i{0}; i < dynamicBodies.size(); ++i) {
+        track(*dynamicBodies[i].shape, static_cast<uint32_t>(i), true);
+    }
+    for (size_t i{0}; i < staticBodies.size(); ++i) {
+        track(*staticBodies[i].shape, static_cast<uint32_t>(i), false);
+    }
+    prune();
+}
+
+const std::vector<lix::BroadPhase::Pair> &
+lix::BroadPhase::update(std::vector<lix::DynamicBody> &dynamicBodies,
+                        std::vector<lix::StaticBody> &staticBodies) {
+    refresh(dynamicBodies, staticBodies);
+    findPairs(_pairs);
+    return _pairs;
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "aabbtree.h"
+#include "rigidbody.h"
+
+namespace lix {
+// Keeps the bounds of every tracked shape in two AABB trees, one for static
+// and one for dynamic shapes, and produces the candidate pairs for the
+// narrow phase. Bounds are only recomputed when the shape's TRS has a new
+// model matrix version.
+class BroadPhase {
+  public:
+    struct Pair {
+        uint32_t a; // index of a dynamic shape
+        uint32_t b; // index of a static or dynamic shape
+        bool dynamic; // true if b is a dynamic shape
+    };
+
+    explicit BroadPhase(float margin = 0.1f);
+
+    BroadPhase(const BroadPhase &other) = delete;
+    BroadPhase &operator=(const BroadPhase &other) = delete;
+
+    // Inserts the shape on first sight, otherwise refits it if its TRS
+    // changed. index is what pairs and queries report back.
+    void track(lix::Shape &shape, uint32_t index, bool dynamic);
+    void untrack(const lix::Shape &shape);
+    // Untracks every shape that wasn't tracked since the last prune().
+    void prune();
+
+    // Dynamic-static pairs first, then dynamic-dynamic pairs with a < b.
+    // Given the dynamic bodies, pairs with nothing awake in them are left
+    // out, and sleeping shapes aren't queried at all.
+    void findPairs(std::vector<Pair> &pairs,
+                   const std::vector<lix::DynamicBody> *dynamicBodies =
+                       nullptr) const;
+
+    // Tracks the bodies by their position in the vectors and prunes the rest.
+    void refresh(std::vector<lix::DynamicBody> &dynamicBodies,
+                 std::vector<lix::StaticBody> &staticBodies);
+    // refresh() and returns the candidate pairs.
+    const std::vector<Pair> &
+    update(std::vector<lix::DynamicBody> &dynamicBodies,
+           std::vector<lix::StaticBody> &staticBodies);
+
+    // Calls callback(index, dynamic) for every shape whose fat bounds overlap.
+    template <typename F>
+    void query(const lix::Bounds &bounds, F &&callback) const {
+        _staticTree.query(bounds, [this, &callback](AABBTree::Proxy proxy) {
+            callback(_staticTree.userData(proxy), false);
+        });
+        _dynamicTree.query(bounds, [this, &callback](AABBTree::Proxy proxy) {
+            callback(_dynamicTree.userData(proxy), true);
+        });
+    }
+
+    // Calls callback(index, dynamic, maxDistance) for every shape whose fat
+    // bounds, grown by radius, the ray may hit. callback returns the distance
+    // to clip the ray to, as in AABBTree::raycast().
+    template <typename F>
+    void raycast(const glm::vec3 &origin, const glm::vec3 &direction,
+                 float maxDistance, float radius, F &&callback) const {
+        _staticTree.raycast(
+            origin, direction, maxDistance, radius,
+            [&](AABBTree::Proxy proxy, float distance) {
+                maxDistance =
+                    callback(_staticTree.userData(proxy), false, distance);
+                return maxDistance;
+            });
+        _dynamicTree.raycast(
+            origin, direction, maxDistance, radius,
+            [&](AABBTree::Proxy proxy, float distance) {
+                return callback(_dynamicTree.userData(proxy), true, distance);
+            });
+    }
+
+    size_t size() const { return _entries.size(); }
+
+  private:
+    struct Entry {
+        AABBTree::Proxy proxy;
+        uint32_t version;
+        uint32_t frame;
+        bool dynamic;
+    };
+
+    float _margin;
+    AABBTree _staticTree;
+    AABBTree _dynamicTree;
+    std::unordered_map<const lix::Shape *, Entry> _entries;
+    std::vector<Pair> _pairs;
+    uint32_t _frame{0};
+};
+} // namespace lix
@@ -1,12 +1,13 @@
 #include "capsule.h"
 
-#include <stdexcept>
-
 #include "aabb.h"
+#include "polygon.h"
+#include "primitivecollision.h"
 #include "sphere.h"
 
 lix::Capsule::Capsule(const lix::Capsule &other)
-    : Shape{other}, _a{other._a}, _b{other._b}, _radii{other._radii} {}
+    : Shape{other}, _a{other._a}, _b{other._b}, _radii{other._radii},
+      _caps{other._caps} {}
 
 lix::Capsule::Capsule(lix::TRS *trs, const glm::vec3 &a, const glm::vec3 &b,
                       float radii, bool caps)
@@ -16,12 +17,41 @@ lix::Capsule::~Capsule() noexcept {}
 
 lix::Capsule *lix::Capsule::clone() const { return new lix::Capsule(*this); }
 
-glm::vec3 lix::Capsule::supportPoint(const glm::vec3 &) {
-    throw std::runtime_error("capsule support point not implemented");
+glm::vec3 lix::Capsule::worldA() {
+    return _trs->translation() + glm::mat3(_trs->modelMatrix()) * _a;
+}
+
+glm::vec3 lix::Capsule::worldB() {
+    return _trs->translation() + glm::mat3(_trs->modelMatrix()) * _b;
+}
+
+glm::vec3 lix::Capsule::supportPoint(const glm::vec3 &dir) {
+    const glm::vec3 A = worldA();
+    const glm::vec3 B = worldB();
+    const glm::vec3 end = glm::dot(A, dir) > glm::dot(B, dir) ? A : B;
+    if (_caps) {
+        return end + glm::normalize(dir) * worldRadius();
+    }
+    // Cylinder, the rim point furthest along dir.
+    const glm::vec3 n = glm::normalize(B - A);
+    const glm::vec3 radial = dir - n * glm::dot(dir, n);
+    const float len = glm::length(radial);
+    if (len < FLT_EPSILON) {
+        return end;
+    }
+    return end + radial * (worldRadius() / len);
+}
+
+lix::Bounds lix::Capsule::bounds() {
+    glm::mat3 m = glm::mat3(_trs->modelMatrix());
+    const glm::vec3 A = _trs->translation() + m * _a;
+    const glm::vec3 B = _trs->translation() + m * _b;
+    const glm::vec3 r{worldRadius()};
+    return {glm::min(A, B) - r, glm::max(A, B) + r};
 }
 
-bool lix::Capsule::intersects(Capsule &) {
-    throw std::runtime_error("capsule-capsule collision not implemented");
+bool lix::Capsule::intersects(Capsule &capsule) {
+    return lix::overlaps(*this, capsule);
 }
 
 bool lix::Capsule::intersects(Sphere &sphere) {
@@ -40,8 +70,8 @@ bool lix::Capsule::intersects(Sphere &sphere) {
 
     float d = glm::dot(AC, n);
 
-    float r1 = _radii * _trs->scale().x;
-    float r2 = sphere.radii() * sphere.trs()->scale().x;
+    float r1 = worldRadius();
+    float r2 = sphere.worldRadius();
     if (_caps) {
         if (d < -r1 || d > (len + r1)) {
             return false;
@@ -64,8 +94,8 @@ bool lix::Capsule::intersects(lix::AABB &aabb) {
     return aabb.intersects(*this);
 }
 
-bool lix::Capsule::intersects(Polygon &) {
-    throw std::runtime_error("capsule-polygon collision not implemented");
+bool lix::Capsule::intersects(Polygon &polygon) {
+    return lix::overlaps(*this, polygon);
 }
 
 bool lix::Capsule::doTest(Shape &shape) { return shape.intersects(*this); }
\ No newline at end of file
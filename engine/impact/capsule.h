@@ -1,5 +1,7 @@
 #pragma once
 
+#include <algorithm>
+
 #include "shape.h"
 
 namespace lix {
@@ -13,7 +15,13 @@ class Capsule : public Shape {
 
     virtual Capsule *clone() const override;
 
+    // Without caps it is a cylinder, left to GJK/EPA.
+    virtual lix::ShapeType type() const override {
+        return _caps ? lix::ShapeType::Capsule : lix::ShapeType::Convex;
+    }
+
     virtual glm::vec3 supportPoint(const glm::vec3 &dir) override;
+    virtual lix::Bounds bounds() override;
     virtual bool intersects(Capsule &capsule) override;
     virtual bool intersects(Sphere &sphere) override;
     virtual bool intersects(AABB &aabb) override;
@@ -28,6 +36,15 @@ class Capsule : public Shape {
 
     float radii() const { return _radii; }
 
+    // World space end points and radius.
+    glm::vec3 worldA();
+    glm::vec3 worldB();
+    // Scaled by the largest scale, which keeps the capsule round.
+    float worldRadius() const {
+        const glm::vec3 scale = glm::abs(_trs->scale());
+        return _radii * std::max(std::max(scale.x, scale.y), scale.z);
+    }
+
   private:
     glm::vec3 _a;
     glm::vec3 _b;
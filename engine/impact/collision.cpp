@@ -5,24 +5,11 @@
 #include <iomanip>
 #include <iostream>
 #include <sstream>
-#include <unordered_map>
+#include <stdexcept>
 
 #include "polygon.h"
 #include "primer.h"
 
-struct Vec3Hash {
-    std::size_t operator()(const glm::vec3 &v) const {
-        std::hash<float> hasher;
-        std::size_t seed = 0;
-        seed ^= hasher(v.x) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
-        seed ^= hasher(v.y) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
-        seed ^= hasher(v.z) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
-        return seed;
-    }
-};
-
-static std::unordered_map<glm::vec3, glm::vec3, Vec3Hash> minkowskiToDirection;
-
 // #define COLLISION_LOG_TO_FILE
 #ifdef COLLISION_LOG_TO_FILE
 static std::ofstream logOfs;
@@ -34,12 +21,35 @@ std::ostream &operator<<(std::ostream &os, const glm::vec3 &v) {
     return os;
 }
 
+void lix::GJKScratch::clear() { _directions.clear(); }
+
+void lix::GJKScratch::record(const glm::vec3 &minkowskiSP,
+                             const glm::vec3 &direction) {
+    _directions.emplace_back(minkowskiSP, direction);
+}
+
+const glm::vec3 &
+lix::GJKScratch::direction(const glm::vec3 &minkowskiSP) const {
+    // Latest first, a point found again keeps its most recent direction.
+    for (auto it = _directions.rbegin(); it != _directions.rend(); ++it) {
+        if (it->first == minkowskiSP) {
+            return it->second;
+        }
+    }
+    throw std::out_of_range("support point not found by this query");
+}
+
+lix::GJKScratch &lix::GJKScratch::local() {
+    thread_local GJKScratch scratch;
+    return scratch;
+}
+
 glm::vec3 minkowskiSupportPoint(lix::Shape &a, lix::Shape &b,
-                                const glm::vec3 &D) {
+                                const glm::vec3 &D,
+                                lix::GJKScratch &scratch) {
     glm::vec3 spA = a.supportPoint(D);
     glm::vec3 spB = b.supportPoint(-D);
     glm::vec3 sp = spA - spB;
-    minkowskiToDirection[sp] = D;
     // sp.x = std::max(sp.x, EPSILON);
     // sp.y = std::max(sp.y, EPSILON);
     if (sp.x == 0) {
@@ -48,14 +58,19 @@ glm::vec3 minkowskiSupportPoint(lix::Shape &a, lix::Shape &b,
     if (sp.y == 0) {
         sp.y = lix::EPSILON;
     }
+    // Recorded as returned, that is the point later looked up.
+    scratch.record(sp, D);
     return sp;
 }
 
 lix::gjk_state emptyCase(lix::Shape &shapeA, lix::Shape &shapeB,
                          std::vector<glm::vec3> &simplex, lix::Collision *,
-                         const glm::vec3 &initialDirection) {
-    const glm::vec3 B = minkowskiSupportPoint(shapeA, shapeB, initialDirection);
-    const glm::vec3 A = minkowskiSupportPoint(shapeA, shapeB, -B); // D=C0
+                         const glm::vec3 &initialDirection,
+                         lix::GJKScratch &scratch) {
+    const glm::vec3 B =
+        minkowskiSupportPoint(shapeA, shapeB, initialDirection, scratch);
+    const glm::vec3 A =
+        minkowskiSupportPoint(shapeA, shapeB, -B, scratch); // D=C0
 
     // glm::vec3 AB = B - A;
     // if (glm::dot(AB, -A) < 0 || glm::dot(AB, AB) < lix::EPSILON)
@@ -101,7 +116,7 @@ lix::gjk_state emptyCase(lix::Shape &shapeA, lix::Shape &shapeB,
 
 lix::gjk_state edgeCase(lix::Shape &shapeA, lix::Shape &shapeB,
                         std::vector<glm::vec3> &simplex,
-                        lix::Collision *collision) {
+                        lix::Collision *collision, lix::GJKScratch &scratch) {
     const glm::vec3 &A = simplex[0];
     const glm::vec3 &B = simplex[1];
 
@@ -111,7 +126,7 @@ lix::gjk_state edgeCase(lix::Shape &shapeA, lix::Shape &shapeB,
     assert(t >= 0 && t <= 1);
     glm::vec3 C = A + AB * t;
 
-    glm::vec3 D = minkowskiSupportPoint(shapeA, shapeB, -C);
+    glm::vec3 D = minkowskiSupportPoint(shapeA, shapeB, -C, scratch);
 
     float C_dist = glm::dot(C, C);
 
@@ -142,7 +157,8 @@ lix::gjk_state edgeCase(lix::Shape &shapeA, lix::Shape &shapeB,
 }
 
 lix::gjk_state triangleCase(lix::Shape &shapeA, lix::Shape &shapeB,
-                            std::vector<glm::vec3> &simplex) {
+                            std::vector<glm::vec3> &simplex,
+                            lix::GJKScratch &scratch) {
     const glm::vec3 &C = simplex[0];
     const glm::vec3 &B = simplex[1];
     const glm::vec3 &A = simplex[2];
@@ -169,7 +185,8 @@ lix::gjk_state triangleCase(lix::Shape &shapeA, lix::Shape &shapeB,
             if (t < 0 || t > 1) {
                 return lix::gjk_state::NO_COLLISION;
             }
-            simplex.push_back(minkowskiSupportPoint(shapeA, shapeB, -T));
+            simplex.push_back(
+                minkowskiSupportPoint(shapeA, shapeB, -T, scratch));
         } else {
             simplex.erase(simplex.begin() + 0);
             float t = -(glm::dot(AC, A) / glm::dot(AC, AC));
@@ -178,20 +195,25 @@ lix::gjk_state triangleCase(lix::Shape &shapeA, lix::Shape &shapeB,
             if (t < 0 || t > 1) {
                 return lix::gjk_state::NO_COLLISION;
             }
-            simplex.push_back(minkowskiSupportPoint(shapeA, shapeB, -T));
+            simplex.push_back(
+                minkowskiSupportPoint(shapeA, shapeB, -T, scratch));
         }
         return lix::gjk_state::INCREMENTING;
     }
 
     float dist = glm::dot(ABC, -A);
-    assert(dist != 0.0f);
+    if (dist == 0.0f) {
+        // Degenerate triangle or the origin on its plane, the support
+        // function made no progress so the shapes at most touch.
+        return lix::gjk_state::NO_COLLISION;
+    }
     if (dist > 0) // Triangle above the origin
     {
-        simplex.push_back(minkowskiSupportPoint(shapeA, shapeB, ABC));
+        simplex.push_back(minkowskiSupportPoint(shapeA, shapeB, ABC, scratch));
         std::swap(simplex[0], simplex[1]); // B <-> C
         // return -1;
     } else if (dist < 0) {
-        simplex.push_back(minkowskiSupportPoint(shapeA, shapeB, -ABC));
+        simplex.push_back(minkowskiSupportPoint(shapeA, shapeB, -ABC, scratch));
         // std::swap(simplex[0], simplex[1]); // B <-> C
         // return -1;
     }
@@ -206,7 +228,8 @@ lix::gjk_state triangleCase(lix::Shape &shapeA, lix::Shape &shapeB,
 
 lix::gjk_state tetrahedronCase(lix::Shape &shapeA, lix::Shape &shapeB,
                                std::vector<glm::vec3> &simplex,
-                               lix::Collision *collision) {
+                               lix::Collision *collision,
+                               lix::GJKScratch &scratch) {
     const glm::vec3 &D = simplex[0];
     const glm::vec3 &C = simplex[1];
     const glm::vec3 &B = simplex[2];
@@ -226,7 +249,7 @@ lix::gjk_state tetrahedronCase(lix::Shape &shapeA, lix::Shape &shapeB,
     float l0 = glm::dot(ABC, -A);
     if (l0 >= 0) {
         simplex.erase(simplex.begin());
-        glm::vec3 E = minkowskiSupportPoint(shapeA, shapeB, ABC);
+        glm::vec3 E = minkowskiSupportPoint(shapeA, shapeB, ABC, scratch);
         if (glm::dot(ABC, -E) > 0) {
             return lix::gjk_state::NO_COLLISION;
         }
@@ -236,7 +259,7 @@ lix::gjk_state tetrahedronCase(lix::Shape &shapeA, lix::Shape &shapeB,
     float l1 = glm::dot(ACD, -A);
     if (l1 >= 0) {
         simplex.erase(simplex.begin() + 2);
-        glm::vec3 E = minkowskiSupportPoint(shapeA, shapeB, ACD);
+        glm::vec3 E = minkowskiSupportPoint(shapeA, shapeB, ACD, scratch);
         if (glm::dot(ACD, -E) > 0) {
             return lix::gjk_state::NO_COLLISION;
         }
@@ -246,7 +269,7 @@ lix::gjk_state tetrahedronCase(lix::Shape &shapeA, lix::Shape &shapeB,
     float l2 = glm::dot(ADB, -A);
     if (l2 >= 0) {
         simplex.erase(simplex.begin() + 1);
-        glm::vec3 E = minkowskiSupportPoint(shapeA, shapeB, ADB);
+        glm::vec3 E = minkowskiSupportPoint(shapeA, shapeB, ADB, scratch);
         if (glm::dot(ADB, -E) > 0) {
             return lix::gjk_state::NO_COLLISION;
         }
@@ -256,7 +279,7 @@ lix::gjk_state tetrahedronCase(lix::Shape &shapeA, lix::Shape &shapeB,
     float l3 = glm::dot(BDC, -B);
     if (l3 >= 0) {
         simplex.erase(simplex.begin() + 3);
-        glm::vec3 E = minkowskiSupportPoint(shapeA, shapeB, BDC);
+        glm::vec3 E = minkowskiSupportPoint(shapeA, shapeB, BDC, scratch);
         if (glm::dot(BDC, -E) > 0) {
             return lix::gjk_state::NO_COLLISION;
         }
@@ -316,8 +339,7 @@ bool lix::collides(lix::Shape &a, lix::Shape &b, lix::Collision *collision) {
             glm::normalize(b.trs()->translation() - a.trs()->translation());
         if (lix::gjk(a, b, simplex, D, collision)) {
             if (!lix::epa(a, b, simplex, collision)) {
-                printf("error: epa failed\n");
-                return false;
+                return false; // a flat simplex, or EPA gave up
             }
             return true;
         }
@@ -327,19 +349,28 @@ bool lix::collides(lix::Shape &a, lix::Shape &b, lix::Collision *collision) {
 
 bool lix::gjk(Shape &shapeA, Shape &shapeB, std::vector<glm::vec3> &simplex,
               const glm::vec3 &initialDirection, lix::Collision *collision) {
-    gjk_init();
+    return gjk(shapeA, shapeB, simplex, initialDirection, collision,
+               GJKScratch::local());
+}
+
+bool lix::gjk(Shape &shapeA, Shape &shapeB, std::vector<glm::vec3> &simplex,
+              const glm::vec3 &initialDirection, lix::Collision *collision,
+              lix::GJKScratch &scratch) {
+    gjk_init(scratch);
 
     lix::gjk_state rval{lix::gjk_state::INCREMENTING};
     for (size_t i{0UL}; (i < 64UL) && (rval == gjk_state::INCREMENTING); ++i) {
-        rval =
-            gjk_increment(shapeA, shapeB, simplex, initialDirection, collision);
+        rval = gjk_increment(shapeA, shapeB, simplex, initialDirection,
+                             collision, scratch);
     }
     assert(rval != gjk_state::ERROR);
     return rval == gjk_state::COLLISION;
 }
 
-void lix::gjk_init() {
-    minkowskiToDirection.clear();
+void lix::gjk_init() { gjk_init(GJKScratch::local()); }
+
+void lix::gjk_init(lix::GJKScratch &scratch) {
+    scratch.clear();
 #ifdef COLLISION_LOG_TO_FILE
     if (logOfs.is_open()) {
         logOfs.close();
@@ -353,19 +384,29 @@ lix::gjk_state lix::gjk_increment(Shape &shapeA, Shape &shapeB,
                                   std::vector<glm::vec3> &simplex,
                                   const glm::vec3 &initialDirection,
                                   lix::Collision *collision) {
+    return gjk_increment(shapeA, shapeB, simplex, initialDirection, collision,
+                         GJKScratch::local());
+}
+
+lix::gjk_state lix::gjk_increment(Shape &shapeA, Shape &shapeB,
+                                  std::vector<glm::vec3> &simplex,
+                                  const glm::vec3 &initialDirection,
+                                  lix::Collision *collision,
+                                  lix::GJKScratch &scratch) {
     lix::gjk_state rval{lix::gjk_state::ERROR};
     switch (simplex.size()) {
     case 0UL:
-        rval = emptyCase(shapeA, shapeB, simplex, collision, initialDirection);
+        rval = emptyCase(shapeA, shapeB, simplex, collision, initialDirection,
+                         scratch);
         break;
     case 2UL:
-        rval = edgeCase(shapeA, shapeB, simplex, collision);
+        rval = edgeCase(shapeA, shapeB, simplex, collision, scratch);
         break;
     case 3UL:
-        rval = triangleCase(shapeA, shapeB, simplex);
+        rval = triangleCase(shapeA, shapeB, simplex, scratch);
         break;
     case 4UL:
-        rval = tetrahedronCase(shapeA, shapeB, simplex, collision);
+        rval = tetrahedronCase(shapeA, shapeB, simplex, collision, scratch);
         break;
     default:
         rval = gjk_state::ERROR;
@@ -394,6 +435,12 @@ findClosestFace(lix::ConvexHull &ch) {
 bool lix::epa(Shape &shapeA, Shape &shapeB,
               const std::vector<glm::vec3> &simplex,
               lix::Collision *collision) {
+    return epa(shapeA, shapeB, simplex, collision, GJKScratch::local());
+}
+
+bool lix::epa(Shape &shapeA, Shape &shapeB,
+              const std::vector<glm::vec3> &simplex, lix::Collision *collision,
+              lix::GJKScratch &scratch) {
     for (size_t i{0}; i < simplex.size(); ++i) {
         for (size_t j{0}; j < simplex.size(); ++j) {
             if (i == j)
@@ -402,10 +449,15 @@ bool lix::epa(Shape &shapeA, Shape &shapeB,
         }
     }
 
-    lix::ConvexHull ch{simplex};
+    // A simplex GJK left flat encloses no volume to expand, report no
+    // contact rather than guess a normal.
+    thread_local lix::ConvexHull ch;
+    if (!ch.build(simplex)) {
+        return false;
+    }
 
     for (size_t i{0}; i < 50; ++i) {
-        if (epa_increment(shapeA, shapeB, ch, collision)) {
+        if (epa_increment(shapeA, shapeB, ch, collision, scratch)) {
             return true;
         }
     }
@@ -414,11 +466,16 @@ bool lix::epa(Shape &shapeA, Shape &shapeB,
 
 bool lix::epa_increment(Shape &shapeA, Shape &shapeB, lix::ConvexHull &ch,
                         lix::Collision *collision) {
+    return epa_increment(shapeA, shapeB, ch, collision, GJKScratch::local());
+}
+
+bool lix::epa_increment(Shape &shapeA, Shape &shapeB, lix::ConvexHull &ch,
+                        lix::Collision *collision, lix::GJKScratch &scratch) {
     auto [minFaceIt, minDistance] = findClosestFace(ch);
-    glm::vec3 sp = minkowskiSupportPoint(
-        shapeA, shapeB,
-        minFaceIt->normal); // shapeA.supportPoint(minFaceIt->normal) -
-                            // shapeB.supportPoint(-minFaceIt->normal);
+    // shapeA.supportPoint(minFaceIt->normal) -
+    // shapeB.supportPoint(-minFaceIt->normal);
+    glm::vec3 sp =
+        minkowskiSupportPoint(shapeA, shapeB, minFaceIt->normal, scratch);
     float sDistance = glm::dot(minFaceIt->normal, sp);
     // printf("sDistance=%.3f minDistance=%.3f\n", sDistance, minDistance);
     if (glm::abs(sDistance - minDistance) < 0.0001f) {
@@ -427,9 +484,9 @@ bool lix::epa_increment(Shape &shapeA, Shape &shapeB, lix::ConvexHull &ch,
         const glm::vec3 &c = minFaceIt->half_edge->next->next->vertex;
 
         if (collision) {
-            glm::vec3 aa = getSupportPointOfA(shapeA, a);
-            glm::vec3 bb = getSupportPointOfA(shapeA, b);
-            glm::vec3 cc = getSupportPointOfA(shapeA, c);
+            glm::vec3 aa = getSupportPointOfA(shapeA, a, scratch);
+            glm::vec3 bb = getSupportPointOfA(shapeA, b, scratch);
+            glm::vec3 cc = getSupportPointOfA(shapeA, c, scratch);
 
             bool isSameAB = isSameVertex(aa, bb);
             bool isSameBC = isSameVertex(bb, cc);
@@ -466,7 +523,9 @@ bool lix::epa_increment(Shape &shapeA, Shape &shapeB, lix::ConvexHull &ch,
         // printf("converged on iteration: %zu\n", i);
         return true;
     } else {
-        assert(ch.addPoint(sp));
+        bool added = ch.addPoint(sp);
+        assert(added);
+        (void)added;
         // printf("adding %.1f %.1f %.1f\n", sp.x, sp.y, sp.z);
     }
     return false;
@@ -474,10 +533,22 @@ bool lix::epa_increment(Shape &shapeA, Shape &shapeB, lix::ConvexHull &ch,
 
 glm::vec3 lix::getSupportPointOfA(lix::Shape &shape,
                                   const glm::vec3 &minkowskiSP) {
-    return shape.supportPoint(minkowskiToDirection.at(minkowskiSP));
+    return getSupportPointOfA(shape, minkowskiSP, GJKScratch::local());
+}
+
+glm::vec3 lix::getSupportPointOfA(lix::Shape &shape,
+                                  const glm::vec3 &minkowskiSP,
+                                  const lix::GJKScratch &scratch) {
+    return shape.supportPoint(scratch.direction(minkowskiSP));
 }
 
 glm::vec3 lix::getSupportPointOfB(lix::Shape &shape,
                                   const glm::vec3 &minkowskiSP) {
-    return shape.supportPoint(-minkowskiToDirection.at(minkowskiSP));
+    return getSupportPointOfB(shape, minkowskiSP, GJKScratch::local());
+}
+
+glm::vec3 lix::getSupportPointOfB(lix::Shape &shape,
+                                  const glm::vec3 &minkowskiSP,
+                                  const lix::GJKScratch &scratch) {
+    return shape.supportPoint(-scratch.direction(minkowskiSP));
 }
\ No newline at end of file
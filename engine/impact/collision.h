@@ -3,6 +3,7 @@
 #include "convexhull.h"
 #include "halfedge.h"
 #include "shape.h"
+#include <utility>
 #include <vector>
 
 namespace lix {
@@ -17,23 +18,58 @@ struct Collision {
 
 enum class gjk_state { ERROR, INCREMENTING, COLLISION, NO_COLLISION };
 
+// Scratch state of one GJK/EPA query: the direction every Minkowski support
+// point was found in, so the contact point can be recovered on the shapes.
+// Queries running at the same time need one each. The overloads without a
+// scratch argument use GJKScratch::local().
+class GJKScratch {
+  public:
+    void clear();
+    void record(const glm::vec3 &minkowskiSP, const glm::vec3 &direction);
+    // Throws std::out_of_range for points not found since the last clear().
+    const glm::vec3 &direction(const glm::vec3 &minkowskiSP) const;
+
+    // One per thread.
+    static GJKScratch &local();
+
+  private:
+    std::vector<std::pair<glm::vec3, glm::vec3>> _directions;
+};
+
 bool collides(Shape &a, Shape &b, lix::Collision *collision);
 
 bool gjk(Shape &a, Shape &b, std::vector<glm::vec3> &simplex,
          const glm::vec3 &initialDirection, lix::Collision *collision);
+bool gjk(Shape &a, Shape &b, std::vector<glm::vec3> &simplex,
+         const glm::vec3 &initialDirection, lix::Collision *collision,
+         lix::GJKScratch &scratch);
 
 void gjk_init();
+void gjk_init(lix::GJKScratch &scratch);
 
 lix::gjk_state gjk_increment(Shape &a, Shape &b,
                              std::vector<glm::vec3> &simplex,
                              const glm::vec3 &initialDirection,
                              lix::Collision *collision);
+lix::gjk_state gjk_increment(Shape &a, Shape &b,
+                             std::vector<glm::vec3> &simplex,
+                             const glm::vec3 &initialDirection,
+                             lix::Collision *collision,
+                             lix::GJKScratch &scratch);
 
 glm::vec3 getSupportPointOfA(Shape &shape, const glm::vec3 &minkowskiSP);
+glm::vec3 getSupportPointOfA(Shape &shape, const glm::vec3 &minkowskiSP,
+                             const lix::GJKScratch &scratch);
 glm::vec3 getSupportPointOfB(Shape &shape, const glm::vec3 &minkowskiSP);
+glm::vec3 getSupportPointOfB(Shape &shape, const glm::vec3 &minkowskiSP,
+                             const lix::GJKScratch &scratch);
 
 bool epa(Shape &a, Shape &b, const std::vector<glm::vec3> &simplex,
          lix::Collision *collision);
+bool epa(Shape &a, Shape &b, const std::vector<glm::vec3> &simplex,
+         lix::Collision *collision, lix::GJKScratch &scratch);
 bool epa_increment(Shape &a, Shape &b, lix::ConvexHull &ch,
                    lix::Collision *collision);
+bool epa_increment(Shape &a, Shape &b, lix::ConvexHull &ch,
+                   lix::Collision *collision, lix::GJKScratch &scratch);
 } // namespace lix
\ No newline at end of file
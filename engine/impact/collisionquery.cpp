@@ -0,0 +1,483 @@
+#include "collisionquery.h"
+
+#include <algorithm>
+#include <cfloat>
+
+#include "primer.h"
+
+namespace {
+// Any unit vector perpendicular to v.
+inline glm::vec3 perpendicular(const glm::vec3 &v) {
+    const glm::vec3 axis = glm::abs(v.x) < 0.57f ? glm::vec3{1.0f, 0.0f, 0.0f}
+                                                 : glm::vec3{0.0f, 1.0f, 0.0f};
+    return glm::normalize(glm::cross(v, axis));
+}
+
+// Direction from segment ab towards o, perpendicular to ab.
+inline glm::vec3 towardsOrigin(const glm::vec3 &ab, const glm::vec3 &ao) {
+    glm::vec3 direction = glm::cross(glm::cross(ab, ao), ab);
+    if (glm::dot(direction, direction) < FLT_EPSILON * FLT_EPSILON) {
+        // The origin is on the line.
+        return perpendicular(ab);
+    }
+    return direction;
+}
+} // namespace
+
+glm::vec3 lix::seedDirection(const lix::Shape &a, const lix::Shape &b) {
+    static const glm::vec3 skew{0.0123f, 0.0371f, 0.0917f};
+    return b.trs()->translation() - a.trs()->translation() + skew;
+}
+
+bool lix::CollisionQuery::collides(lix::Shape &a, lix::Shape &b,
+                                   const glm::vec3 &initialDirection,
+                                   lix::Collision *collision) {
+    _a = &a;
+    _b = &b;
+    _hintA = 0;
+    _hintB = 0;
+    _epaIterations = 0;
+    if (!gjk(initialDirection)) {
+        return false;
+    }
+    if (collision == nullptr) {
+        return true;
+    }
+    return epa(*collision);
+}
+
+bool lix::CollisionQuery::intersects(lix::Shape &a, lix::Shape &b,
+                                     const glm::vec3 &initialDirection) {
+    return collides(a, b, initialDirection, nullptr);
+}
+
+float lix::CollisionQuery::distance(lix::Shape &a, lix::Shape &b,
+                                    const glm::vec3 &initialDirection,
+                                    glm::vec3 &normal) {
+    _a = &a;
+    _b = &b;
+    _hintA = 0;
+    _hintB = 0;
+    _epaIterations = 0;
+    glm::vec3 v = support(initialDirection).w;
+    _simplex[0] = {v, glm::vec3{0.0f}};
+    _simplexSize = 1;
+    // v is the point of a - b closest to the origin found so far, it only
+    // gets closer. Stop once a support point along -v gains next to nothing.
+    for (_gjkIterations = 1; _gjkIterations < MAX_GJK_ITERATIONS;
+         ++_gjkIterations) {
+        const float vv = glm::dot(v, v);
+        if (vv < TOLERANCE * TOLERANCE) {
+            return 0.0f;
+        }
+        const SupportVertex vertex = support(-v);
+        if (vv - glm::dot(v, vertex.w) <= TOLERANCE * glm::sqrt(vv)) {
+            break;
+        }
+        _simplex[_simplexSize++] = vertex;
+        glm::vec3 closer;
+        if (!closestOnSimplex(closer)) {
+            return 0.0f; // the simplex encloses the origin
+        }
+        if (glm::dot(closer, closer) >= vv) {
+            break; // rounding, no progress
+        }
+        v = closer;
+    }
+    const float length = glm::length(v);
+    normal = v / length;
+    return length;
+}
+
+lix::CollisionQuery::SupportVertex
+lix::CollisionQuery::support(const glm::vec3 &direction) {
+    const glm::vec3 a = _a->hintedSupportPoint(direction, _hintA);
+    return {a - _b->hintedSupportPoint(-direction, _hintB), a};
+}
+
+bool lix::CollisionQuery::gjk(const glm::vec3 &initialDirection) {
+    glm::vec3 direction = initialDirection;
+    if (glm::dot(direction, direction) < FLT_EPSILON) {
+        direction = glm::vec3{1.0f, 0.0f, 0.0f};
+    }
+    _simplex[0] = support(direction);
+    _simplexSize = 1;
+    _gjkIterations = 1;
+    _direction = direction;
+    if (glm::dot(_simplex[0].w, direction) < 0.0f) {
+        return false; // a separating axis to begin with
+    }
+    direction = -_simplex[0].w;
+    if (glm::dot(direction, direction) < FLT_EPSILON * FLT_EPSILON) {
+        direction = -_direction;
+    }
+    for (; _gjkIterations < MAX_GJK_ITERATIONS; ++_gjkIterations) {
+        const SupportVertex vertex = support(direction);
+        _direction = direction;
+        if (glm::dot(vertex.w, direction) < 0.0f) {
+            return false; // the origin is beyond the furthest point
+        }
+        _simplex[_simplexSize++] = vertex;
+        if (updateSimplex(direction)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// The newest point is last. Reduces the simplex to the feature closest to the
+// origin and returns true once a tetrahedron encloses it.
+bool lix::CollisionQuery::updateSimplex(glm::vec3 &direction) {
+    switch (_simplexSize) {
+    case 2:
+        return lineCase(direction);
+    case 3:
+        return triangleCase(direction);
+    default:
+        return tetrahedronCase(direction);
+    }
+}
+
+bool lix::CollisionQuery::lineCase(glm::vec3 &direction) {
+    const SupportVertex &A = _simplex[1];
+    const glm::vec3 ab = _simplex[0].w - A.w;
+    const glm::vec3 ao = -A.w;
+    if (glm::dot(ab, ao) > 0.0f) {
+        direction = towardsOrigin(ab, ao);
+    } else {
+        _simplex[0] = A;
+        _simplexSize = 1;
+        direction = ao;
+    }
+    return false;
+}
+
+bool lix::CollisionQuery::triangleCase(glm::vec3 &direction) {
+    const SupportVertex A = _simplex[2];
+    const SupportVertex B = _simplex[1];
+    const SupportVertex C = _simplex[0];
+    const glm::vec3 ab = B.w - A.w;
+    const glm::vec3 ac = C.w - A.w;
+    const glm::vec3 ao = -A.w;
+    const glm::vec3 abc = glm::cross(ab, ac);
+
+    if (glm::dot(glm::cross(abc, ac), ao) > 0.0f) {
+        if (glm::dot(ac, ao) > 0.0f) {
+            _simplex[0] = C;
+            _simplex[1] = A;
+            _simplexSize = 2;
+            direction = towardsOrigin(ac, ao);
+            return false;
+        }
+        _simplex[0] = B;
+        _simplex[1] = A;
+        _simplexSize = 2;
+        return lineCase(direction);
+    }
+    if (glm::dot(glm::cross(ab, abc), ao) > 0.0f) {
+        _simplex[0] = B;
+        _simplex[1] = A;
+        _simplexSize = 2;
+        return lineCase(direction);
+    }
+    // Above or below the triangle, the origin on its plane picks either side.
+    direction = glm::dot(abc, ao) >= 0.0f ? abc : -abc;
+    if (glm::dot(direction, direction) < FLT_EPSILON * FLT_EPSILON) {
+        direction = perpendicular(ab); // degenerate triangle
+    }
+    return false;
+}
+
+bool lix::CollisionQuery::tetrahedronCase(glm::vec3 &direction) {
+    const SupportVertex A = _simplex[3];
+    const SupportVertex B = _simplex[2];
+    const SupportVertex C = _simplex[1];
+    const SupportVertex D = _simplex[0];
+    const glm::vec3 ao = -A.w;
+
+    // Faces around A, each with the vertex opposite to it. Normals are turned
+    // away from that vertex, so the winding doesn't matter.
+    const std::array<std::array<const SupportVertex *, 3>, 3> faces{
+        {{&B, &C, &D}, {&C, &D, &B}, {&D, &B, &C}}};
+    for (const auto &[b, c, opposite] : faces) {
+        glm::vec3 normal = glm::cross(b->w - A.w, c->w - A.w);
+        if (glm::dot(normal, opposite->w - A.w) > 0.0f) {
+            normal = -normal;
+        }
+        if (glm::dot(normal, ao) > 0.0f) {
+            _simplex[0] = *c;
+            _simplex[1] = *b;
+            _simplex[2] = A;
+            _simplexSize = 3;
+            return triangleCase(direction);
+        }
+    }
+    return true;
+}
+
+// Closest point of the simplex to the origin, Ericson's Real-Time Collision
+// Detection 5.1. The simplex is reduced to the points that span it. Returns
+// false when the origin is inside the tetrahedron.
+bool lix::CollisionQuery::closestOnSimplex(glm::vec3 &closest) {
+    switch (_simplexSize) {
+    case 1:
+        closest = _simplex[0].w;
+        return true;
+    case 2:
+        closestOnSegment(_simplex[0], _simplex[1], closest);
+        return true;
+    case 3:
+        closestOnTriangle(_simplex[0], _simplex[1], _simplex[2], closest);
+        return true;
+    default:
+        break;
+    }
+
+    // Test the faces the origin is outside of, keep the closest result.
+    const std::array<SupportVertex, 4> tetrahedron = _simplex;
+    const std::array<std::array<uint32_t, 4>, 4> faces{
+        {{0, 1, 2, 3}, {0, 3, 1, 2}, {0, 2, 3, 1}, {1, 3, 2, 0}}};
+    float best = FLT_MAX;
+    std::array<SupportVertex, 4> bestSimplex;
+    uint32_t bestSize{0};
+    for (const auto &[i, j, k, opposite] : faces) {
+        const glm::vec3 &a = tetrahedron[i].w;
+        const glm::vec3 normal = glm::cross(tetrahedron[j].w - a,
+                                            tetrahedron[k].w - a);
+        if (glm::dot(-a, normal) * glm::dot(tetrahedron[opposite].w - a,
+                                            normal) > 0.0f) {
+            continue; // the origin is on the inner side
+        }
+        glm::vec3 point;
+        closestOnTriangle(tetrahedron[i], tetrahedron[j], tetrahedron[k],
+                          point);
+        const float distance2 = glm::dot(point, point);
+        if (distance2 < best) {
+            best = distance2;
+            closest = point;
+            bestSimplex = _simplex;
+            bestSize = _simplexSize;
+        }
+    }
+    if (bestSize == 0) {
+        return false;
+    }
+    _simplex = bestSimplex;
+    _simplexSize = bestSize;
+    return true;
+}
+
+void lix::CollisionQuery::closestOnSegment(const SupportVertex &a,
+                                           const SupportVertex &b,
+                                           glm::vec3 &closest) {
+    const glm::vec3 ab = b.w - a.w;
+    const float t = glm::dot(-a.w, ab) / glm::dot(ab, ab);
+    if (!(t > 0.0f)) {
+        _simplex[0] = a;
+        _simplexSize = 1;
+        closest = a.w;
+    } else if (t >= 1.0f) {
+        _simplex[0] = b;
+        _simplexSize = 1;
+        closest = b.w;
+    } else {
+        _simplex[0] = a;
+        _simplex[1] = b;
+        _simplexSize = 2;
+        closest = a.w + ab * t;
+    }
+}
+
+void lix::CollisionQuery::closestOnTriangle(const SupportVertex &A,
+                                            const SupportVertex &B,
+                                            const SupportVertex &C,
+                                            glm::vec3 &closest) {
+    // Copies, A, B and C may be entries of _simplex.
+    const SupportVertex a = A;
+    const SupportVertex b = B;
+    const SupportVertex c = C;
+    const glm::vec3 ab = b.w - a.w;
+    const glm::vec3 ac = c.w - a.w;
+    const float d1 = glm::dot(ab, -a.w);
+    const float d2 = glm::dot(ac, -a.w);
+    if (d1 <= 0.0f && d2 <= 0.0f) {
+        _simplex[0] = a;
+        _simplexSize = 1;
+        closest = a.w;
+        return;
+    }
+    const float d3 = glm::dot(ab, -b.w);
+    const float d4 = glm::dot(ac, -b.w);
+    if (d3 >= 0.0f && d4 <= d3) {
+        _simplex[0] = b;
+        _simplexSize = 1;
+        closest = b.w;
+        return;
+    }
+    const float vc = d1 * d4 - d3 * d2;
+    if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) {
+        _simplex[0] = a;
+        _simplex[1] = b;
+        _simplexSize = 2;
+        closest = a.w + ab * (d1 / (d1 - d3));
+        return;
+    }
+    const float d5 = glm::dot(ab, -c.w);
+    const float d6 = glm::dot(ac, -c.w);
+    if (d6 >= 0.0f && d5 <= d6) {
+        _simplex[0] = c;
+        _simplexSize = 1;
+        closest = c.w;
+        return;
+    }
+    const float vb = d5 * d2 - d1 * d6;
+    if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) {
+        _simplex[0] = a;
+        _simplex[1] = c;
+        _simplexSize = 2;
+        closest = a.w + ac * (d2 / (d2 - d6));
+        return;
+    }
+    const float va = d3 * d6 - d5 * d4;
+    if (va <= 0.0f && d4 - d3 >= 0.0f && d5 - d6 >= 0.0f) {
+        _simplex[0] = b;
+        _simplex[1] = c;
+        _simplexSize = 2;
+        closest =
+            b.w + (c.w - b.w) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+        return;
+    }
+    const float denominator = 1.0f / (va + vb + vc);
+    _simplex[0] = a;
+    _simplex[1] = b;
+    _simplex[2] = c;
+    _simplexSize = 3;
+    closest = a.w + ab * (vb * denominator) + ac * (vc * denominator);
+}
+
+bool lix::CollisionQuery::epa(lix::Collision &collision) {
+    _numVertices = 0;
+    _numFaces = 0;
+    _interior = glm::vec3{0.0f};
+    for (uint32_t i{0}; i < 4; ++i) {
+        _vertices[_numVertices++] = _simplex[i];
+        _interior += _simplex[i].w * 0.25f;
+    }
+    if (!addFace(0, 1, 2) || !addFace(0, 3, 1) || !addFace(0, 2, 3) ||
+        !addFace(1, 3, 2)) {
+        return false; // flat tetrahedron, the shapes only touch
+    }
+
+    for (_epaIterations = 0; _epaIterations < MAX_EPA_ITERATIONS;
+         ++_epaIterations) {
+        const Face &face = _faces[closestFace()];
+        const SupportVertex vertex = support(face.normal);
+        if (glm::dot(vertex.w, face.normal) - face.distance < TOLERANCE ||
+            _numVertices == MAX_VERTICES) {
+            break;
+        }
+
+        // Faces seen from the new vertex are replaced by a fan from the
+        // horizon to it.
+        _numEdges = 0;
+        uint32_t numVisible{0};
+        bool overflow{false};
+        for (uint32_t i{0}; i < _numFaces; ++i) {
+            const Face &f = _faces[i];
+            // Faces in the plane of the new vertex go too, keeping it off
+            // the line of any horizon edge.
+            _visible[i] = glm::dot(f.normal, vertex.w - _vertices[f.v[0]].w) >
+                          -lix::EPSILON;
+            if (_visible[i]) {
+                ++numVisible;
+                for (uint32_t k{0}; k < 3 && !overflow; ++k) {
+                    addHorizonEdge(f.v[k], f.v[(k + 1) % 3]);
+                    overflow = _numEdges == MAX_EDGES;
+                }
+            }
+        }
+        if (overflow || _numFaces - numVisible + _numEdges > MAX_FACES ||
+            !fanIsValid(vertex.w)) {
+            break;
+        }
+        for (uint32_t i{_numFaces}; i-- > 0;) {
+            if (_visible[i]) {
+                _faces[i] = _faces[--_numFaces];
+            }
+        }
+        const uint32_t index = _numVertices;
+        _vertices[_numVertices++] = vertex;
+        for (uint32_t i{0}; i < _numEdges; ++i) {
+            addFace(_edges[i].first, _edges[i].second, index);
+        }
+    }
+
+    const Face &face = _faces[closestFace()];
+    const SupportVertex &a = _vertices[face.v[0]];
+    const SupportVertex &b = _vertices[face.v[1]];
+    const SupportVertex &c = _vertices[face.v[2]];
+    const glm::vec3 bary =
+        lix::barycentric(face.normal * face.distance, a.w, b.w, c.w);
+    collision.contactPoint = a.a * bary[0] + b.a * bary[1] + c.a * bary[2];
+    collision.normal = -face.normal;
+    collision.penetrationDepth = face.distance;
+    _direction = face.normal;
+    collision.a = a.a;
+    collision.b = b.a;
+    collision.c = c.a;
+    return true;
+}
+
+// A new vertex in line with a horizon edge would leave a hole in the
+// polytope, the closest face is as good as it gets then.
+bool lix::CollisionQuery::fanIsValid(const glm::vec3 &w) const {
+    for (uint32_t i{0}; i < _numEdges; ++i) {
+        const glm::vec3 &a = _vertices[_edges[i].first].w;
+        const glm::vec3 &b = _vertices[_edges[i].second].w;
+        const glm::vec3 normal = glm::cross(b - a, w - a);
+        if (glm::dot(normal, normal) < FLT_EPSILON * FLT_EPSILON) {
+            return false;
+        }
+    }
+    return true;
+}
+
+uint32_t lix::CollisionQuery::closestFace() const {
+    uint32_t closest{0};
+    for (uint32_t i{1}; i < _numFaces; ++i) {
+        if (_faces[i].distance < _faces[closest].distance) {
+            closest = i;
+        }
+    }
+    return closest;
+}
+
+// Wound so the normal points out of the polytope, away from _interior.
+bool lix::CollisionQuery::addFace(uint32_t a, uint32_t b, uint32_t c) {
+    const glm::vec3 &A = _vertices[a].w;
+    glm::vec3 normal = glm::cross(_vertices[b].w - A, _vertices[c].w - A);
+    float length2 = glm::dot(normal, normal);
+    if (length2 < FLT_EPSILON * FLT_EPSILON) {
+        return false;
+    }
+    normal /= glm::sqrt(length2);
+    if (glm::dot(normal, A - _interior) < 0.0f) {
+        normal = -normal;
+        std::swap(b, c);
+    }
+    // The origin is inside, a negative distance is rounding.
+    _faces[_numFaces++] = {{a, b, c}, normal,
+                           std::max(glm::dot(normal, A), 0.0f)};
+    return true;
+}
+
+// Edges shared by two visible faces are inside the hole and cancel out.
+void lix::CollisionQuery::addHorizonEdge(uint32_t a, uint32_t b) {
+    for (uint32_t i{0}; i < _numEdges; ++i) {
+        if (_edges[i].first == b && _edges[i].second == a) {
+            _edges[i] = _edges[--_numEdges];
+            return;
+        }
+    }
+    _edges[_numEdges++] = {a, b};
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <utility>
+
+#include "collision.h"
+#include "shape.h"
+
+namespace lix {
+// GJK/EPA on fixed size buffers. Answers the same question as
+// lix::gjk() + lix::epa() without allocating: the simplex is an array of at
+// most four points, the EPA polytope lives in arrays sized for MAX_VERTICES
+// and each Minkowski point keeps the support point on a that it came from, so
+// the contact point needs no direction lookup. Keep one per thread, a query
+// overwrites the previous one. Support searches are hinted from one GJK/EPA
+// iteration to the next, but each query starts over, so the answer doesn't
+// depend on which queries the thread ran before.
+class CollisionQuery {
+  public:
+    static constexpr size_t MAX_GJK_ITERATIONS{64};
+    static constexpr size_t MAX_EPA_ITERATIONS{64};
+    static constexpr size_t MAX_VERTICES{64};
+    static constexpr size_t MAX_FACES{2 * MAX_VERTICES};
+    static constexpr size_t MAX_EDGES{3 * MAX_VERTICES};
+    // EPA stops once a support point is this close to the closest face.
+    static constexpr float TOLERANCE{1e-4f};
+
+    // collision, when given, is filled in like lix::epa() does.
+    bool collides(lix::Shape &a, lix::Shape &b,
+                  const glm::vec3 &initialDirection,
+                  lix::Collision *collision);
+    // Only the GJK boolean test.
+    bool intersects(lix::Shape &a, lix::Shape &b,
+                    const glm::vec3 &initialDirection);
+
+    // Distance between the shapes by GJK, 0 when they touch or overlap.
+    // Otherwise normal is the unit direction from b to a.
+    float distance(lix::Shape &a, lix::Shape &b,
+                   const glm::vec3 &initialDirection, glm::vec3 &normal);
+
+    // Support queries made by GJK and EPA iterations in the last query.
+    uint32_t gjkIterations() const { return _gjkIterations; }
+
+    uint32_t epaIterations() const { return _epaIterations; }
+
+    // Where the last query ended up looking in a - b: a separating axis when
+    // the shapes were apart, -collision.normal when they collided. Seeds the
+    // next query of the same pair.
+    const glm::vec3 &direction() const { return _direction; }
+
+  private:
+    struct SupportVertex {
+        glm::vec3 w; // a - b
+        glm::vec3 a; // support point on a
+    };
+
+    struct Face {
+        std::array<uint32_t, 3> v;
+        glm::vec3 normal;
+        float distance;
+    };
+
+    SupportVertex support(const glm::vec3 &direction);
+    bool gjk(const glm::vec3 &initialDirection);
+    bool updateSimplex(glm::vec3 &direction);
+    bool lineCase(glm::vec3 &direction);
+    bool triangleCase(glm::vec3 &direction);
+    bool tetrahedronCase(glm::vec3 &direction);
+    bool closestOnSimplex(glm::vec3 &closest);
+    void closestOnSegment(const SupportVertex &a, const SupportVertex &b,
+                          glm::vec3 &closest);
+    void closestOnTriangle(const SupportVertex &a, const SupportVertex &b,
+                           const SupportVertex &c, glm::vec3 &closest);
+    bool epa(lix::Collision &collision);
+    uint32_t closestFace() const;
+    bool fanIsValid(const glm::vec3 &w) const;
+    bool addFace(uint32_t a, uint32_t b, uint32_t c);
+    void addHorizonEdge(uint32_t a, uint32_t b);
+
+    lix::Shape *_a{nullptr};
+    lix::Shape *_b{nullptr};
+    uint32_t _hintA{0};
+    uint32_t _hintB{0};
+    std::array<SupportVertex, 4> _simplex;
+    uint32_t _simplexSize{0};
+
+    std::array<SupportVertex, MAX_VERTICES> _vertices;
+    uint32_t _numVertices{0};
+    std::array<Face, MAX_FACES> _faces;
+    uint32_t _numFaces{0};
+    std::array<std::pair<uint32_t, uint32_t>, MAX_EDGES> _edges;
+    uint32_t _numEdges{0};
+    std::array<bool, MAX_FACES> _visible;
+    glm::vec3 _interior;
+    glm::vec3 _direction;
+
+    uint32_t _gjkIterations{0};
+    uint32_t _epaIterations{0};
+};
+
+// A first search direction for a query of a against b, from the center of a
+// towards the center of b. Skewed off that line, GJK trips over axis aligned
+// simplices, and never zero. Not normalized.
+glm::vec3 seedDirection(const lix::Shape &a, const lix::Shape &b);
+} // namespace lix
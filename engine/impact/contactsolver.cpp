@@ -0,0 +1,380 @@
+#include "contactsolver.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+inline lix::DynamicBody *asDynamic(lix::RigidBody *body) {
+    return body->is_dynamic() ? static_cast<lix::DynamicBody *>(body)
+                              : nullptr;
+}
+
+inline glm::vec3 toWorld(lix::RigidBody *body, const glm::vec3 &p) {
+    return glm::vec3(body->shape->trs()->modelMatrix() * glm::vec4{p, 1.0f});
+}
+
+inline glm::vec3 toLocal(lix::RigidBody *body, const glm::vec3 &p) {
+    return glm::vec3(glm::inverse(body->shape->trs()->modelMatrix()) *
+                     glm::vec4{p, 1.0f});
+}
+
+inline glm::vec3 velocityAt(lix::RigidBody *body, const glm::vec3 &r) {
+    lix::DynamicBody *dynamicBody = asDynamic(body);
+    if (dynamicBody == nullptr) {
+        return glm::vec3{0.0f};
+    }
+    return dynamicBody->velocity + glm::cross(dynamicBody->angularVelocity, r);
+}
+
+// Orthonormal basis around n, continuous except at n.z = 0 (Duff et al.).
+inline std::array<glm::vec3, 2> tangentBasis(const glm::vec3 &n) {
+    const float sign = std::copysign(1.0f, n.z);
+    const float a = -1.0f / (sign + n.z);
+    const float b = n.x * n.y * a;
+    return {glm::vec3{1.0f + sign * n.x * n.x * a, sign * b, -sign * n.x},
+            glm::vec3{b, sign + n.y * n.y * a, -n.y}};
+}
+
+inline float effectiveMass(const lix::ContactSolver::Manifold &manifold,
+                           const glm::vec3 &rA, const glm::vec3 &rB,
+                           const glm::vec3 &dir) {
+    const glm::vec3 angularA =
+        glm::cross(manifold.invInertia[0] * glm::cross(rA, dir), rA);
+    const glm::vec3 angularB =
+        glm::cross(manifold.invInertia[1] * glm::cross(rB, dir), rB);
+    float k = manifold.invMass[0] + manifold.invMass[1] +
+              glm::dot(angularA + angularB, dir);
+    return k > 0.0f ? 1.0f / k : 0.0f;
+}
+
+// Area spanned by four points, for any of their orderings.
+inline float quadArea(const glm::vec3 &a, const glm::vec3 &b,
+                      const glm::vec3 &c, const glm::vec3 &d) {
+    auto area = [](const glm::vec3 &u, const glm::vec3 &v) {
+        const glm::vec3 n = glm::cross(u, v);
+        return glm::dot(n, n);
+    };
+    return std::max({area(a - b, c - d), area(a - c, b - d),
+                     area(a - d, b - c)});
+}
+
+// Extent of a shape along two tangents, in both directions.
+struct Extents {
+    std::array<float, 4> bounds;
+
+    bool contains(const glm::vec3 &p, const std::array<glm::vec3, 2> &t) const {
+        static constexpr float tolerance{1e-3f};
+        for (size_t k{0}; k < 2; ++k) {
+            float d = glm::dot(p, t[k]);
+            if (d > bounds[2 * k] + tolerance ||
+                -d > bounds[2 * k + 1] + tolerance) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+inline Extents lateralExtents(lix::Shape &shape,
+                              const std::array<glm::vec3, 2> &t) {
+    Extents extents;
+    for (size_t k{0}; k < 2; ++k) {
+        extents.bounds[2 * k] = glm::dot(shape.supportPoint(t[k]), t[k]);
+        extents.bounds[2 * k + 1] = glm::dot(shape.supportPoint(-t[k]), -t[k]);
+    }
+    return extents;
+}
+} // namespace
+
+lix::ContactSolver::ContactSolver() : _settings{}, _manifolds{}, _active{} {}
+
+void lix::ContactSolver::beginFrame() {
+    ++_frame;
+    _active.clear();
+}
+
+void lix::ContactSolver::addContact(lix::RigidBody &a, lix::RigidBody &b,
+                                    const lix::Collision &collision) {
+    addContact(a, b, *a.shape, *b.shape, collision);
+}
+
+void lix::ContactSolver::addContact(lix::RigidBody &a, lix::RigidBody &b,
+                                    lix::Shape &partA, lix::Shape &partB,
+                                    const lix::Collision &collision) {
+    auto [it, inserted] =
+        _manifolds.try_emplace(lix::ShapePair{&partA, &partB});
+    Manifold &manifold = it->second;
+    if (inserted) {
+        manifold.count = 0;
+        manifold.frame = _frame - 1;
+    }
+    manifold.a = &a;
+    manifold.b = &b;
+    if (manifold.frame != _frame) {
+        refresh(manifold);
+        manifold.frame = _frame;
+        _active.push_back(&manifold);
+    }
+    manifold.normal = collision.normal;
+
+    // GJK/EPA gives a single point per step, which lets resting faces tip
+    // over before the opposite side makes contact. Gather the corners of the
+    // touching features with slightly tilted support queries instead.
+    const glm::vec3 &n = collision.normal;
+    const std::array<glm::vec3, 2> t = tangentBasis(n);
+    const std::array<glm::vec3, 4> tilts{
+        (t[0] + t[1]) * TILT, (t[0] - t[1]) * TILT, (-t[0] + t[1]) * TILT,
+        (-t[0] - t[1]) * TILT};
+    const Extents extentsA = lateralExtents(partA, t);
+    const Extents extentsB = lateralExtents(partB, t);
+    const float bottomA = glm::dot(partA.supportPoint(-n), n);
+    const float topB = glm::dot(partB.supportPoint(n), n);
+    bool added{false};
+    for (size_t i{0}; i <= tilts.size(); ++i) {
+        const glm::vec3 tilt = i < tilts.size() ? tilts[i] : glm::vec3{0.0f};
+        const glm::vec3 pointA = partA.supportPoint(tilt - n);
+        float depth = topB - glm::dot(pointA, n);
+        if (depth > 0.0f && extentsB.contains(pointA, t)) {
+            addPoint(manifold, pointA, depth);
+            added = true;
+        }
+        const glm::vec3 pointB = partB.supportPoint(tilt + n);
+        depth = glm::dot(pointB, n) - bottomA;
+        if (depth > 0.0f && extentsA.contains(pointB, t)) {
+            addPoint(manifold, pointB - n * depth, depth);
+            added = true;
+        }
+    }
+    if (!added) {
+        // Edge against edge, the contact point is the deepest point of a.
+        addPoint(manifold, collision.contactPoint,
+                 collision.penetrationDepth);
+    }
+}
+
+// pointA is on a and b's surface is depth further along the normal.
+void lix::ContactSolver::addPoint(Manifold &manifold, const glm::vec3 &pointA,
+                                  float depth) {
+    ContactPoint point{};
+    point.localA = toLocal(manifold.a, pointA);
+    point.localB = toLocal(manifold.b, pointA + manifold.normal * depth);
+    point.depth = depth;
+    insert(manifold, point);
+}
+
+void lix::ContactSolver::insert(Manifold &manifold, const ContactPoint &point) {
+    const float breaking2 =
+        _settings.breakingDistance * _settings.breakingDistance;
+    const glm::vec3 pointA = toWorld(manifold.a, point.localA);
+    for (uint32_t i{0}; i < manifold.count; ++i) {
+        ContactPoint &cached = manifold.points[i];
+        const glm::vec3 delta = toWorld(manifold.a, cached.localA) - pointA;
+        if (glm::dot(delta, delta) < breaking2) {
+            // Same point as last step, keep its impulses for warm starting.
+            cached.localA = point.localA;
+            cached.localB = point.localB;
+            cached.depth = point.depth;
+            return;
+        }
+    }
+    if (manifold.count < MAX_POINTS) {
+        manifold.points[manifold.count++] = point;
+        return;
+    }
+
+    // Full: keep the deepest point and the three spanning the largest area.
+    std::array<ContactPoint, MAX_POINTS + 1> candidates;
+    std::copy(manifold.points.begin(), manifold.points.end(),
+              candidates.begin());
+    candidates[MAX_POINTS] = point;
+    std::array<glm::vec3, MAX_POINTS + 1> world;
+    size_t deepest{0};
+    for (size_t i{0}; i < candidates.size(); ++i) {
+        world[i] = toWorld(manifold.a, candidates[i].localA);
+        if (candidates[i].depth > candidates[deepest].depth) {
+            deepest = i;
+        }
+    }
+    size_t dropped{deepest == 0 ? 1UL : 0UL};
+    float maxArea{-1.0f};
+    for (size_t i{0}; i < candidates.size(); ++i) {
+        if (i == deepest) {
+            continue;
+        }
+        std::array<glm::vec3, MAX_POINTS> rest;
+        for (size_t j{0}, k{0}; j < candidates.size(); ++j) {
+            if (j != i) {
+                rest[k++] = world[j];
+            }
+        }
+        float area = quadArea(rest[0], rest[1], rest[2], rest[3]);
+        if (area > maxArea) {
+            maxArea = area;
+            dropped = i;
+        }
+    }
+    for (size_t j{0}, k{0}; j < candidates.size(); ++j) {
+        if (j != dropped) {
+            manifold.points[k++] = candidates[j];
+        }
+    }
+}
+
+// Drops the cached points that separated or slid apart since the last step.
+void lix::ContactSolver::refresh(Manifold &manifold) {
+    const float breaking2 =
+        _settings.breakingDistance * _settings.breakingDistance;
+    for (uint32_t i{0}; i < manifold.count;) {
+        ContactPoint &point = manifold.points[i];
+        const glm::vec3 delta = toWorld(manifold.a, point.localA) -
+                                toWorld(manifold.b, point.localB);
+        float separation = glm::dot(delta, manifold.normal);
+        const glm::vec3 lateral = delta - manifold.normal * separation;
+        if (separation > _settings.breakingDistance ||
+            glm::dot(lateral, lateral) > breaking2) {
+            manifold.points[i] = manifold.points[--manifold.count];
+        } else {
+            point.depth = -separation;
+            ++i;
+        }
+    }
+}
+
+void lix::ContactSolver::solve(float dt) {
+    for (auto it = _manifolds.begin(); it != _manifolds.end();) {
+        if (it->second.frame != _frame) {
+            it = _manifolds.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    if (dt <= 0.0f) {
+        return;
+    }
+    for (Manifold *manifold : _active) {
+        prepare(*manifold, dt);
+    }
+    for (Manifold *manifold : _active) {
+        for (uint32_t i{0}; i < manifold->count; ++i) {
+            ContactPoint &point = manifold->points[i];
+            if (_settings.warmStarting) {
+                applyImpulse(*manifold, point,
+                             manifold->normal * point.normalImpulse +
+                                 point.tangentImpulse);
+            } else {
+                point.normalImpulse = 0.0f;
+                point.tangentImpulse = glm::vec3{0.0f};
+            }
+        }
+    }
+    for (uint32_t iteration{0}; iteration < _settings.velocityIterations;
+         ++iteration) {
+        for (Manifold *manifold : _active) {
+            solveVelocities(*manifold);
+        }
+    }
+}
+
+size_t lix::ContactSolver::numContacts() const {
+    size_t count{0};
+    for (const Manifold *manifold : _active) {
+        count += manifold->count;
+    }
+    return count;
+}
+
+void lix::ContactSolver::prepare(Manifold &manifold, float dt) {
+    std::array<lix::RigidBody *, 2> bodies{manifold.a, manifold.b};
+    std::array<glm::vec3, 2> centers;
+    for (size_t i{0}; i < bodies.size(); ++i) {
+        centers[i] = bodies[i]->shape->trs()->translation();
+        lix::DynamicBody *dynamicBody = asDynamic(bodies[i]);
+        if (dynamicBody) {
+            const glm::mat3 R =
+                glm::mat3_cast(dynamicBody->shape->trs()->rotation());
+            manifold.invMass[i] = dynamicBody->mass_inv;
+            manifold.invInertia[i] =
+                R * dynamicBody->inertiaTensor_inv * glm::transpose(R);
+        } else {
+            manifold.invMass[i] = 0.0f;
+            manifold.invInertia[i] = glm::mat3{0.0f};
+        }
+    }
+
+    const glm::vec3 &n = manifold.normal;
+    manifold.tangents = tangentBasis(n);
+    for (uint32_t i{0}; i < manifold.count; ++i) {
+        ContactPoint &point = manifold.points[i];
+        const glm::vec3 contact = (toWorld(manifold.a, point.localA) +
+                                   toWorld(manifold.b, point.localB)) *
+                                  0.5f;
+        point.rA = contact - centers[0];
+        point.rB = contact - centers[1];
+        point.normalMass = effectiveMass(manifold, point.rA, point.rB, n);
+        for (size_t k{0}; k < 2; ++k) {
+            point.tangentMass[k] = effectiveMass(manifold, point.rA, point.rB,
+                                                 manifold.tangents[k]);
+        }
+        // Friction from the last step, projected onto the new tangent plane.
+        point.tangentImpulse -= n * glm::dot(point.tangentImpulse, n);
+
+        float vn = glm::dot(
+            velocityAt(manifold.a, point.rA) - velocityAt(manifold.b, point.rB),
+            n);
+        point.velocityBias =
+            _settings.baumgarte / dt *
+            std::max(point.depth - _settings.penetrationSlop, 0.0f);
+        if (vn < -_settings.restitutionThreshold) {
+            point.velocityBias =
+                std::max(point.velocityBias, -_settings.restitution * vn);
+        }
+    }
+}
+
+// a receives impulse and b the opposite.
+void lix::ContactSolver::applyImpulse(Manifold &manifold,
+                                      const ContactPoint &point,
+                                      const glm::vec3 &impulse) {
+    if (lix::DynamicBody *a = asDynamic(manifold.a)) {
+        a->velocity += impulse * manifold.invMass[0];
+        a->angularVelocity +=
+            manifold.invInertia[0] * glm::cross(point.rA, impulse);
+    }
+    if (lix::DynamicBody *b = asDynamic(manifold.b)) {
+        b->velocity -= impulse * manifold.invMass[1];
+        b->angularVelocity -=
+            manifold.invInertia[1] * glm::cross(point.rB, impulse);
+    }
+}
+
+void lix::ContactSolver::solveVelocities(Manifold &manifold) {
+    const glm::vec3 &n = manifold.normal;
+    for (uint32_t i{0}; i < manifold.count; ++i) {
+        ContactPoint &point = manifold.points[i];
+
+        // Friction, bounded by the current normal impulse.
+        float maxFriction = _settings.friction * point.normalImpulse;
+        for (size_t k{0}; k < 2; ++k) {
+            const glm::vec3 &t = manifold.tangents[k];
+            const glm::vec3 dv = velocityAt(manifold.a, point.rA) -
+                                 velocityAt(manifold.b, point.rB);
+            float lambda = -glm::dot(dv, t) * point.tangentMass[k];
+            float accumulated = glm::dot(point.tangentImpulse, t);
+            float clamped = std::clamp(accumulated + lambda, -maxFriction,
+                                       maxFriction);
+            lambda = clamped - accumulated;
+            point.tangentImpulse += t * lambda;
+            applyImpulse(manifold, point, t * lambda);
+        }
+
+        // Non-penetration, the accumulated impulse may only push.
+        const glm::vec3 dv = velocityAt(manifold.a, point.rA) -
+                             velocityAt(manifold.b, point.rB);
+        float vn = glm::dot(dv, n);
+        float lambda = point.normalMass * (point.velocityBias - vn);
+        float accumulated = std::max(point.normalImpulse + lambda, 0.0f);
+        lambda = accumulated - point.normalImpulse;
+        point.normalImpulse = accumulated;
+        applyImpulse(manifold, point, n * lambda);
+    }
+}
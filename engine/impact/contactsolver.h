@@ -0,0 +1,104 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "collision.h"
+#include "rigidbody.h"
+#include "shapepair.h"
+
+namespace lix {
+// Sequential impulse contact solver. Contacts found by the narrow phase are
+// gathered into persistent manifolds of up to four points per body pair.
+// The impulses accumulated for a point are kept from one step to the next
+// and applied up front (warm starting), so stacks settle within a few
+// iterations.
+class ContactSolver {
+  public:
+    static constexpr size_t MAX_POINTS{4};
+    // How far support queries are tilted to find the corners of a face.
+    static constexpr float TILT{0.05f};
+
+    struct Settings {
+        uint32_t velocityIterations{8};
+        bool warmStarting{true};
+        float restitution{0.1f};
+        float friction{0.5f};
+        float baumgarte{0.2f};        // fraction of the penetration fixed/step
+        float penetrationSlop{0.01f}; // penetration left alone
+        float restitutionThreshold{1.0f}; // slower impacts don't bounce
+        float breakingDistance{0.02f};    // when a cached point is dropped
+    };
+
+    struct ContactPoint {
+        glm::vec3 localA; // contact point on a, in a's model space
+        glm::vec3 localB; // contact point on b, in b's model space
+        float depth;
+        float normalImpulse;
+        glm::vec3 tangentImpulse;
+
+        // Filled in by solve().
+        glm::vec3 rA;
+        glm::vec3 rB;
+        float normalMass;
+        std::array<float, 2> tangentMass;
+        float velocityBias;
+    };
+
+    struct Manifold {
+        lix::RigidBody *a;
+        lix::RigidBody *b;
+        glm::vec3 normal; // points from b towards a
+        std::array<glm::vec3, 2> tangents;
+        std::array<ContactPoint, MAX_POINTS> points;
+        uint32_t count;
+        uint32_t frame;
+
+        // Filled in by solve(), index 0 is a and 1 is b.
+        std::array<float, 2> invMass;
+        std::array<glm::mat3, 2> invInertia;
+    };
+
+    ContactSolver();
+
+    ContactSolver(const ContactSolver &other) = delete;
+    ContactSolver &operator=(const ContactSolver &other) = delete;
+
+    // Manifolds that don't get a contact before the next solve() are dropped.
+    void beginFrame();
+    // collision as filled in by lix::collides(a, b, &collision).
+    void addContact(lix::RigidBody &a, lix::RigidBody &b,
+                    const lix::Collision &collision);
+    // Contact between parts of the bodies' compound shapes, the manifold
+    // belongs to the parts and their support points make it up.
+    void addContact(lix::RigidBody &a, lix::RigidBody &b, lix::Shape &partA,
+                    lix::Shape &partB, const lix::Collision &collision);
+    // Solves the velocities of the bodies in this frame's manifolds. Positions
+    // are left to the caller.
+    void solve(float dt);
+
+    size_t numManifolds() const { return _active.size(); }
+
+    size_t numContacts() const;
+
+    Settings &settings() { return _settings; }
+
+    const Settings &settings() const { return _settings; }
+
+  private:
+    void refresh(Manifold &manifold);
+    void addPoint(Manifold &manifold, const glm::vec3 &pointA, float depth);
+    void insert(Manifold &manifold, const ContactPoint &point);
+    void prepare(Manifold &manifold, float dt);
+    void applyImpulse(Manifold &manifold, const ContactPoint &point,
+                      const glm::vec3 &impulse);
+    void solveVelocities(Manifold &manifold);
+
+    Settings _settings;
+    std::unordered_map<lix::ShapePair, Manifold, lix::ShapePairHash> _manifolds;
+    std::vector<Manifold *> _active;
+    uint32_t _frame{0};
+};
+} // namespace lix
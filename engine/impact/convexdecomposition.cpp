@@ -0,0 +1,477 @@
+#include "convexdecomposition.h"
+
+#include <algorithm>
+#include <array>
+#include <cfloat>
+#include <cmath>
+
+#include "aabb.h"
+#include "box.h"
+#include "polygon.h"
+#include "primer.h"
+#include "quickhull.h"
+
+namespace {
+// Akenine-Möller's test of triangle v against the cube of half size half
+// around the origin.
+bool triangleOverlapsCube(const std::array<glm::vec3, 3> &v, float half) {
+    const std::array<glm::vec3, 3> edges{v[1] - v[0], v[2] - v[1],
+                                         v[0] - v[2]};
+    auto separates = [&](const glm::vec3 &axis) {
+        const float p0 = glm::dot(axis, v[0]);
+        const float p1 = glm::dot(axis, v[1]);
+        const float p2 = glm::dot(axis, v[2]);
+        const float r =
+            half * (std::fabs(axis.x) + std::fabs(axis.y) + std::fabs(axis.z));
+        return std::min({p0, p1, p2}) > r || std::max({p0, p1, p2}) < -r;
+    };
+    for (int k = 0; k < 3; ++k) {
+        glm::vec3 unit{0.0f};
+        unit[k] = 1.0f;
+        if (separates(unit)) {
+            return false;
+        }
+        for (const glm::vec3 &edge : edges) {
+            if (separates(glm::cross(unit, edge))) {
+                return false;
+            }
+        }
+    }
+    return !separates(glm::cross(edges[0], edges[1]));
+}
+
+// Voxel coordinates, hi is exclusive.
+struct Region {
+    glm::ivec3 lo;
+    glm::ivec3 hi;
+
+    bool empty() const { return lo.x >= hi.x || lo.y >= hi.y || lo.z >= hi.z; }
+};
+
+// The mesh voxelized solid: voxels the surface passes through, and those it
+// closes off from the outside. Two layers of padding, since the surface
+// marks the voxels on both sides of a face it runs along, let the outside be
+// flood filled from a corner.
+class Voxels {
+  public:
+    Voxels(const std::vector<glm::vec3> &vertices,
+           const std::vector<uint32_t> &indices, uint32_t resolution) {
+        auto [min, max] = lix::extremePoints(vertices);
+        const glm::vec3 extent = max - min;
+        _size = std::max(std::max(extent.x, extent.y), extent.z) /
+                static_cast<float>(std::max(resolution, 1U));
+        if (_size <= 0.0f) {
+            _size = 1.0f;
+        }
+        _origin = min - glm::vec3{_size * 2.0f};
+        for (int k = 0; k < 3; ++k) {
+            _dims[k] = static_cast<int>(std::ceil(extent[k] / _size)) + 4;
+        }
+        std::vector<uint8_t> state(volume(), EMPTY);
+        for (size_t i{0}; i + 2 < indices.size(); i += 3) {
+            markSurface({vertices[indices[i]], vertices[indices[i + 1]],
+                         vertices[indices[i + 2]]},
+                        state);
+        }
+        floodOutside(state);
+
+        // Summed volume table, counts solid voxels in any region in O(1).
+        _sums.assign(static_cast<size_t>(_dims.x + 1) * (_dims.y + 1) *
+                         (_dims.z + 1),
+                     0);
+        for (int z = 0; z < _dims.z; ++z) {
+            for (int y = 0; y < _dims.y; ++y) {
+                for (int x = 0; x < _dims.x; ++x) {
+                    const uint32_t solid = state[index(x, y, z)] != OUTSIDE;
+                    sum(x + 1, y + 1, z + 1) =
+                        solid + sum(x, y + 1, z + 1) + sum(x + 1, y, z + 1) +
+                        sum(x + 1, y + 1, z) - sum(x, y, z + 1) -
+                        sum(x, y + 1, z) - sum(x + 1, y, z) + sum(x, y, z);
+                }
+            }
+        }
+        _solid.resize(state.size());
+        std::transform(state.begin(), state.end(), _solid.begin(),
+                       [](uint8_t s) { return s != OUTSIDE; });
+    }
+
+    const glm::ivec3 &dims() const { return _dims; }
+
+    Region all() const { return {glm::ivec3{0, 0, 0}, _dims}; }
+
+    bool solid(int x, int y, int z) const {
+        return x >= 0 && y >= 0 && z >= 0 && x < _dims.x && y < _dims.y &&
+               z < _dims.z && _solid[index(x, y, z)];
+    }
+
+    // Voxels outside the grid count as empty.
+    uint32_t count(Region r) const {
+        r.lo = glm::max(r.lo, glm::ivec3{0, 0, 0});
+        r.hi = glm::min(r.hi, _dims);
+        if (r.empty()) {
+            return 0;
+        }
+        return sum(r.hi.x, r.hi.y, r.hi.z) - sum(r.lo.x, r.hi.y, r.hi.z) -
+               sum(r.hi.x, r.lo.y, r.hi.z) - sum(r.hi.x, r.hi.y, r.lo.z) +
+               sum(r.lo.x, r.lo.y, r.hi.z) + sum(r.lo.x, r.hi.y, r.lo.z) +
+               sum(r.hi.x, r.lo.y, r.lo.z) - sum(r.lo.x, r.lo.y, r.lo.z);
+    }
+
+    glm::vec3 world(int x, int y, int z) const {
+        return _origin + glm::vec3{static_cast<float>(x),
+                                   static_cast<float>(y),
+                                   static_cast<float>(z)} *
+                             _size;
+    }
+
+  private:
+    static constexpr uint8_t EMPTY{0};
+    static constexpr uint8_t SURFACE{1};
+    static constexpr uint8_t OUTSIDE{2};
+
+    size_t volume() const {
+        return static_cast<size_t>(_dims.x) * _dims.y * _dims.z;
+    }
+
+    size_t index(int x, int y, int z) const {
+        return static_cast<size_t>(x) +
+               static_cast<size_t>(_dims.x) *
+                   (static_cast<size_t>(y) + static_cast<size_t>(_dims.y) * z);
+    }
+
+    uint32_t &sum(int x, int y, int z) {
+        return _sums[static_cast<size_t>(x) +
+                     static_cast<size_t>(_dims.x + 1) *
+                         (y + static_cast<size_t>(_dims.y + 1) * z)];
+    }
+
+    uint32_t sum(int x, int y, int z) const {
+        return _sums[static_cast<size_t>(x) +
+                     static_cast<size_t>(_dims.x + 1) *
+                         (y + static_cast<size_t>(_dims.y + 1) * z)];
+    }
+
+    void markSurface(const std::array<glm::vec3, 3> &triangle,
+                     std::vector<uint8_t> &state) {
+        glm::ivec3 lo;
+        glm::ivec3 hi;
+        for (int k = 0; k < 3; ++k) {
+            const float min =
+                std::min({triangle[0][k], triangle[1][k], triangle[2][k]});
+            const float max =
+                std::max({triangle[0][k], triangle[1][k], triangle[2][k]});
+            lo[k] = std::max(
+                0, static_cast<int>((min - _origin[k]) / _size) - 1);
+            hi[k] = std::min(
+                _dims[k] - 1,
+                static_cast<int>((max - _origin[k]) / _size) + 1);
+        }
+        // A hair larger than the voxel so the surface stays closed where it
+        // runs along a voxel face.
+        const float half = _size * 0.5f * 1.001f;
+        for (int z = lo.z; z <= hi.z; ++z) {
+            for (int y = lo.y; y <= hi.y; ++y) {
+                for (int x = lo.x; x <= hi.x; ++x) {
+                    const glm::vec3 center =
+                        world(x, y, z) + glm::vec3{_size * 0.5f};
+                    if (triangleOverlapsCube({triangle[0] - center,
+                                              triangle[1] - center,
+                                              triangle[2] - center},
+                                             half)) {
+                        state[index(x, y, z)] = SURFACE;
+                    }
+                }
+            }
+        }
+    }
+
+    void floodOutside(std::vector<uint8_t> &state) {
+        std::vector<glm::ivec3> stack{glm::ivec3{0, 0, 0}};
+        state[0] = OUTSIDE;
+        const glm::ivec3 steps[]{{1, 0, 0},  {-1, 0, 0}, {0, 1, 0},
+                                 {0, -1, 0}, {0, 0, 1},  {0, 0, -1}};
+        while (!stack.empty()) {
+            const glm::ivec3 v = stack.back();
+            stack.pop_back();
+            for (const glm::ivec3 &step : steps) {
+                const glm::ivec3 n{v.x + step.x, v.y + step.y, v.z + step.z};
+                if (n.x < 0 || n.y < 0 || n.z < 0 || n.x >= _dims.x ||
+                    n.y >= _dims.y || n.z >= _dims.z) {
+                    continue;
+                }
+                uint8_t &s = state[index(n.x, n.y, n.z)];
+                if (s == EMPTY) {
+                    s = OUTSIDE;
+                    stack.push_back(n);
+                }
+            }
+        }
+    }
+
+    glm::vec3 _origin;
+    float _size;
+    glm::ivec3 _dims;
+    std::vector<uint8_t> _solid;
+    std::vector<uint32_t> _sums;
+};
+
+class Decomposition {
+  public:
+    Decomposition(const Voxels &voxels) : _voxels{voxels} {}
+
+    // Smallest region around the solid voxels of r.
+    Region tight(const Region &r) const {
+        Region t{r.hi, r.lo};
+        for (int z = r.lo.z; z < r.hi.z; ++z) {
+            for (int y = r.lo.y; y < r.hi.y; ++y) {
+                for (int x = r.lo.x; x < r.hi.x; ++x) {
+                    if (_voxels.solid(x, y, z)) {
+                        t.lo = glm::min(t.lo, glm::ivec3{x, y, z});
+                        t.hi = glm::max(t.hi, glm::ivec3{x + 1, y + 1, z + 1});
+                    }
+                }
+            }
+        }
+        return t;
+    }
+
+    // Volume of the hull of the voxels beyond the voxels themselves, in
+    // voxels. The first and last voxel of each row span the same hull as the
+    // whole row.
+    float concavity(const Region &r) {
+        _points.clear();
+        for (int z = r.lo.z; z < r.hi.z; ++z) {
+            for (int y = r.lo.y; y < r.hi.y; ++y) {
+                int first{r.hi.x};
+                int last{r.lo.x - 1};
+                for (int x = r.lo.x; x < r.hi.x; ++x) {
+                    if (_voxels.solid(x, y, z)) {
+                        first = std::min(first, x);
+                        last = x;
+                    }
+                }
+                if (first > last) {
+                    continue;
+                }
+                for (int corner = 0; corner < 4; ++corner) {
+                    const float cy = static_cast<float>(y + (corner & 1));
+                    const float cz = static_cast<float>(z + (corner >> 1));
+                    _points.push_back({static_cast<float>(first), cy, cz});
+                    _points.push_back({static_cast<float>(last + 1), cy, cz});
+                }
+            }
+        }
+        if (!_hull.build(_points)) {
+            return 0.0f;
+        }
+        float volume{0.0f};
+        const auto &v = _hull.vertices();
+        const auto &i = _hull.indices();
+        for (size_t k{0}; k < i.size(); k += 3) {
+            volume += glm::dot(v[i[k]], glm::cross(v[i[k + 1]], v[i[k + 2]]));
+        }
+        return std::max(0.0f, volume / 6.0f -
+                                  static_cast<float>(_voxels.count(r)));
+    }
+
+    // The cut of r with the least concavity left in its halves. Evenly
+    // spaced planes first, then every plane around the best of them. False
+    // when r is a single voxel thick along every axis.
+    bool split(const Region &r, uint32_t planesPerAxis, Region &left,
+               Region &right) {
+        const Region t = tight(r);
+        float best{FLT_MAX};
+        int bestAxis{0};
+        int bestCut{0};
+        int step{1};
+        auto tryCut = [&](int k, int cut) {
+            Region l{r};
+            Region h{r};
+            l.hi[k] = cut;
+            h.lo[k] = cut;
+            // Between cuts as good, prefer the narrowest, which keeps a ring
+            // from being sliced into layers.
+            Region layer{h};
+            layer.hi[k] = cut + 1;
+            const float cost = concavity(l) + concavity(h) +
+                               AREA * static_cast<float>(_voxels.count(layer));
+            if (cost < best) {
+                best = cost;
+                bestAxis = k;
+                bestCut = cut;
+                left = l;
+                right = h;
+            }
+        };
+        for (int k = 0; k < 3; ++k) {
+            const int span = t.hi[k] - t.lo[k];
+            const int planes =
+                std::min(span - 1, static_cast<int>(planesPerAxis));
+            const float before{best};
+            for (int p = 1; p <= planes; ++p) {
+                tryCut(k, t.lo[k] + span * p / (planes + 1));
+            }
+            if (best < before) {
+                step = span / (planes + 1) + 1;
+            }
+        }
+        if (best == FLT_MAX) {
+            return false;
+        }
+        const int k{bestAxis};
+        const int coarse{bestCut};
+        for (int cut = std::max(t.lo[k] + 1, coarse - step + 1);
+             cut < std::min(t.hi[k], coarse + step); ++cut) {
+            if (cut != coarse) {
+                tryCut(k, cut);
+            }
+        }
+        return true;
+    }
+
+  private:
+    static constexpr float AREA{0.1f};
+
+    const Voxels &_voxels;
+    lix::QuickHull _hull;
+    std::vector<glm::vec3> _points;
+};
+
+// Sutherland-Hodgman of the triangle against the box, the clipped corners go
+// to points.
+void clipTriangle(const std::array<glm::vec3, 3> &triangle,
+                  const glm::vec3 &min, const glm::vec3 &max,
+                  std::vector<glm::vec3> &points) {
+    std::array<glm::vec3, 12> polygon;
+    std::array<glm::vec3, 12> clipped;
+    std::copy(triangle.begin(), triangle.end(), polygon.begin());
+    size_t count{3};
+    for (int plane = 0; plane < 6 && count > 0; ++plane) {
+        const int k = plane / 2;
+        const bool upper = plane % 2 == 1;
+        // Positive inside the box.
+        auto inside = [&](const glm::vec3 &p) {
+            return upper ? max[k] - p[k] : p[k] - min[k];
+        };
+        size_t kept{0};
+        for (size_t i{0}; i < count; ++i) {
+            const glm::vec3 &a = polygon[i];
+            const glm::vec3 &b = polygon[(i + 1) % count];
+            const float da = inside(a);
+            const float db = inside(b);
+            if (da >= 0.0f) {
+                clipped[kept++] = a;
+            }
+            if ((da >= 0.0f) != (db >= 0.0f)) {
+                clipped[kept++] = a + (b - a) * (da / (da - db));
+            }
+        }
+        std::copy(clipped.begin(), clipped.begin() + kept, polygon.begin());
+        count = kept;
+    }
+    points.insert(points.end(), polygon.begin(), polygon.begin() + count);
+}
+} // namespace
+
+std::vector<std::vector<glm::vec3>>
+lix::convexDecomposition(const std::vector<glm::vec3> &vertices,
+                         const std::vector<uint32_t> &indices,
+                         const lix::DecompositionSettings &settings) {
+    std::vector<std::vector<glm::vec3>> hulls;
+    if (vertices.empty() || indices.size() < 3) {
+        return hulls;
+    }
+    const Voxels voxels{vertices, indices, settings.resolution};
+    Decomposition decomposition{voxels};
+    const float accepted =
+        settings.concavity * static_cast<float>(voxels.count(voxels.all()));
+
+    // Split the most concave part until they are all convex enough.
+    struct Part {
+        Region region;
+        float concavity;
+    };
+    std::vector<Part> parts{
+        {voxels.all(), decomposition.concavity(voxels.all())}};
+    while (parts.size() < settings.maxHulls) {
+        auto worst = std::max_element(
+            parts.begin(), parts.end(), [](const Part &a, const Part &b) {
+                return a.concavity < b.concavity;
+            });
+        if (worst->concavity <= accepted) {
+            break;
+        }
+        Region left;
+        Region right;
+        if (!decomposition.split(worst->region, settings.planesPerAxis, left,
+                                 right)) {
+            worst->concavity = 0.0f;
+            continue;
+        }
+        *worst = {left, decomposition.concavity(left)};
+        parts.push_back({right, decomposition.concavity(right)});
+    }
+
+    // Each hull from the mesh clipped to its part, plus the part's box
+    // corners that are buried in the solid.
+    lix::QuickHull quickHull;
+    std::vector<glm::vec3> points;
+    for (const Part &part : parts) {
+        const Region &r = part.region;
+        if (voxels.count(r) == 0) {
+            continue;
+        }
+        const glm::vec3 min = voxels.world(r.lo.x, r.lo.y, r.lo.z);
+        const glm::vec3 max = voxels.world(r.hi.x, r.hi.y, r.hi.z);
+        points.clear();
+        for (size_t i{0}; i + 2 < indices.size(); i += 3) {
+            clipTriangle({vertices[indices[i]], vertices[indices[i + 1]],
+                          vertices[indices[i + 2]]},
+                         min, max, points);
+        }
+        for (int corner = 0; corner < 8; ++corner) {
+            const glm::ivec3 c{corner & 1 ? r.hi.x : r.lo.x,
+                               corner & 2 ? r.hi.y : r.lo.y,
+                               corner & 4 ? r.hi.z : r.lo.z};
+            if (voxels.count({glm::ivec3{c.x - 1, c.y - 1, c.z - 1},
+                              glm::ivec3{c.x + 1, c.y + 1, c.z + 1}}) == 8) {
+                points.push_back(voxels.world(c.x, c.y, c.z));
+            }
+        }
+        if (points.empty()) {
+            continue;
+        }
+        if (quickHull.build(points)) {
+            hulls.push_back(quickHull.vertices());
+        } else {
+            // Flat, a polygon still has support points.
+            std::vector<uint32_t> remap;
+            hulls.push_back(lix::weldVertices(points, remap));
+        }
+    }
+    return hulls;
+}
+
+std::shared_ptr<lix::Polygon>
+lix::compoundShape(lix::TRS *trs,
+                   const std::vector<std::vector<glm::vec3>> &hulls) {
+    if (hulls.empty()) {
+        return nullptr;
+    }
+    auto shape = std::make_shared<lix::Polygon>(trs, hulls.front());
+    glm::vec3 min{FLT_MAX};
+    glm::vec3 max{-FLT_MAX};
+    for (size_t i{0}; i < hulls.size(); ++i) {
+        auto [hullMin, hullMax] = lix::extremePoints(hulls[i]);
+        min = glm::min(min, hullMin);
+        max = glm::max(max, hullMax);
+        if (i > 0) {
+            auto part = std::make_shared<lix::Polygon>(trs, hulls[i]);
+            part->setSimplified(std::make_shared<lix::AABB>(trs, part.get()));
+            shape->addPositive(part);
+        }
+    }
+    shape->setSimplified(std::make_shared<lix::Box>(trs, (max - min) * 0.5f,
+                                                    (max + min) * 0.5f));
+    return shape;
+}
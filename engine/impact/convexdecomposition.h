@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "glm/glm.hpp"
+#include "gltrs.h"
+
+namespace lix {
+class Polygon;
+
+struct DecompositionSettings {
+    uint32_t resolution{32}; // voxels along the longest side of the mesh
+    // Hull volume a part may have beyond its own, as a fraction of the volume
+    // of the whole mesh, before it is split.
+    float concavity{0.02f};
+    uint32_t maxHulls{16};
+    uint32_t planesPerAxis{8}; // split planes tried along each axis
+};
+
+// Approximate convex decomposition of a closed triangle mesh, V-HACD style:
+// the mesh is voxelized solid and cut by axis aligned planes, each time
+// where the two halves' hulls waste the least volume, until every part is
+// nearly convex. Each part's hull is built from the mesh clipped to the part,
+// not from voxels, so it follows the surface exactly. Returns the hull points
+// of each part.
+std::vector<std::vector<glm::vec3>>
+convexDecomposition(const std::vector<glm::vec3> &vertices,
+                    const std::vector<uint32_t> &indices,
+                    const DecompositionSettings &settings = {});
+
+// One collider out of hulls: the first hull with the others attached through
+// Shape::addPositive, and a box around all of them as the simplified shape for
+// the broad phase. The attached hulls get fitted AABBs of their own, so the
+// narrow phase can skip the parts that are far apart. hulls must outlive the
+// shape. Null without hulls.
+std::shared_ptr<lix::Polygon>
+compoundShape(lix::TRS *trs, const std::vector<std::vector<glm::vec3>> &hulls);
+} // namespace lix
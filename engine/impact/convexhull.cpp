@@ -2,13 +2,17 @@
 
 #include <algorithm>
 #include <list>
+#include <map>
 #include <set>
+#include <stdexcept>
+#include <unordered_map>
 
 #include "glm/gtc/random.hpp"
 #define GLM_ENABLE_EXPERIMENTAL
 #include "glm/gtx/string_cast.hpp"
 
 #include "primer.h"
+#include "quickhull.h"
 
 #define print_vec(v) printf("%s: [%.2f %.2f %.2f]\n", #v, v.x, v.y, v.z)
 
@@ -70,85 +74,62 @@ lix::ConvexHull::ConvexHull(const std::vector<glm::vec3>& points)
 }*/
 
 lix::ConvexHull::ConvexHull(const std::vector<glm::vec3> &points) {
-    std::vector<glm::vec3> P{points.begin(), points.end()};
-    glm::vec3 dir = glm::vec3{1.0f, 0.0f, 0.0f}; // glm::ballRand(1.0f);
-    glm::vec3 A;
-    glm::vec3 B;
-
-    assert(popAlongDirection(P, dir, A));
-    assert(popAlongDirection(P, -A, B));
-
-    glm::vec3 AB = B - A;
-    float t = -(glm::dot(AB, A) / glm::dot(AB, AB));
-    glm::vec3 r = A + AB * t;
-
-    assert(glm::dot(r, r) >= 0);
-
-    glm::vec3 C;
-    assert(popAlongDirection(P, r, C));
-
-    glm::vec3 AC = C - A;
-    glm::vec3 ABC = glm::cross(AB, AC);
-
-    if (glm::dot(ABC, -A) > 0) {
-        std::swap(B, C);
-        std::swap(AC, AB);
-        ABC = -ABC;
+    if (!build(points)) {
+        throw std::runtime_error("convex hull of points spanning no volume");
     }
-
-    glm::vec3 D;
-    assert(popAlongDirection(P, -ABC, D));
-
-    assert(!lix::isSameVertex(A, D) && !lix::isSameVertex(B, D) &&
-           !lix::isSameVertex(C, D));
-
-    auto &abc = _faces.emplace_back(glm::normalize(ABC));
-    auto &acd = _faces.emplace_back(glm::normalize(glm::cross(C - A, D - A)));
-    auto &adb = _faces.emplace_back(glm::normalize(glm::cross(D - A, B - A)));
-    auto &bdc = _faces.emplace_back(glm::normalize(glm::cross(D - B, C - B)));
-
-    auto ab = new Half_Edge(A, &abc);
-    auto bc = new Half_Edge(B, &abc);
-    auto ca = new Half_Edge(C, &abc);
-
-    auto ac = new Half_Edge(A, &acd);
-    auto cd = new Half_Edge(C, &acd);
-    auto da = new Half_Edge(D, &acd);
-
-    auto ad = new Half_Edge(A, &adb);
-    auto db = new Half_Edge(D, &adb);
-    auto ba = new Half_Edge(B, &adb);
-
-    auto bd = new Half_Edge(B, &bdc);
-    auto dc = new Half_Edge(D, &bdc);
-    auto cb = new Half_Edge(C, &bdc);
-
-    connect(ab, bc, ba, &abc);
-    connect(bc, ca, cb, &abc);
-    connect(ca, ab, ac, &abc);
-
-    connect(ac, cd, ca, &acd);
-    connect(cd, da, dc, &acd);
-    connect(da, ac, ad, &acd);
-
-    connect(ad, db, da, &adb);
-    connect(db, ba, bd, &adb);
-    connect(ba, ad, ab, &adb);
-
-    connect(bd, dc, db, &bdc);
-    connect(dc, cb, cd, &bdc);
-    connect(cb, bd, bc, &bdc);
-
-    addPoints(P);
 }
 
-lix::ConvexHull::~ConvexHull() noexcept {
-    for (auto &face : _faces) {
-        face.unlink();
-    }
+bool lix::ConvexHull::build(const std::vector<glm::vec3> &points) {
+    // Keeps the pool, every half edge is free again.
     _faces.clear();
+    _freeHalfEdges.clear();
+    for (auto it = _halfEdges.rbegin(); it != _halfEdges.rend(); ++it) {
+        _freeHalfEdges.push_back(&*it);
+    }
+    thread_local lix::QuickHull quickHull;
+    if (!quickHull.build(points)) {
+        return false;
+    }
+    const std::vector<glm::vec3> &vertices = quickHull.vertices();
+    const std::vector<uint32_t> &indices = quickHull.indices();
+    // Half edges by their end points, to pair each with its opposite.
+    std::unordered_map<uint64_t, Half_Edge *> edges;
+    edges.reserve(indices.size());
+    auto key = [](uint32_t from, uint32_t to) {
+        return static_cast<uint64_t>(from) << 32 | to;
+    };
+    for (size_t i{0}; i < indices.size(); i += 3) {
+        const glm::vec3 &A = vertices[indices[i]];
+        const glm::vec3 &B = vertices[indices[i + 1]];
+        const glm::vec3 &C = vertices[indices[i + 2]];
+        const glm::vec3 n = glm::cross(B - A, C - A);
+        const float length = glm::length(n);
+        const glm::vec3 normal =
+            length > FLT_MIN ? n / length : glm::vec3{0.0f, 1.0f, 0.0f};
+        auto &face = _faces.emplace_back(normal);
+        Half_Edge *he[3];
+        for (size_t k{0}; k < 3; ++k) {
+            he[k] = newHalfEdge(vertices[indices[i + k]], &face);
+        }
+        for (size_t k{0}; k < 3; ++k) {
+            connect(he[k], he[(k + 1) % 3], nullptr, &face);
+            const uint32_t from = indices[i + k];
+            const uint32_t to = indices[i + (k + 1) % 3];
+            edges.emplace(key(from, to), he[k]);
+            auto opposite = edges.find(key(to, from));
+            if (opposite != edges.end()) {
+                he[k]->opposite = opposite->second;
+                opposite->second->opposite = he[k];
+            }
+        }
+        face.half_edge = he[0];
+        face.D = glm::dot(-A, normal);
+    }
+    return true;
 }
 
+lix::ConvexHull::~ConvexHull() noexcept {}
+
 bool lix::ConvexHull::addPoint(const glm::vec3 &p, lix::Face *face,
                                std::list<Face *> *Q) {
     if (face == nullptr) {
@@ -174,7 +155,7 @@ bool lix::ConvexHull::addPoint(const glm::vec3 &p, lix::Face *face,
     while (fIt != visible.end()) {
         Face *f = *fIt;
 
-        f->unlink();
+        release(*f);
 
         if (Q)
             Q->remove(f);
@@ -216,9 +197,9 @@ bool lix::ConvexHull::addPoint(const glm::vec3 &p, lix::Face *face,
 
             auto &uvw = _faces.emplace_back(glm::normalize(UVW_norm));
 
-            auto uv = new Half_Edge(U, &uvw);
-            auto vw = new Half_Edge(V, &uvw);
-            auto wu = new Half_Edge(W, &uvw);
+            auto uv = newHalfEdge(U, &uvw);
+            auto vw = newHalfEdge(V, &uvw);
+            auto wu = newHalfEdge(W, &uvw);
 
             // printf("prev link: <%d> : f%d\n", prev->id, prev->face->id);
             connect(uv, vw, prev, &uvw);
@@ -327,6 +308,38 @@ std::vector<glm::vec3> lix::ConvexHull::uniquePoints() const {
     return {rval.begin(), rval.end()};
 }
 
+lix::VertexGraph lix::ConvexHull::vertexGraph() const {
+    lix::VertexGraph graph;
+    std::map<glm::vec3, uint32_t, Vec3Comparator> indices;
+    auto indexOf = [&](const glm::vec3 &v) {
+        auto [it, inserted] = indices.emplace(v, graph.points.size());
+        if (inserted) {
+            graph.points.push_back(v);
+        }
+        return it->second;
+    };
+    // Every edge has a half edge leaving from each end.
+    std::vector<std::vector<uint32_t>> adjacent;
+    for (const auto &face : _faces) {
+        const Half_Edge *he = face.half_edge;
+        do {
+            const uint32_t from = indexOf(he->vertex);
+            const uint32_t to = indexOf(he->next->vertex);
+            adjacent.resize(graph.points.size());
+            adjacent[from].push_back(to);
+            he = he->next;
+        } while (he != face.half_edge);
+    }
+    graph.offsets.reserve(adjacent.size() + 1);
+    graph.offsets.push_back(0);
+    for (const auto &list : adjacent) {
+        graph.neighbours.insert(graph.neighbours.end(), list.begin(),
+                                list.end());
+        graph.offsets.push_back(static_cast<uint32_t>(graph.neighbours.size()));
+    }
+    return graph;
+}
+
 void lix::ConvexHull::connect(Half_Edge *self, Half_Edge *next,
                               Half_Edge *opposite, Face *face) {
     self->next = next;
@@ -337,6 +350,26 @@ void lix::ConvexHull::connect(Half_Edge *self, Half_Edge *next,
     face->D = glm::dot(-face->half_edge->vertex, face->normal);
 }
 
+lix::Half_Edge *lix::ConvexHull::newHalfEdge(const glm::vec3 &vertex,
+                                             Face *face) {
+    if (_freeHalfEdges.empty()) {
+        return &_halfEdges.emplace_back(vertex, face);
+    }
+    Half_Edge *he = _freeHalfEdges.back();
+    _freeHalfEdges.pop_back();
+    *he = Half_Edge{vertex, face};
+    return he;
+}
+
+void lix::ConvexHull::release(Face &face) {
+    Half_Edge *he = face.half_edge;
+    do {
+        _freeHalfEdges.push_back(he);
+        he = he->next;
+    } while (he != face.half_edge);
+    face.unlink();
+}
+
 std::optional<glm::vec3>
 lix::ConvexHull::rayIntersect(const glm::vec3 &ray_origin,
                               const glm::vec3 &ray_dir) const {
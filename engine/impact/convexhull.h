@@ -1,20 +1,31 @@
 #pragma once
 
+#include <deque>
 #include <list>
 #include <optional>
 #include <vector>
 
 #include "halfedge.h"
+#include "vertexgraph.h"
 
 #include "glm/glm.hpp"
 
 namespace lix {
 class ConvexHull {
   public:
+    ConvexHull() = default;
     // ConvexHull(const std::vector<lix::Vertex>& points);
+    // Throws std::runtime_error if the points span no volume.
     ConvexHull(const std::vector<glm::vec3> &points);
     ~ConvexHull() noexcept;
 
+    ConvexHull(const ConvexHull &other) = delete;
+    ConvexHull &operator=(const ConvexHull &other) = delete;
+
+    // Replaces the hull with the one of points. False, and an empty hull, if
+    // they span no volume.
+    bool build(const std::vector<glm::vec3> &points);
+
     bool addPoint(const glm::vec3 &p, lix::Face *face = nullptr,
                   std::list<Face *> *Q = nullptr);
     void addPoints(std::vector<glm::vec3> &P);
@@ -24,6 +35,8 @@ class ConvexHull {
 
     std::vector<glm::vec3> points() const;
     std::vector<glm::vec3> uniquePoints() const;
+    // The hull vertices with their edges, for hill climbing support points.
+    lix::VertexGraph vertexGraph() const;
 
     std::list<Face>::iterator begin() { return _faces.begin(); }
 
@@ -39,7 +52,15 @@ class ConvexHull {
   private:
     void connect(Half_Edge *self, Half_Edge *next, Half_Edge *opposite,
                  Face *face);
+    Half_Edge *newHalfEdge(const glm::vec3 &vertex, Face *face);
+    // Unlinks the face and puts its half edges back in the pool.
+    void release(Face &face);
 
+    // Every half edge of the hull lives here, a deque so they keep their
+    // addresses as it grows. Released ones, and all of them on a new build,
+    // are reused before it grows.
+    std::deque<Half_Edge> _halfEdges;
+    std::vector<Half_Edge *> _freeHalfEdges;
     std::list<Face> _faces;
 };
 } // namespace lix
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <cstdint>
 #include <memory>
 
@@ -9,8 +10,8 @@ namespace lix {
 struct Half_Edge {
     Half_Edge(const glm::vec3 &vertex_, struct Face *face_)
         : vertex{vertex_}, face{face_} {
-        static uint32_t nextId{0};
-        id = nextId++;
+        static std::atomic<uint32_t> nextId{0};
+        id = nextId.fetch_add(1, std::memory_order_relaxed);
     }
 
     uint32_t id;
@@ -25,16 +26,16 @@ struct Face {
     Face(const glm::vec3 &normal_) : normal{normal_} {
         assert(!std::isnan(normal.x));
         assert(glm::dot(normal, normal) > FLT_EPSILON);
-        static uint32_t nextId{0};
-        id = nextId++;
+        static std::atomic<uint32_t> nextId{0};
+        id = nextId.fetch_add(1, std::memory_order_relaxed);
     }
 
+    // Detaches the half edges from each other and their neighbours. They are
+    // owned by the hull's pool.
     void unlink() {
         Half_Edge *he = this->half_edge;
         do {
             Half_Edge *next = he->next;
-            // printf("delete edge: <%d> opposite=%d\n", he->id, he->opposite ?
-            // he->opposite->face->id : - 1);
             if (he->opposite) {
                 he->opposite->opposite = nullptr;
                 he->opposite = nullptr;
@@ -42,7 +43,6 @@ struct Face {
             he->prev = nullptr;
             he->next = nullptr;
             he->face = nullptr;
-            delete (he);
             he = next;
         } while (he != this->half_edge);
         this->half_edge = nullptr;
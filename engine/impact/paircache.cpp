@@ -0,0 +1,19 @@
+#include "paircache.h"
+
+glm::vec3 &lix::PairCache::axis(const lix::ShapePair &pair, bool &cached) {
+    auto [it, inserted] = _entries.try_emplace(pair);
+    cached = !inserted;
+    it->second.frame = _frame;
+    return it->second.axis;
+}
+
+void lix::PairCache::prune() {
+    for (auto it = _entries.begin(); it != _entries.end();) {
+        if (it->second.frame != _frame) {
+            it = _entries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    ++_frame;
+}
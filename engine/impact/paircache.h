@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+
+#include "glm/glm.hpp"
+#include "shapepair.h"
+
+namespace lix {
+// The last GJK search direction of each shape pair. Pairs barely move from
+// one step to the next, so the direction that separated them (or the EPA
+// normal that pushed them apart) is where the next query should start.
+class PairCache {
+  public:
+    // The axis stored for pair, cached is false when the pair is new and the
+    // axis is left for the caller to set. The reference stays valid until
+    // the next prune.
+    glm::vec3 &axis(const lix::ShapePair &pair, bool &cached);
+    // Drops the pairs not looked up since the last prune.
+    void prune();
+
+    size_t size() const { return _entries.size(); }
+
+  private:
+    struct Entry {
+        glm::vec3 axis;
+        uint32_t frame;
+    };
+
+    std::unordered_map<lix::ShapePair, Entry, lix::ShapePairHash> _entries;
+    uint32_t _frame{0};
+};
+} // namespace lix
@@ -1,31 +1,16 @@
 #include "physicsengine.h"
 
+#include <algorithm>
+#include <cfloat>
+
 #include "collision.h"
-#include "gltimer.h"
+#include "collisionquery.h"
 #include "inertia.h"
+#include "primer.h"
+#include "primitivecollision.h"
+#include "timeofimpact.h"
+#include <chrono>
 #include <glm/gtc/quaternion.hpp>
-#include <glm/gtc/random.hpp>
-
-inline static float impulse(lix::DynamicBody &dynamicBody,
-                            const lix::Collision &collision,
-                            float restitution) {
-    const glm::vec3 r =
-        collision.contactPoint - dynamicBody.shape->trs()->translation();
-    const glm::vec3 vrel =
-        dynamicBody.velocity + glm::cross(dynamicBody.angularVelocity, r);
-
-    float vrel_n = glm::dot(vrel, collision.normal);
-
-    glm::vec3 r_cross_n = glm::cross(r, collision.normal);
-    float denominator =
-        dynamicBody.mass_inv +
-        glm::dot(collision.normal,
-                 glm::cross(dynamicBody.inertiaTensor_inv * r_cross_n, r));
-
-    float J = -(1.0f + restitution) * vrel_n / denominator;
-
-    return J;
-}
 
 inline static void applyForces(lix::DynamicBody &dynamicBody, float dt) {
     // gravity
@@ -52,120 +37,408 @@ inline static void forwardBody(lix::DynamicBody &rigidBody, float dt) {
     // rigidBody.angularVelocity * dt), 0.5f));
 }
 
-inline static void backwardBody(lix::DynamicBody &rigidBody, float dt) {
-    rigidBody.shape->trs()->applyTranslation(-rigidBody.velocity * dt);
+// Moves a continuous body to its first contact with a static body in this
+// step and drops the velocity into it, forwardBody then only adds the rest of
+// the motion along the surface. Returns true on impact.
+static bool sweepBody(lix::DynamicBody &body,
+                      std::vector<lix::StaticBody> &staticBodies,
+                      const lix::BroadPhase &broadPhase, float dt) {
+    thread_local lix::CollisionQuery query;
+    const glm::vec3 motion = body.velocity * dt;
+    const lix::Bounds bounds = body.shape->bounds();
+    const lix::Bounds swept =
+        bounds.merged({bounds.min + motion, bounds.max + motion});
+    const float angularSpeed = glm::length(body.angularVelocity);
+
+    std::optional<lix::TimeOfImpact> first;
+    broadPhase.query(swept, [&](uint32_t index, bool dynamic) {
+        if (dynamic) {
+            return;
+        }
+        auto impact =
+            lix::timeOfImpact(*body.shape, body.velocity, angularSpeed,
+                              *staticBodies[index].shape, dt, query);
+        if (impact && (!first || impact->time < first->time)) {
+            first = impact;
+        }
+    });
+    if (!first) {
+        return false;
+    }
+    const float approach = glm::dot(body.velocity, first->normal);
+    const glm::vec3 velocity =
+        body.velocity - first->normal * std::min(approach, 0.0f);
+    body.shape->trs()->applyTranslation((body.velocity - velocity) *
+                                        first->time);
+    body.velocity = velocity;
+    return true;
 }
 
-inline static bool broadPhaseCollision(lix::RigidBody &bodyA,
-                                       lix::RigidBody &bodyB) {
-    return bodyA.shape->simplified()->test(*bodyB.shape->simplified());
+static uint32_t findIsland(std::vector<uint32_t> &islands, uint32_t i) {
+    while (islands[i] != i) {
+        islands[i] = islands[islands[i]];
+        i = islands[i];
+    }
+    return i;
 }
 
-static inline bool narrowPhaseCollision(lix::RigidBody &bodyA,
-                                        lix::RigidBody &bodyB,
-                                        std::vector<glm::vec3> &simplex,
-                                        const glm::vec3 &D,
-                                        lix::Collision *collision = nullptr) {
-    simplex.clear();
-    return lix::gjk(*bodyA.shape, *bodyB.shape, simplex, D, collision);
+// Wakes every sleeping body in the islands of the given bodies. Returns true
+// if any woke.
+static bool wakeIslands(std::vector<lix::DynamicBody> &dynamicBodies,
+                        std::vector<uint32_t> &islands,
+                        std::vector<uint32_t> &bodies) {
+    if (bodies.empty()) {
+        return false;
+    }
+    for (uint32_t &body : bodies) {
+        body = findIsland(islands, body);
+    }
+    std::sort(bodies.begin(), bodies.end());
+    for (uint32_t i{0}; i < dynamicBodies.size(); ++i) {
+        if (dynamicBodies[i].sleeping &&
+            std::binary_search(bodies.begin(), bodies.end(),
+                               findIsland(islands, i))) {
+            dynamicBodies[i].sleeping = false;
+            dynamicBodies[i].sleepTime = 0.0f;
+        }
+    }
+    bodies.clear();
+    return true;
 }
 
-inline static float backtrackCollision(lix::DynamicBody &dynamicBody,
-                                       lix::RigidBody &staticBody, float dt,
-                                       std::vector<glm::vec3> &simplex,
-                                       const glm::vec3 &D,
-                                       lix::Collision &collision) {
-    float t = dt;
-    bool backtrack{true};
-    float rewindedTime{0.0f};
-    for (size_t i{0}; i < 2; ++i) {
-        t *= 0.5f;
-        if (backtrack) {
-            backwardBody(dynamicBody, t);
-            rewindedTime += t;
-        } else {
-            forwardBody(dynamicBody, t);
-            rewindedTime -= t;
-        }
-        backtrack = narrowPhaseCollision(dynamicBody, staticBody, simplex, D,
-                                         &collision);
-    }
-    unsigned short counter{0};
-    while (!backtrack) {
-        forwardBody(dynamicBody, t);
-        rewindedTime -= t;
-        backtrack = narrowPhaseCollision(dynamicBody, staticBody, simplex, D,
-                                         &collision);
-        if (++counter > 2) {
-            printf("Error: failed to backtrack collision\n");
-            return -1;
-        }
-    }
-    return rewindedTime;
+static inline lix::RigidBody &
+pairBody(const lix::BroadPhase::Pair &pair,
+         std::vector<lix::DynamicBody> &dynamicBodies,
+         std::vector<lix::StaticBody> &staticBodies) {
+    return pair.dynamic
+               ? static_cast<lix::RigidBody &>(dynamicBodies[pair.b])
+               : staticBodies[pair.b];
 }
 
-void lix::PhysicsEngine::step(std::vector<lix::DynamicBody> &dynamicBodies,
-                              std::vector<lix::StaticBody> &staticBodies,
-                              float dt) {
-    for (auto &dynamicBody : dynamicBodies) {
-        applyForces(dynamicBody, dt);
-        forwardBody(dynamicBody, dt); // fast forward
+// Joins the awake bodies in contact into islands and puts to sleep the
+// islands whose bodies have all been at rest long enough.
+static void
+updateSleep(std::vector<lix::DynamicBody> &dynamicBodies,
+            const std::vector<lix::BroadPhase::Pair> &pairs,
+            const std::vector<lix::PhysicsEngine::Contact> &contacts,
+            std::vector<uint32_t> &islands,
+            const lix::PhysicsEngine::SleepSettings &settings, float dt) {
+    for (uint32_t i{0}; i < dynamicBodies.size(); ++i) {
+        if (!dynamicBodies[i].sleeping) {
+            islands[i] = i;
+        }
+    }
+    for (size_t i{0}; i < pairs.size(); ++i) {
+        if (contacts[i].colliding && pairs[i].dynamic) {
+            islands[findIsland(islands, pairs[i].a)] =
+                findIsland(islands, pairs[i].b);
+        }
+    }
+
+    // The least time at rest of any body in the island, kept at its root.
+    thread_local std::vector<float> restTime;
+    restTime.assign(dynamicBodies.size(), FLT_MAX);
+    const float linear2 = settings.linearVelocity * settings.linearVelocity;
+    const float angular2 = settings.angularVelocity * settings.angularVelocity;
+    for (uint32_t i{0}; i < dynamicBodies.size(); ++i) {
+        lix::DynamicBody &body = dynamicBodies[i];
+        if (body.sleeping) {
+            continue;
+        }
+        const bool slow =
+            glm::dot(body.velocity, body.velocity) < linear2 &&
+            glm::dot(body.angularVelocity, body.angularVelocity) < angular2;
+        body.sleepTime = slow ? body.sleepTime + dt : 0.0f;
+        float &island = restTime[findIsland(islands, i)];
+        island = std::min(island, body.sleepTime);
+    }
+    for (uint32_t i{0}; i < dynamicBodies.size(); ++i) {
+        lix::DynamicBody &body = dynamicBodies[i];
+        if (!body.sleeping &&
+            restTime[findIsland(islands, i)] >= settings.timeToSleep) {
+            body.sleeping = true;
+            body.velocity = glm::vec3{0.0f};
+            body.angularVelocity = glm::vec3{0.0f};
+        }
     }
-    std::vector<std::pair<lix::DynamicBody &, lix::RigidBody &>>
-        broadPhaseCollisions;
-    glm::vec3 D = glm::ballRand(1.0f);
-    std::vector<glm::vec3> simplex;
+}
+
+// Compound shapes collide part by part, the deepest contact wins. Parts
+// whose bounds don't overlap are skipped. The seed axis isn't written back
+// since it only fits one of the part pairs.
+static void collideParts(lix::Shape &a, lix::Shape &b,
+                         lix::PhysicsEngine::Contact &contact,
+                         lix::CollisionQuery &query) {
+    auto parts = [](lix::Shape &shape, size_t i) {
+        return i == 0 ? &shape : shape.positives()[i - 1].get();
+    };
+    // The simplified shape of a compound bounds all of it, its first part
+    // is bounded by its support points instead.
+    auto bounds = [](lix::Shape &shape, size_t i) {
+        if (i > 0) {
+            return shape.positives()[i - 1]->bounds();
+        }
+        return shape.positives().empty() ? shape.bounds()
+                                         : shape.supportBounds();
+    };
+    thread_local std::vector<lix::Bounds> boundsB;
+    boundsB.clear();
+    for (size_t j{0}; j <= b.positives().size(); ++j) {
+        boundsB.push_back(bounds(b, j));
+    }
+    const glm::vec3 axis = contact.axis;
     lix::Collision collision;
-    for (auto &dynamicBody : dynamicBodies) {
-        for (auto &staticBody : staticBodies) {
-            if (broadPhaseCollision(dynamicBody, staticBody) &&
-                narrowPhaseCollision(dynamicBody, staticBody, simplex, D)) {
-                broadPhaseCollisions.emplace_back(dynamicBody, staticBody);
-                break;
+    contact.colliding = false;
+    contact.gjkIterations = 0;
+    contact.epaIterations = 0;
+    for (size_t i{0}; i <= a.positives().size(); ++i) {
+        const lix::Bounds boundsA = bounds(a, i);
+        for (size_t j{0}; j <= b.positives().size(); ++j) {
+            if (!boundsA.overlaps(boundsB[j])) {
+                continue;
+            }
+            lix::Shape *partA = parts(a, i);
+            lix::Shape *partB = parts(b, j);
+            bool colliding;
+            if (lix::PrimitiveContact primitive =
+                    lix::primitiveContact(*partA, *partB)) {
+                colliding = primitive(*partA, *partB, collision);
+            } else {
+                colliding = query.collides(*partA, *partB, axis, &collision);
+                contact.gjkIterations += query.gjkIterations();
+                contact.epaIterations += query.epaIterations();
+            }
+            const bool deeper = !contact.colliding ||
+                                collision.penetrationDepth >
+                                    contact.collision.penetrationDepth;
+            if (colliding && deeper) {
+                contact.colliding = true;
+                contact.collision = collision;
+                contact.partA = partA;
+                contact.partB = partB;
             }
         }
     }
-    for (const auto &entry : broadPhaseCollisions) {
-        auto &dynamicBody = entry.first;
-        auto &staticBody = entry.second;
+}
 
-        float rewindedTime = backtrackCollision(dynamicBody, staticBody, dt,
-                                                simplex, D, collision);
+void lix::PhysicsEngine::narrowPhase(
+    const std::vector<lix::BroadPhase::Pair> &pairs,
+    std::vector<lix::DynamicBody> &dynamicBodies,
+    std::vector<lix::StaticBody> &staticBodies,
+    std::vector<lix::PhysicsEngine::Contact> &contacts, lix::ThreadPool *pool,
+    lix::PairCache *cache) {
+    contacts.resize(pairs.size());
+    // The cache isn't thread safe, look the pairs up before the workers
+    // start. They write the new axes straight back through the slots, by
+    // reference since the workers have their own thread_local copies.
+    thread_local std::vector<glm::vec3 *> callerSlots;
+    std::vector<glm::vec3 *> &slots = callerSlots;
+    slots.assign(pairs.size(), nullptr);
+    for (size_t i{0}; i < pairs.size(); ++i) {
+        lix::RigidBody &a = dynamicBodies[pairs[i].a];
+        lix::RigidBody &b = pairBody(pairs[i], dynamicBodies, staticBodies);
+        Contact &contact = contacts[i];
+        contact.cached = false;
+        if (cache) {
+            slots[i] = &cache->axis({a.shape.get(), b.shape.get()},
+                                    contact.cached);
+            contact.axis = *slots[i];
+        }
+        // Part bounds are refit lazily. Do it here, the workers only read
+        // them in collideParts.
+        for (lix::Shape *shape : {a.shape.get(), b.shape.get()}) {
+            for (const auto &part : shape->positives()) {
+                part->bounds();
+            }
+        }
+        if (!contact.cached) {
+            contact.axis =
+                glm::normalize(lix::seedDirection(*a.shape, *b.shape));
+        }
+    }
 
-        if (rewindedTime < 0) {
-            continue;
+    // The broad phase already culled by bounds, so go straight to the
+    // closed form contact for primitive pairs and to GJK/EPA for the rest.
+    auto range = [&](size_t begin, size_t end) {
+        thread_local lix::CollisionQuery query;
+        for (size_t i{begin}; i < end; ++i) {
+            lix::RigidBody &a = dynamicBodies[pairs[i].a];
+            lix::RigidBody &b =
+                pairBody(pairs[i], dynamicBodies, staticBodies);
+            Contact &contact = contacts[i];
+            contact.partA = a.shape.get();
+            contact.partB = b.shape.get();
+            if (!a.shape->positives().empty() ||
+                !b.shape->positives().empty()) {
+                collideParts(*a.shape, *b.shape, contact, query);
+                continue;
+            }
+            if (lix::PrimitiveContact primitive =
+                    lix::primitiveContact(*a.shape, *b.shape)) {
+                contact.colliding =
+                    primitive(*a.shape, *b.shape, contact.collision);
+                contact.gjkIterations = 0;
+                contact.epaIterations = 0;
+                continue;
+            }
+            contact.colliding = query.collides(
+                *a.shape, *b.shape, contact.axis, &contact.collision);
+            contact.axis = query.direction();
+            contact.gjkIterations = query.gjkIterations();
+            contact.epaIterations = query.epaIterations();
+            if (slots[i]) {
+                *slots[i] = contact.axis;
+            }
         }
+    };
+    if (pool) {
+        pool->parallelFor(pairs.size(), 32, range);
+    } else {
+        range(0, pairs.size());
+    }
+}
 
-        // bodies are colliding but with small margin
-        if (!lix::epa(*dynamicBody.shape, *staticBody.shape, simplex,
-                      &collision)) {
-            printf("EPA fail\n");
+void lix::PhysicsEngine::step(std::vector<lix::DynamicBody> &dynamicBodies,
+                              std::vector<lix::StaticBody> &staticBodies,
+                              float dt) {
+    static lix::PhysicsEngine::Context context;
+    step(dynamicBodies, staticBodies, dt, context);
+}
+
+void lix::PhysicsEngine::step(std::vector<lix::DynamicBody> &dynamicBodies,
+                              std::vector<lix::StaticBody> &staticBodies,
+                              float dt, lix::PhysicsEngine::Context &context) {
+    using Clock = std::chrono::steady_clock;
+    auto elapsedMs = [](Clock::time_point &since) {
+        auto now = Clock::now();
+        std::chrono::duration<float, std::milli> ms = now - since;
+        since = now;
+        return ms.count();
+    };
+    Timings &timings = context.timings;
+    auto t = Clock::now();
+
+    std::vector<uint32_t> &islands = context.islands;
+    thread_local std::vector<uint32_t> toWake;
+    if (islands.size() != dynamicBodies.size()) {
+        // Bodies came or went, the islands no longer match. Start over.
+        islands.resize(dynamicBodies.size());
+        for (uint32_t i{0}; i < dynamicBodies.size(); ++i) {
+            islands[i] = i;
+            dynamicBodies[i].sleeping = false;
         }
+    }
+    for (uint32_t i{0}; i < dynamicBodies.size(); ++i) {
+        const lix::DynamicBody &body = dynamicBodies[i];
+        if (body.sleeping && (body.velocity != glm::vec3{0.0f} ||
+                              body.angularVelocity != glm::vec3{0.0f})) {
+            toWake.push_back(i);
+        }
+    }
+    wakeIslands(dynamicBodies, islands, toWake);
 
-        float J = impulse(dynamicBody, collision, 0.99f);
-        assert(J != 0);
+    for (auto &dynamicBody : dynamicBodies) {
+        if (!dynamicBody.sleeping) {
+            applyForces(dynamicBody, dt);
+        }
+    }
 
-        // collision response
-        dynamicBody.shape->trs()->applyTranslation(collision.normal *
-                                                   collision.penetrationDepth);
-        // dynamicBody.velocity += J * dynamicBody.mass_inv * collision.normal;
-        // dynamicBody.velocity *= glm::length(dynamicBody.velocity) / (J *
-        // dynamicBody.mass_inv);
+    context.broadPhase.refresh(dynamicBodies, staticBodies);
+    timings.broadPhase = elapsedMs(t);
 
-        dynamicBody.velocity =
-            glm::reflect(dynamicBody.velocity, collision.normal);
-        dynamicBody.velocity +=
-            J * dynamicBody.mass_inv * collision.normal; // * 0.5f;
+    // A sleeping body touched by an awake one wakes its island. The island's
+    // own pairs were left out, so look again, only at the pairs the woken
+    // bodies add, until nothing more wakes.
+    auto &pairs = context.pairs;
+    auto &contacts = context.contacts;
+    context.broadPhase.findPairs(pairs, &dynamicBodies);
+    narrowPhase(pairs, dynamicBodies, staticBodies, contacts,
+                context.threadPool, &context.pairCache);
+    thread_local std::vector<uint8_t> awake;
+    thread_local std::vector<lix::BroadPhase::Pair> wokenPairs;
+    thread_local std::vector<Contact> wokenContacts;
+    size_t checked{0};
+    while (true) {
+        for (size_t i{checked}; i < pairs.size(); ++i) {
+            if (!contacts[i].colliding || !pairs[i].dynamic) {
+                continue;
+            }
+            for (uint32_t body : {pairs[i].a, pairs[i].b}) {
+                if (dynamicBodies[body].sleeping) {
+                    toWake.push_back(body);
+                }
+            }
+        }
+        checked = pairs.size();
+        awake.resize(dynamicBodies.size());
+        for (size_t i{0}; i < dynamicBodies.size(); ++i) {
+            awake[i] = !dynamicBodies[i].sleeping;
+        }
+        if (!wakeIslands(dynamicBodies, islands, toWake)) {
+            break;
+        }
+        // The woken bodies missed this step's forces.
+        for (size_t i{0}; i < dynamicBodies.size(); ++i) {
+            if (!awake[i] && !dynamicBodies[i].sleeping) {
+                applyForces(dynamicBodies[i], dt);
+            }
+        }
+        // Pairs with an end that was already awake have been collided.
+        context.broadPhase.findPairs(wokenPairs, &dynamicBodies);
+        wokenPairs.erase(
+            std::remove_if(wokenPairs.begin(), wokenPairs.end(),
+                           [](const lix::BroadPhase::Pair &pair) {
+                               return awake[pair.a] ||
+                                      (pair.dynamic && awake[pair.b]);
+                           }),
+            wokenPairs.end());
+        narrowPhase(wokenPairs, dynamicBodies, staticBodies, wokenContacts,
+                    context.threadPool, &context.pairCache);
+        pairs.insert(pairs.end(), wokenPairs.begin(), wokenPairs.end());
+        contacts.insert(contacts.end(), wokenContacts.begin(),
+                        wokenContacts.end());
+    }
+    context.pairCache.prune();
+    timings.narrowPhase = elapsedMs(t);
 
-        const glm::vec3 r =
-            collision.contactPoint - dynamicBody.shape->trs()->translation();
-        dynamicBody.angularVelocity += glm::cross(r, collision.normal * J) *
-                                       dynamicBody.inertiaTensor_inv * 0.5f;
+    lix::ContactSolver &solver = context.solver;
+    solver.beginFrame();
+    timings.cacheHits = 0;
+    timings.gjkIterations = 0;
+    timings.epaIterations = 0;
+    for (size_t i{0}; i < pairs.size(); ++i) {
+        const Contact &contact = context.contacts[i];
+        timings.cacheHits += contact.cached ? 1 : 0;
+        timings.gjkIterations += contact.gjkIterations;
+        timings.epaIterations += contact.epaIterations;
+        if (contact.colliding) {
+            solver.addContact(dynamicBodies[pairs[i].a],
+                              pairBody(pairs[i], dynamicBodies, staticBodies),
+                              *contact.partA, *contact.partB,
+                              contact.collision);
+        }
+    }
 
-        if (rewindedTime > 0) {
-            forwardBody(dynamicBody, rewindedTime);
+    solver.solve(dt);
+    timings.impacts = 0;
+    for (auto &dynamicBody : dynamicBodies) {
+        if (dynamicBody.sleeping) {
+            continue;
+        }
+        if (dynamicBody.continuous &&
+            sweepBody(dynamicBody, staticBodies, context.broadPhase, dt)) {
+            ++timings.impacts;
         }
+        forwardBody(dynamicBody, dt);
     }
+    updateSleep(dynamicBodies, pairs, context.contacts, islands,
+                context.sleep, dt);
+    timings.solver = elapsedMs(t);
+    timings.pairs = pairs.size();
+    timings.contacts = solver.numContacts();
+    timings.sleeping = std::count_if(
+        dynamicBodies.begin(), dynamicBodies.end(),
+        [](const lix::DynamicBody &body) { return body.sleeping; });
 }
 
 lix::StaticBody
@@ -1,14 +1,103 @@
 #pragma once
 
+#include "broadphase.h"
+#include "collision.h"
+#include "contactsolver.h"
+#include "glthreadpool.h"
+#include "paircache.h"
 #include "rigidbody.h"
 #include <glm/glm.hpp>
 #include <vector>
 
 namespace lix {
 namespace PhysicsEngine {
+// Time spent in each stage of the last step, in milliseconds.
+struct Timings {
+    float broadPhase{0.0f};
+    float narrowPhase{0.0f};
+    float solver{0.0f};
+    size_t pairs{0};
+    size_t contacts{0};
+    // Narrow phase queries seeded from the pair cache, and the GJK/EPA
+    // iterations summed over all queries.
+    size_t cacheHits{0};
+    size_t gjkIterations{0};
+    size_t epaIterations{0};
+    // Continuous bodies stopped at a time of impact.
+    size_t impacts{0};
+    // Dynamic bodies left out of the step.
+    size_t sleeping{0};
+
+    float cacheHitRate() const {
+        return pairs ? static_cast<float>(cacheHits) / pairs : 0.0f;
+    }
+
+    float iterationsPerQuery() const {
+        return pairs ? static_cast<float>(gjkIterations + epaIterations) / pairs
+                     : 0.0f;
+    }
+};
+
+// Narrow phase result for a broad phase pair.
+struct Contact {
+    bool colliding{false};
+    lix::Collision collision;
+    bool cached{false};
+    glm::vec3 axis; // seed for the next query of the pair
+    uint32_t gjkIterations{0};
+    uint32_t epaIterations{0};
+    // The shapes that touch, the bodies' own or parts of a compound shape.
+    lix::Shape *partA{nullptr};
+    lix::Shape *partB{nullptr};
+};
+
+// A dynamic body slower than both velocities for timeToSleep seconds is at
+// rest. Once every body of its island, the bodies connected to it through
+// contacts, is at rest the island sleeps.
+struct SleepSettings {
+    float linearVelocity{0.05f};
+    float angularVelocity{0.05f};
+    float timeToSleep{0.5f};
+};
+
+// State kept between steps. Use one per world; solver iterations and
+// friction are set through solver.settings().
+struct Context {
+    lix::BroadPhase broadPhase;
+    lix::ContactSolver solver;
+    Timings timings;
+    // Runs the narrow phase on this pool when set. Contacts reach the solver
+    // in pair order either way, so a step doesn't depend on the thread count.
+    lix::ThreadPool *threadPool{nullptr};
+    lix::PairCache pairCache;
+    SleepSettings sleep;
+    std::vector<lix::BroadPhase::Pair> pairs;
+    std::vector<Contact> contacts;
+    // Union-find parent of each dynamic body, the root names its island.
+    // Sleeping islands keep theirs until woken.
+    std::vector<uint32_t> islands;
+};
+
 void step(std::vector<lix::DynamicBody> &dynamicBodies,
           std::vector<lix::StaticBody> &staticBodies, float dt);
 
+void step(std::vector<lix::DynamicBody> &dynamicBodies,
+          std::vector<lix::StaticBody> &staticBodies, float dt,
+          Context &context);
+
+// Runs GJK/EPA on every pair, contacts[i] is the result for pairs[i]. Shapes
+// with positives collide part by part, keeping the deepest contact. The
+// shapes must have been tracked by the broad phase since they last moved, so
+// their cached transforms are only read. Queries start from the direction in
+// cache if given, which is then updated. Pruning the cache is left to the
+// caller, once per step.
+void narrowPhase(const std::vector<lix::BroadPhase::Pair> &pairs,
+                 std::vector<lix::DynamicBody> &dynamicBodies,
+                 std::vector<lix::StaticBody> &staticBodies,
+                 std::vector<Contact> &contacts,
+                 lix::ThreadPool *pool = nullptr,
+                 lix::PairCache *cache = nullptr);
+
 lix::StaticBody createStaticBody(std::shared_ptr<lix::Shape> shape);
 
 lix::DynamicBody createDynamicBody(std::shared_ptr<lix::Shape> shape,
@@ -0,0 +1,94 @@
+#include "physicsquery.h"
+
+#include "collisionquery.h"
+#include "sphere.h"
+#include "timeofimpact.h"
+
+lix::PhysicsQuery::PhysicsQuery(lix::BroadPhase &broadPhase,
+                                std::vector<lix::DynamicBody> &dynamicBodies,
+                                std::vector<lix::StaticBody> &staticBodies)
+    : _broadPhase{broadPhase}, _dynamicBodies{dynamicBodies},
+      _staticBodies{staticBodies} {
+    // Model matrices are computed lazily. Flush them here, whatever the
+    // broad phase reads, so that concurrent queries only read them.
+    for (auto &body : dynamicBodies) {
+        body.shape->trs()->modelMatrix();
+    }
+    for (auto &body : staticBodies) {
+        body.shape->trs()->modelMatrix();
+    }
+    broadPhase.refresh(dynamicBodies, staticBodies);
+}
+
+lix::RigidBody &lix::PhysicsQuery::body(uint32_t index, bool dynamic) const {
+    return dynamic ? static_cast<lix::RigidBody &>(_dynamicBodies[index])
+                   : _staticBodies[index];
+}
+
+std::optional<lix::PhysicsQuery::Hit>
+lix::PhysicsQuery::raycast(const Ray &ray) const {
+    return sphereCast(ray, 0.0f);
+}
+
+// A ray is a sphere of radius 0. The sphere is swept by time of impact, with
+// unit speed the time is the distance.
+std::optional<lix::PhysicsQuery::Hit>
+lix::PhysicsQuery::sphereCast(const Ray &ray, float radius) const {
+    thread_local lix::CollisionQuery query;
+    lix::TRS trs{ray.origin};
+    lix::Sphere sphere{&trs, radius};
+    std::optional<Hit> closest;
+    _broadPhase.raycast(
+        ray.origin, ray.direction, ray.maxDistance, radius,
+        [&](uint32_t index, bool dynamic, float maxDistance) {
+            auto impact = lix::timeOfImpact(sphere, ray.direction, 0.0f,
+                                            *body(index, dynamic).shape,
+                                            maxDistance, query);
+            if (!impact) {
+                return maxDistance;
+            }
+            const glm::vec3 center = ray.origin + ray.direction * impact->time;
+            closest = Hit{index, dynamic, impact->time,
+                          center - impact->normal * radius, impact->normal};
+            return impact->time;
+        });
+    return closest;
+}
+
+void lix::PhysicsQuery::overlap(lix::Shape &shape,
+                                std::vector<Overlap> &overlaps) const {
+    thread_local lix::CollisionQuery query;
+    overlaps.clear();
+    shape.trs()->modelMatrix();
+    _broadPhase.query(shape.bounds(), [&](uint32_t index, bool dynamic) {
+        lix::Shape &other = *body(index, dynamic).shape;
+        if (&other == &shape) {
+            return;
+        }
+        if (query.intersects(shape, other, lix::seedDirection(shape, other))) {
+            overlaps.push_back({index, dynamic});
+        }
+    });
+}
+
+void lix::PhysicsQuery::raycast(const std::vector<Ray> &rays,
+                                std::vector<std::optional<Hit>> &hits,
+                                lix::ThreadPool *pool) const {
+    sphereCast(rays, 0.0f, hits, pool);
+}
+
+void lix::PhysicsQuery::sphereCast(const std::vector<Ray> &rays, float radius,
+                                   std::vector<std::optional<Hit>> &hits,
+                                   lix::ThreadPool *pool) const {
+    hits.resize(rays.size());
+    auto range = [&](size_t begin, size_t end) {
+        for (size_t i{begin}; i < end; ++i) {
+            hits[i] = sphereCast(rays[i], radius);
+        }
+    };
+    if (pool) {
+        pool->parallelFor(rays.size(), 64, range);
+    } else {
+        range(0, rays.size());
+    }
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <optional>
+#include <vector>
+
+#include "broadphase.h"
+#include "glthreadpool.h"
+#include "rigidbody.h"
+
+namespace lix {
+// Ray, sphere cast and overlap queries against every body the broad phase
+// tracks, found through its trees. Construction refreshes the broad phase,
+// after that the shapes are only read, so any number of queries can run at
+// once. Don't move the bodies while a PhysicsQuery is in use.
+class PhysicsQuery {
+  public:
+    struct Ray {
+        glm::vec3 origin;
+        glm::vec3 direction; // unit
+        float maxDistance;
+    };
+
+    struct Hit {
+        uint32_t index; // into the dynamic or static bodies
+        bool dynamic;
+        float distance; // along the ray
+        glm::vec3 point;
+        glm::vec3 normal; // of the surface hit
+    };
+
+    struct Overlap {
+        uint32_t index;
+        bool dynamic;
+    };
+
+    PhysicsQuery(lix::BroadPhase &broadPhase,
+                 std::vector<lix::DynamicBody> &dynamicBodies,
+                 std::vector<lix::StaticBody> &staticBodies);
+
+    // Closest hit along the ray. Bodies the ray starts in aren't hit.
+    std::optional<Hit> raycast(const Ray &ray) const;
+    // Closest hit of a sphere of radius moved along the ray, point is where
+    // it touches the body.
+    std::optional<Hit> sphereCast(const Ray &ray, float radius) const;
+    // Every body overlapping shape, in no particular order.
+    void overlap(lix::Shape &shape, std::vector<Overlap> &overlaps) const;
+
+    // hits[i] is the result for rays[i]. Spread over pool when given.
+    void raycast(const std::vector<Ray> &rays,
+                 std::vector<std::optional<Hit>> &hits,
+                 lix::ThreadPool *pool = nullptr) const;
+    void sphereCast(const std::vector<Ray> &rays, float radius,
+                    std::vector<std::optional<Hit>> &hits,
+                    lix::ThreadPool *pool = nullptr) const;
+
+  private:
+    lix::RigidBody &body(uint32_t index, bool dynamic) const;
+
+    const lix::BroadPhase &_broadPhase;
+    std::vector<lix::DynamicBody> &_dynamicBodies;
+    std::vector<lix::StaticBody> &_staticBodies;
+};
+} // namespace lix
@@ -0,0 +1,57 @@
+#include "physicsworld.h"
+
+#include <cassert>
+
+lix::PhysicsWorld::PhysicsWorld(std::vector<lix::DynamicBody> &dynamicBodies,
+                                std::vector<lix::StaticBody> &staticBodies,
+                                const Settings &settings)
+    : _dynamicBodies{dynamicBodies}, _staticBodies{staticBodies},
+      _settings{settings} {
+    assert(settings.stepTime > 0.0f && settings.substeps > 0);
+}
+
+uint32_t lix::PhysicsWorld::update(float frameTime,
+                                   const StepCallback &beforeStep) {
+    _accumulator += frameTime;
+    uint32_t steps{0};
+    while (_accumulator >= _settings.stepTime) {
+        if (steps == _settings.maxSteps) {
+            _accumulator = 0.0f;
+            break;
+        }
+        if (beforeStep) {
+            beforeStep(_steps);
+        }
+        step();
+        _accumulator -= _settings.stepTime;
+        ++steps;
+    }
+    return steps;
+}
+
+void lix::PhysicsWorld::step() {
+    _previous.resize(_dynamicBodies.size());
+    for (size_t i{0}; i < _dynamicBodies.size(); ++i) {
+        const lix::TRS &trs = *_dynamicBodies[i].shape->trs();
+        _previous[i] = {trs.translation(), trs.rotation()};
+    }
+    const float dt = _settings.stepTime / _settings.substeps;
+    for (uint32_t i{0}; i < _settings.substeps; ++i) {
+        lix::PhysicsEngine::step(_dynamicBodies, _staticBodies, dt, _context);
+    }
+    ++_steps;
+}
+
+void lix::PhysicsWorld::interpolate(size_t index, lix::TRS &trs) const {
+    const lix::TRS &current = *_dynamicBodies[index].shape->trs();
+    if (index >= _previous.size()) {
+        trs.setTranslation(current.translation());
+        trs.setRotation(current.rotation());
+        return;
+    }
+    const Pose &previous = _previous[index];
+    const float t = alpha();
+    trs.setTranslation(
+        glm::mix(previous.translation, current.translation(), t));
+    trs.setRotation(glm::slerp(previous.rotation, current.rotation(), t));
+}
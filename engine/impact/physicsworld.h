@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "gltrs.h"
+#include "physicsengine.h"
+#include "rigidbody.h"
+
+namespace lix {
+// Drives PhysicsEngine::step at a fixed rate whatever the frame rate. Frame
+// time goes into an accumulator that is spent in whole steps, so the same
+// sequence of steps and inputs always gives the same bodies, bit for bit.
+// That holds on any thread count as long as each contact only depends on
+// its own pair, as with the built-in shapes and hull backed polygons, whose
+// support searches keep no state between queries. Rendering draws the
+// bodies interpolated between the last two steps.
+class PhysicsWorld {
+  public:
+    struct Settings {
+        float stepTime{1.0f / 120.0f};
+        // Each step is solved as this many shorter ones, trading time for
+        // stiffer stacks.
+        uint32_t substeps{1};
+        // At most this many steps per update, the rest of a long frame is
+        // dropped rather than falling further behind.
+        uint32_t maxSteps{8};
+    };
+
+    // Called before each step with the number of steps taken so far. Apply
+    // input here for it to land on the same step in a replay.
+    using StepCallback = std::function<void(uint64_t step)>;
+
+    PhysicsWorld(std::vector<lix::DynamicBody> &dynamicBodies,
+                 std::vector<lix::StaticBody> &staticBodies,
+                 const Settings &settings);
+
+    PhysicsWorld(const PhysicsWorld &other) = delete;
+    PhysicsWorld &operator=(const PhysicsWorld &other) = delete;
+
+    // Adds frameTime to the accumulator and takes the steps it pays for.
+    // Returns how many.
+    uint32_t update(float frameTime, const StepCallback &beforeStep = {});
+    // One step regardless of the accumulator.
+    void step();
+
+    // How far the accumulator is into the next step, from 0 to 1.
+    float alpha() const { return _accumulator / _settings.stepTime; }
+
+    // Sets trs to dynamic body index as it was alpha of the way from the
+    // previous step to the last one.
+    void interpolate(size_t index, lix::TRS &trs) const;
+
+    uint64_t steps() const { return _steps; }
+
+    Settings &settings() { return _settings; }
+
+    const Settings &settings() const { return _settings; }
+
+    lix::PhysicsEngine::Context &context() { return _context; }
+
+  private:
+    struct Pose {
+        glm::vec3 translation;
+        glm::quat rotation;
+    };
+
+    std::vector<lix::DynamicBody> &_dynamicBodies;
+    std::vector<lix::StaticBody> &_staticBodies;
+    Settings _settings;
+    lix::PhysicsEngine::Context _context;
+    std::vector<Pose> _previous;
+    float _accumulator{0.0f};
+    uint64_t _steps{0};
+};
+} // namespace lix
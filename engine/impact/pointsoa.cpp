@@ -0,0 +1,106 @@
+#include "pointsoa.h"
+
+#include <cfloat>
+
+#if defined(__AVX__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace {
+// Picks the best lane, on equal values the lowest index like a scalar scan.
+template <size_t N>
+inline size_t reduceLanes(const float (&values)[N], const float (&indices)[N]) {
+    size_t best{0};
+    for (size_t i{1}; i < N; ++i) {
+        if (values[i] > values[best] ||
+            (values[i] == values[best] && indices[i] < indices[best])) {
+            best = i;
+        }
+    }
+    return static_cast<size_t>(indices[best]);
+}
+} // namespace
+
+lix::PointSoA::PointSoA(const std::vector<glm::vec3> &points) {
+    assign(points);
+}
+
+void lix::PointSoA::assign(const std::vector<glm::vec3> &points) {
+    _size = points.size();
+    const size_t padded = (_size + WIDTH - 1) / WIDTH * WIDTH;
+    const glm::vec3 pad = _size ? points.front() : glm::vec3{0.0f};
+    _x.assign(padded, pad.x);
+    _y.assign(padded, pad.y);
+    _z.assign(padded, pad.z);
+    for (size_t i{0}; i < _size; ++i) {
+        _x[i] = points[i].x;
+        _y[i] = points[i].y;
+        _z[i] = points[i].z;
+    }
+}
+
+size_t lix::PointSoA::argMaxDot(const glm::vec3 &D) const {
+#if defined(__AVX__)
+    const size_t padded = _x.size();
+    const __m256 dx = _mm256_set1_ps(D.x);
+    const __m256 dy = _mm256_set1_ps(D.y);
+    const __m256 dz = _mm256_set1_ps(D.z);
+    const __m256 step = _mm256_set1_ps(8.0f);
+    __m256 index = _mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7);
+    __m256 best = _mm256_set1_ps(-FLT_MAX);
+    __m256 bestIndex = _mm256_setzero_ps();
+    for (size_t i{0}; i < padded; i += 8) {
+        const __m256 dot = _mm256_add_ps(
+            _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(&_x[i]), dx),
+                          _mm256_mul_ps(_mm256_loadu_ps(&_y[i]), dy)),
+            _mm256_mul_ps(_mm256_loadu_ps(&_z[i]), dz));
+        const __m256 greater = _mm256_cmp_ps(dot, best, _CMP_GT_OQ);
+        best = _mm256_blendv_ps(best, dot, greater);
+        bestIndex = _mm256_blendv_ps(bestIndex, index, greater);
+        index = _mm256_add_ps(index, step);
+    }
+    float values[8];
+    float indices[8];
+    _mm256_storeu_ps(values, best);
+    _mm256_storeu_ps(indices, bestIndex);
+    return reduceLanes(values, indices);
+#elif defined(__SSE2__)
+    const size_t padded = _x.size();
+    const __m128 dx = _mm_set1_ps(D.x);
+    const __m128 dy = _mm_set1_ps(D.y);
+    const __m128 dz = _mm_set1_ps(D.z);
+    const __m128 step = _mm_set1_ps(4.0f);
+    __m128 index = _mm_setr_ps(0, 1, 2, 3);
+    __m128 best = _mm_set1_ps(-FLT_MAX);
+    __m128 bestIndex = _mm_setzero_ps();
+    for (size_t i{0}; i < padded; i += 4) {
+        const __m128 dot =
+            _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&_x[i]), dx),
+                                  _mm_mul_ps(_mm_loadu_ps(&_y[i]), dy)),
+                       _mm_mul_ps(_mm_loadu_ps(&_z[i]), dz));
+        // No blendv before SSE4.1, select with masks.
+        const __m128 greater = _mm_cmpgt_ps(dot, best);
+        best =
+            _mm_or_ps(_mm_and_ps(greater, dot), _mm_andnot_ps(greater, best));
+        bestIndex = _mm_or_ps(_mm_and_ps(greater, index),
+                              _mm_andnot_ps(greater, bestIndex));
+        index = _mm_add_ps(index, step);
+    }
+    float values[4];
+    float indices[4];
+    _mm_storeu_ps(values, best);
+    _mm_storeu_ps(indices, bestIndex);
+    return reduceLanes(values, indices);
+#else
+    float best = -FLT_MAX;
+    size_t bestIndex{0};
+    for (size_t i{0}; i < _size; ++i) {
+        const float dot = _x[i] * D.x + _y[i] * D.y + _z[i] * D.z;
+        if (dot > best) {
+            best = dot;
+            bestIndex = i;
+        }
+    }
+    return bestIndex;
+#endif
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+namespace lix {
+// Points stored as separate x, y and z arrays so the support point search
+// can run on whole SIMD registers. The arrays are padded to a multiple of
+// WIDTH with copies of the first point.
+class PointSoA {
+  public:
+    static constexpr size_t WIDTH{8};
+
+    PointSoA() = default;
+    explicit PointSoA(const std::vector<glm::vec3> &points);
+
+    void assign(const std::vector<glm::vec3> &points);
+
+    size_t size() const { return _size; }
+
+    glm::vec3 operator[](size_t i) const { return {_x[i], _y[i], _z[i]}; }
+
+    // Index of the point furthest along direction, the lowest one on ties.
+    // Uses AVX or SSE2 when the compiler targets them.
+    size_t argMaxDot(const glm::vec3 &direction) const;
+
+  private:
+    std::vector<float> _x;
+    std::vector<float> _y;
+    std::vector<float> _z;
+    size_t _size{0};
+};
+} // namespace lix
@@ -1,7 +1,11 @@
 #include "polygon.h"
 
 #include <algorithm>
-#include <stdexcept>
+
+#include "aabb.h"
+#include "capsule.h"
+#include "primitivecollision.h"
+#include "sphere.h"
 
 namespace {
 inline glm::vec3 centerOfPolygon(const std::vector<glm::vec3> &points) {
@@ -15,31 +19,43 @@ inline glm::vec3 centerOfPolygon(const std::vector<glm::vec3> &points) {
 } // namespace
 
 lix::Polygon::Polygon(const lix::Polygon &other)
-    : lix::Shape{other}, _points{other._points} {}
+    : lix::Shape{other}, _points{other._points}, _soa{other._soa},
+      _graph{other._graph}, _center{other._center} {}
 
 lix::Polygon::Polygon(lix::TRS *trs, const std::vector<glm::vec3> &points)
-    : Shape{trs}, _points{points}, _transformedPoints{},
+    : Shape{trs}, _points{points}, _soa{points}, _transformedPoints{},
       _center{centerOfPolygon(points)} {}
 
+lix::Polygon::Polygon(lix::TRS *trs, const lix::VertexGraph &graph)
+    : Polygon{trs, graph.points} {
+    _graph = &graph;
+}
+
 lix::Polygon::~Polygon() noexcept { _transformedPoints.clear(); }
 
 lix::Polygon *lix::Polygon::clone() const { return new lix::Polygon(*this); }
 
 glm::vec3 lix::Polygon::supportPoint(const glm::vec3 &D) {
-    float maxVal = -FLT_MAX;
-    int maxIndex{-1};
-    updateTransformedPoints();
-    for (size_t i{0}; i < _transformedPoints.size(); ++i) {
-        // printf("checking: %f %f %f\n", _transformedPoints[i].x,
-        // _transformedPoints[i].y, _transformedPoints[i].z);
-        float val = glm::dot(_transformedPoints[i], D);
-        if (val > maxVal) {
-            maxVal = val;
-            maxIndex = static_cast<int>(i);
-        }
+    // No state is kept between calls, so the answer never depends on which
+    // query or thread came before.
+    uint32_t start{0};
+    return hintedSupportPoint(D, start);
+}
+
+glm::vec3 lix::Polygon::hintedSupportPoint(const glm::vec3 &D,
+                                           uint32_t &hint) {
+    assert(_soa.size() > 0);
+    // max dot(M * p, D) is max dot(p, transpose(M) * D) for the linear part.
+    const glm::mat4 &m = trs()->modelMatrix();
+    const glm::vec3 localD = glm::transpose(glm::mat3(m)) * D;
+    size_t index;
+    if (_graph) {
+        index = _graph->climb(localD, hint);
+        hint = static_cast<uint32_t>(index);
+    } else {
+        index = _soa.argMaxDot(localD);
     }
-    assert(maxIndex != -1);
-    return _transformedPoints.at(maxIndex);
+    return glm::vec3(m * glm::vec4(_soa[index], 1.0f));
 }
 
 const std::vector<glm::vec3> &lix::Polygon::points() const { return _points; }
@@ -53,24 +69,24 @@ glm::vec3 lix::Polygon::center() {
     return glm::vec3(trs()->modelMatrix() * glm::vec4(_center, 1.0f));
 }
 
-bool lix::Polygon::intersects(lix::Capsule & /*capsule*/) {
-    throw std::runtime_error("polygon-capsule collision not implemented");
+bool lix::Polygon::intersects(lix::Capsule &capsule) {
+    return lix::overlaps(*this, capsule);
 }
 
-bool lix::Polygon::intersects(lix::Sphere & /*sphere*/) {
-    throw std::runtime_error("polygon-sphere collision not implemented");
+bool lix::Polygon::intersects(lix::Sphere &sphere) {
+    return lix::overlaps(*this, sphere);
 }
 
-bool lix::Polygon::intersects(lix::AABB & /*aabb*/) {
-    throw std::runtime_error("polygon-aabb collision not implemented");
+bool lix::Polygon::intersects(lix::AABB &aabb) {
+    return lix::overlaps(*this, aabb);
 }
 
-bool lix::Polygon::intersects(lix::Polygon & /*polygon*/) {
-    throw std::runtime_error("polygon-polygon collision not implemented");
+bool lix::Polygon::intersects(lix::Polygon &polygon) {
+    return lix::overlaps(*this, polygon);
 }
 
-bool lix::Polygon::doTest(lix::Shape & /*shape*/) {
-    throw std::runtime_error("Polygon does not support simple test");
+bool lix::Polygon::doTest(lix::Shape &shape) {
+    return lix::overlaps(*this, shape);
 }
 
 bool lix::Polygon::updateTransformedPoints() {
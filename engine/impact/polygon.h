@@ -3,16 +3,27 @@
 #include <memory>
 #include <vector>
 
+#include "pointsoa.h"
 #include "shape.h"
+#include "vertexgraph.h"
 
 namespace lix {
 class Polygon : public lix::Shape {
   public:
     Polygon(const Polygon &other);
     Polygon(lix::TRS *trs, const std::vector<glm::vec3> &points);
+    // Hull backed, support points hill climb over the graph instead of
+    // scanning every point. Large smooth hulls then take a few steps per
+    // query when the hint follows the searches. graph must outlive the
+    // polygon.
+    Polygon(lix::TRS *trs, const lix::VertexGraph &graph);
     virtual ~Polygon() noexcept;
     virtual Polygon *clone() const override;
+    // Searches the local points along dir turned into model space, so moving
+    // the polygon doesn't transform all its points.
     glm::vec3 supportPoint(const glm::vec3 &dir) override;
+    glm::vec3 hintedSupportPoint(const glm::vec3 &dir,
+                                 uint32_t &hint) override;
     const std::vector<glm::vec3> &points() const;
     const std::vector<glm::vec3> &transformedPoints();
     glm::vec3 center();
@@ -27,6 +38,8 @@ class Polygon : public lix::Shape {
 
   private:
     const std::vector<glm::vec3> &_points;
+    lix::PointSoA _soa; // copy of _points for the support point search
+    const lix::VertexGraph *_graph{nullptr};
     std::vector<glm::vec3> _transformedPoints;
     uint32_t _mVersion{0};
     glm::vec3 _center;
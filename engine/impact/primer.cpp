@@ -3,6 +3,7 @@
 #include "glgeometry.h"
 
 #include <algorithm>
+#include <unordered_map>
 #include <glm/gtc/quaternion.hpp>
 
 float lix::sign(const glm::vec3 &a, const glm::vec3 &b, const glm::vec3 &c) {
@@ -79,13 +80,70 @@ bool lix::containsVertex(const std::vector<glm::vec3> &s, const glm::vec3 &v) {
 }
 
 std::vector<glm::vec3> lix::uniqueVertices(const std::vector<glm::vec3> &s) {
-    std::vector<glm::vec3> u;
-    for (const auto &p0 : s) {
-        if (!containsVertex(u, p0)) {
-            u.push_back(p0);
+    std::vector<uint32_t> remap;
+    return weldVertices(s, remap);
+}
+
+std::vector<glm::vec3> lix::weldVertices(const std::vector<glm::vec3> &s,
+                                         std::vector<uint32_t> &remap,
+                                         float tolerance) {
+    static constexpr uint32_t NONE{UINT32_MAX};
+    std::vector<glm::vec3> welded;
+    remap.resize(s.size());
+    // Welded points by cell, each cell a list threaded through next. Cells
+    // that hash alike share a list, which costs a few distance tests.
+    std::unordered_map<uint64_t, uint32_t> cells;
+    cells.reserve(s.size());
+    std::vector<uint32_t> next;
+    const float inverseCell = 1.0f / tolerance;
+    const float tolerance2 = tolerance * tolerance;
+    auto cellOf = [inverseCell](const glm::vec3 &p) {
+        return glm::ivec3{static_cast<int>(std::floor(p.x * inverseCell)),
+                          static_cast<int>(std::floor(p.y * inverseCell)),
+                          static_cast<int>(std::floor(p.z * inverseCell))};
+    };
+    auto key = [](int x, int y, int z) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(x)) *
+                    73856093ULL ^
+                static_cast<uint64_t>(static_cast<uint32_t>(y)) *
+                    19349663ULL ^
+                static_cast<uint64_t>(static_cast<uint32_t>(z)) *
+                    83492791ULL);
+    };
+    for (size_t i{0}; i < s.size(); ++i) {
+        const glm::vec3 &p = s[i];
+        const glm::ivec3 cell = cellOf(p);
+        // Anything within tolerance is in this cell or a neighbour, the
+        // first one welded wins as it would in a linear scan.
+        uint32_t match{NONE};
+        for (int dx = -1; dx <= 1; ++dx) {
+            for (int dy = -1; dy <= 1; ++dy) {
+                for (int dz = -1; dz <= 1; ++dz) {
+                    auto it = cells.find(
+                        key(cell.x + dx, cell.y + dy, cell.z + dz));
+                    if (it == cells.end()) {
+                        continue;
+                    }
+                    for (uint32_t j = it->second; j != NONE; j = next[j]) {
+                        const glm::vec3 d = welded[j] - p;
+                        if (j < match && glm::dot(d, d) < tolerance2) {
+                            match = j;
+                        }
+                    }
+                }
+            }
+        }
+        if (match == NONE) {
+            match = static_cast<uint32_t>(welded.size());
+            welded.push_back(p);
+            auto [it, inserted] =
+                cells.emplace(key(cell.x, cell.y, cell.z), match);
+            next.push_back(inserted ? NONE : it->second);
+            it->second = match;
         }
+        remap[i] = match;
     }
-    return u;
+    return welded;
 }
 
 std::pair<glm::vec3, glm::vec3>
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cmath>
+#include <cstdint>
 #include <vector>
 
 #include "glm/glm.hpp"
@@ -25,6 +27,13 @@ bool containsVertex(const std::vector<glm::vec3> &s, const glm::vec3 &v);
 
 std::vector<glm::vec3> uniqueVertices(const std::vector<glm::vec3> &s);
 
+// Merges points closer than tolerance, keeping the first of them like
+// uniqueVertices() does, in O(n) through a hash of grid cells the size of
+// tolerance. remap[i] is where s[i] ended up in the returned points.
+std::vector<glm::vec3> weldVertices(const std::vector<glm::vec3> &s,
+                                    std::vector<uint32_t> &remap,
+                                    float tolerance = std::sqrt(EPSILON));
+
 std::pair<glm::vec3, glm::vec3> extremePoints(const std::vector<glm::vec3> &s);
 std::vector<glm::vec3> minimumBoundingBox(const glm::vec3 &min,
                                           const glm::vec3 &max);
@@ -0,0 +1,402 @@
+#include "primitivecollision.h"
+
+#include <array>
+#include <cfloat>
+#include <cmath>
+
+#include "box.h"
+#include "capsule.h"
+#include "collisionquery.h"
+#include "sphere.h"
+
+namespace {
+void setContact(lix::Collision &collision, const glm::vec3 &point,
+                const glm::vec3 &normal, float depth) {
+    collision.contactPoint = point;
+    collision.normal = normal;
+    collision.penetrationDepth = depth;
+    collision.a = point;
+    collision.b = point;
+    collision.c = point;
+}
+
+// Sphere (p, r) against sphere (q, s), what every pair with a rounded side
+// comes down to once the closest core points are known.
+bool spheres(const glm::vec3 &p, float r, const glm::vec3 &q, float s,
+             lix::Collision &collision) {
+    const glm::vec3 d = p - q;
+    const float radius = r + s;
+    const float d2 = glm::dot(d, d);
+    if (d2 > radius * radius) {
+        return false;
+    }
+    const float distance = std::sqrt(d2);
+    const glm::vec3 normal =
+        distance > FLT_EPSILON ? d / distance : glm::vec3{0.0f, 1.0f, 0.0f};
+    setContact(collision, p - normal * r, normal, radius - distance);
+    return true;
+}
+
+glm::vec3 closestOnSegment(const glm::vec3 &a, const glm::vec3 &b,
+                           const glm::vec3 &p) {
+    const glm::vec3 ab = b - a;
+    const float len2 = glm::dot(ab, ab);
+    if (len2 < FLT_EPSILON) {
+        return a;
+    }
+    return a + ab * glm::clamp(glm::dot(p - a, ab) / len2, 0.0f, 1.0f);
+}
+
+// Closest points c1 on p1q1 and c2 on p2q2, Ericson 5.1.9.
+void closestOnSegments(const glm::vec3 &p1, const glm::vec3 &q1,
+                       const glm::vec3 &p2, const glm::vec3 &q2,
+                       glm::vec3 &c1, glm::vec3 &c2) {
+    const glm::vec3 d1 = q1 - p1;
+    const glm::vec3 d2 = q2 - p2;
+    const glm::vec3 r = p1 - p2;
+    const float a = glm::dot(d1, d1);
+    const float e = glm::dot(d2, d2);
+    const float f = glm::dot(d2, r);
+    float s{0.0f};
+    float t{0.0f};
+    if (a <= FLT_EPSILON && e <= FLT_EPSILON) {
+        c1 = p1;
+        c2 = p2;
+        return;
+    }
+    if (a <= FLT_EPSILON) {
+        t = glm::clamp(f / e, 0.0f, 1.0f);
+    } else {
+        const float c = glm::dot(d1, r);
+        if (e <= FLT_EPSILON) {
+            s = glm::clamp(-c / a, 0.0f, 1.0f);
+        } else {
+            const float b = glm::dot(d1, d2);
+            const float denom = a * e - b * b;
+            if (denom > FLT_EPSILON) {
+                s = glm::clamp((b * f - c * e) / denom, 0.0f, 1.0f);
+            }
+            t = (b * s + f) / e;
+            if (t < 0.0f) {
+                t = 0.0f;
+                s = glm::clamp(-c / a, 0.0f, 1.0f);
+            } else if (t > 1.0f) {
+                t = 1.0f;
+                s = glm::clamp((b - c) / a, 0.0f, 1.0f);
+            }
+        }
+    }
+    c1 = p1 + d1 * s;
+    c2 = p2 + d2 * t;
+}
+
+struct BoxFrame {
+    glm::vec3 center;
+    glm::mat3 axes;
+    glm::vec3 extents;
+
+    explicit BoxFrame(const lix::Box &box)
+        : center{box.center()}, axes{box.axes()}, extents{box.extents()} {}
+
+    glm::vec3 toLocal(const glm::vec3 &p) const {
+        const glm::vec3 d = p - center;
+        return {glm::dot(d, axes[0]), glm::dot(d, axes[1]),
+                glm::dot(d, axes[2])};
+    }
+
+    glm::vec3 closest(const glm::vec3 &p) const {
+        return center + axes * glm::clamp(toLocal(p), -extents, extents);
+    }
+};
+
+// Sphere (p, r) against the box. A center inside the box is pushed out
+// through the nearest face.
+bool sphereInBox(const glm::vec3 &p, float r, const BoxFrame &box,
+                 lix::Collision &collision) {
+    const glm::vec3 local = box.toLocal(p);
+    const glm::vec3 clamped = glm::clamp(local, -box.extents, box.extents);
+    if (clamped != local) {
+        return spheres(p, r, box.center + box.axes * clamped, 0.0f,
+                       collision);
+    }
+    int face{0};
+    float gap{FLT_MAX};
+    for (int i = 0; i < 3; ++i) {
+        const float faceGap = box.extents[i] - std::fabs(local[i]);
+        if (faceGap < gap) {
+            gap = faceGap;
+            face = i;
+        }
+    }
+    const glm::vec3 normal =
+        local[face] < 0.0f ? -box.axes[face] : box.axes[face];
+    setContact(collision, p - normal * r, normal, r + gap);
+    return true;
+}
+
+bool sphereSphere(lix::Shape &a, lix::Shape &b, lix::Collision &collision) {
+    auto &sa = static_cast<lix::Sphere &>(a);
+    auto &sb = static_cast<lix::Sphere &>(b);
+    return spheres(sa.center(), sa.worldRadius(), sb.center(),
+                   sb.worldRadius(), collision);
+}
+
+bool sphereCapsule(lix::Shape &a, lix::Shape &b, lix::Collision &collision) {
+    auto &sphere = static_cast<lix::Sphere &>(a);
+    auto &capsule = static_cast<lix::Capsule &>(b);
+    const glm::vec3 p = sphere.center();
+    return spheres(p, sphere.worldRadius(),
+                   closestOnSegment(capsule.worldA(), capsule.worldB(), p),
+                   capsule.worldRadius(), collision);
+}
+
+bool sphereBox(lix::Shape &a, lix::Shape &b, lix::Collision &collision) {
+    auto &sphere = static_cast<lix::Sphere &>(a);
+    return sphereInBox(sphere.center(), sphere.worldRadius(),
+                       BoxFrame{static_cast<lix::Box &>(b)}, collision);
+}
+
+bool capsuleCapsule(lix::Shape &a, lix::Shape &b, lix::Collision &collision) {
+    auto &ca = static_cast<lix::Capsule &>(a);
+    auto &cb = static_cast<lix::Capsule &>(b);
+    glm::vec3 pa;
+    glm::vec3 pb;
+    closestOnSegments(ca.worldA(), ca.worldB(), cb.worldA(), cb.worldB(), pa,
+                      pb);
+    return spheres(pa, ca.worldRadius(), pb, cb.worldRadius(), collision);
+}
+
+// Parameter of the point on ab closest to the box. The squared distance is
+// convex, and quadratic between the points where ab crosses a face plane, so
+// the minimum is the stationary point of one of those pieces or an end of it.
+float closestToBox(const glm::vec3 &a, const glm::vec3 &b,
+                   const BoxFrame &box) {
+    const glm::vec3 l0 = box.toLocal(a);
+    const glm::vec3 dl = box.toLocal(b) - l0;
+    std::array<float, 8> cuts;
+    size_t numCuts{0};
+    cuts[numCuts++] = 0.0f;
+    for (int i = 0; i < 3; ++i) {
+        if (std::fabs(dl[i]) < FLT_EPSILON) {
+            continue;
+        }
+        for (float plane : {-box.extents[i], box.extents[i]}) {
+            const float t = (plane - l0[i]) / dl[i];
+            if (t > 0.0f && t < 1.0f) {
+                // Kept sorted, there are at most six.
+                size_t k{numCuts++};
+                for (; cuts[k - 1] > t; --k) {
+                    cuts[k] = cuts[k - 1];
+                }
+                cuts[k] = t;
+            }
+        }
+    }
+    cuts[numCuts++] = 1.0f;
+    auto distance2 = [&](float t) {
+        const glm::vec3 p = l0 + dl * t;
+        const glm::vec3 outside =
+            p - glm::clamp(p, -box.extents, box.extents);
+        return glm::dot(outside, outside);
+    };
+    float closest{0.0f};
+    float closestDistance2{distance2(0.0f)};
+    for (size_t k{1}; k < numCuts; ++k) {
+        const float t0 = cuts[k - 1];
+        const float t1 = cuts[k];
+        const glm::vec3 mid = l0 + dl * (0.5f * (t0 + t1));
+        float numerator{0.0f};
+        float denominator{0.0f};
+        for (int i = 0; i < 3; ++i) {
+            if (std::fabs(mid[i]) > box.extents[i]) {
+                const float plane =
+                    mid[i] < 0.0f ? -box.extents[i] : box.extents[i];
+                numerator += dl[i] * (plane - l0[i]);
+                denominator += dl[i] * dl[i];
+            }
+        }
+        const float t = denominator > FLT_EPSILON
+                            ? glm::clamp(numerator / denominator, t0, t1)
+                            : t0;
+        const float d2 = distance2(t);
+        if (d2 < closestDistance2) {
+            closest = t;
+            closestDistance2 = d2;
+        }
+    }
+    return closest;
+}
+
+// A capsule whose segment stays outside the box is a sphere at the closest
+// segment point. One whose segment goes into the box is pushed out along the
+// least overlapping of the box face normals and the segment crossed with
+// them.
+bool capsuleBox(lix::Shape &a, lix::Shape &b, lix::Collision &collision) {
+    auto &capsule = static_cast<lix::Capsule &>(a);
+    const BoxFrame box{static_cast<lix::Box &>(b)};
+    const glm::vec3 A = capsule.worldA();
+    const glm::vec3 B = capsule.worldB();
+    const float radius = capsule.worldRadius();
+    const glm::vec3 p = A + (B - A) * closestToBox(A, B, box);
+    const glm::vec3 q = box.closest(p);
+    const glm::vec3 pq = p - q;
+    if (glm::dot(pq, pq) > 1e-8f) {
+        return spheres(p, radius, q, 0.0f, collision);
+    }
+
+    const glm::vec3 halfSegment = (B - A) * 0.5f;
+    const glm::vec3 t = A + halfSegment - box.center;
+    glm::vec3 normal{0.0f, 1.0f, 0.0f};
+    float depth{FLT_MAX};
+    auto overlap = [&](glm::vec3 axis) {
+        const float len2 = glm::dot(axis, axis);
+        if (len2 < 1e-8f) {
+            return;
+        }
+        axis /= std::sqrt(len2);
+        float r = std::fabs(glm::dot(halfSegment, axis));
+        for (int k = 0; k < 3; ++k) {
+            r += box.extents[k] * std::fabs(glm::dot(box.axes[k], axis));
+        }
+        const float d = glm::dot(t, axis);
+        if (r - std::fabs(d) < depth) {
+            depth = r - std::fabs(d);
+            normal = d < 0.0f ? -axis : axis;
+        }
+    };
+    for (int i = 0; i < 3; ++i) {
+        overlap(box.axes[i]);
+        overlap(glm::cross(halfSegment, box.axes[i]));
+    }
+    setContact(collision, capsule.supportPoint(-normal), normal,
+               depth + radius);
+    return true;
+}
+
+// Separating axis test over the 3 + 3 face normals and the 9 edge cross
+// products, the contact is on the axis of least overlap.
+bool boxBox(lix::Shape &a, lix::Shape &b, lix::Collision &collision) {
+    auto &boxA = static_cast<lix::Box &>(a);
+    auto &boxB = static_cast<lix::Box &>(b);
+    const BoxFrame fa{boxA};
+    const BoxFrame fb{boxB};
+    const glm::vec3 t = fa.center - fb.center;
+
+    enum class Feature { FaceA, FaceB, Edges };
+    Feature feature{Feature::FaceA};
+    int edgeA{0};
+    int edgeB{0};
+    glm::vec3 normal{0.0f, 1.0f, 0.0f};
+    float depth{FLT_MAX};
+    float score{FLT_MAX};
+    auto separates = [&](glm::vec3 axis, Feature f, int i, int j) {
+        const float len2 = glm::dot(axis, axis);
+        if (len2 < 1e-8f) {
+            return false; // parallel edges, covered by the face axes
+        }
+        axis /= std::sqrt(len2);
+        float r{0.0f};
+        for (int k = 0; k < 3; ++k) {
+            r += fa.extents[k] * std::fabs(glm::dot(fa.axes[k], axis)) +
+                 fb.extents[k] * std::fabs(glm::dot(fb.axes[k], axis));
+        }
+        const float d = glm::dot(t, axis);
+        const float overlap = r - std::fabs(d);
+        if (overlap < 0.0f) {
+            return true;
+        }
+        // Face contacts are steadier, an edge axis has to be clearly better.
+        const float s = f == Feature::Edges ? overlap * 1.02f + 1e-3f : overlap;
+        if (s < score) {
+            score = s;
+            depth = overlap;
+            normal = d < 0.0f ? -axis : axis;
+            feature = f;
+            edgeA = i;
+            edgeB = j;
+        }
+        return false;
+    };
+    for (int i = 0; i < 3; ++i) {
+        if (separates(fa.axes[i], Feature::FaceA, i, 0) ||
+            separates(fb.axes[i], Feature::FaceB, 0, i)) {
+            return false;
+        }
+    }
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            if (separates(glm::cross(fa.axes[i], fb.axes[j]), Feature::Edges,
+                          i, j)) {
+                return false;
+            }
+        }
+    }
+
+    glm::vec3 point;
+    if (feature == Feature::FaceB) {
+        point = boxA.supportPoint(-normal);
+    } else if (feature == Feature::FaceA) {
+        point = boxB.supportPoint(normal) - normal * depth;
+    } else {
+        // The edge of each box that reaches furthest into the other.
+        auto edge = [](const BoxFrame &box, int i, const glm::vec3 &dir,
+                       glm::vec3 &from, glm::vec3 &to) {
+            glm::vec3 mid = box.center;
+            for (int k = 0; k < 3; ++k) {
+                if (k != i) {
+                    const float e = box.extents[k];
+                    mid += box.axes[k] *
+                           (glm::dot(box.axes[k], dir) > 0.0f ? e : -e);
+                }
+            }
+            from = mid - box.axes[i] * box.extents[i];
+            to = mid + box.axes[i] * box.extents[i];
+        };
+        glm::vec3 a0, a1, b0, b1, pb;
+        edge(fa, edgeA, -normal, a0, a1);
+        edge(fb, edgeB, normal, b0, b1);
+        closestOnSegments(a0, a1, b0, b1, point, pb);
+    }
+    setContact(collision, point, normal, depth);
+    return true;
+}
+
+// The table only holds one order of each pair, the other one swaps the
+// shapes and turns the contact around.
+template <lix::PrimitiveContact Contact>
+bool swapped(lix::Shape &a, lix::Shape &b, lix::Collision &collision) {
+    if (!Contact(b, a, collision)) {
+        return false;
+    }
+    setContact(collision,
+               collision.contactPoint +
+                   collision.normal * collision.penetrationDepth,
+               -collision.normal, collision.penetrationDepth);
+    return true;
+}
+
+constexpr size_t NUM_TYPES{static_cast<size_t>(lix::ShapeType::Count)};
+
+// Rows are a's type, columns b's, in lix::ShapeType order.
+const lix::PrimitiveContact contactTable[NUM_TYPES][NUM_TYPES]{
+    {nullptr, nullptr, nullptr, nullptr},
+    {nullptr, sphereSphere, sphereCapsule, sphereBox},
+    {nullptr, swapped<sphereCapsule>, capsuleCapsule, capsuleBox},
+    {nullptr, swapped<sphereBox>, swapped<capsuleBox>, boxBox},
+};
+} // namespace
+
+lix::PrimitiveContact lix::primitiveContact(const lix::Shape &a,
+                                            const lix::Shape &b) {
+    return contactTable[static_cast<size_t>(a.type())]
+                       [static_cast<size_t>(b.type())];
+}
+
+bool lix::overlaps(lix::Shape &a, lix::Shape &b) {
+    if (lix::PrimitiveContact contact = primitiveContact(a, b)) {
+        lix::Collision collision;
+        return contact(a, b, collision);
+    }
+    thread_local lix::CollisionQuery query;
+    return query.intersects(a, b, lix::seedDirection(a, b));
+}
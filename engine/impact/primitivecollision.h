@@ -0,0 +1,21 @@
+#pragma once
+
+#include "collision.h"
+#include "shape.h"
+
+namespace lix {
+// Closed form contact between two primitive shapes, filled in the way
+// CollisionQuery::collides() does: normal from b to a, contactPoint the
+// deepest point of a. Returns whether the shapes collide.
+using PrimitiveContact = bool (*)(lix::Shape &a, lix::Shape &b,
+                                  lix::Collision &collision);
+
+// Looks the pair up in a table by Shape::type(). nullptr when there is no
+// closed form for it, the pair is then left to GJK/EPA.
+lix::PrimitiveContact primitiveContact(const lix::Shape &a,
+                                       const lix::Shape &b);
+
+// Whether a and b overlap, in closed form when primitiveContact() has the
+// pair, otherwise by GJK.
+bool overlaps(lix::Shape &a, lix::Shape &b);
+} // namespace lix
@@ -1,11 +1,11 @@
 #include "quickhull.h"
 
 #include <algorithm>
+#include <cfloat>
+#include <cmath>
 
 #include "primer.h"
 
-#include "glm/gtc/random.hpp"
-
 float distanceFromLine(const glm::vec3 &a, const glm::vec3 &b,
                        const glm::vec3 &p) {
     // TODO: Optimize (not needing actual distance)
@@ -100,99 +100,290 @@ void lix::quickHull(const std::vector<glm::vec3> &s,
               });
 }
 
-glm::vec3 popAlongDirection(std::vector<glm::vec3> &s, const glm::vec3 &D) {
-    auto [i, distance] = lix::indexAlongDirection(s, D);
-    glm::vec3 rval = s[i];
-    s.erase(s.begin() + i);
-    return rval;
+uint32_t lix::QuickHull::addFace(uint32_t a, uint32_t b, uint32_t c) {
+    uint32_t face;
+    if (_freeFaces.empty()) {
+        face = static_cast<uint32_t>(_faces.size());
+        _faces.emplace_back();
+    } else {
+        face = _freeFaces.back();
+        _freeFaces.pop_back();
+    }
+    uint32_t edges[3];
+    for (uint32_t &edge : edges) {
+        if (_freeEdges.empty()) {
+            edge = static_cast<uint32_t>(_edges.size());
+            _edges.emplace_back();
+        } else {
+            edge = _freeEdges.back();
+            _freeEdges.pop_back();
+        }
+    }
+    const uint32_t vertices[3]{a, b, c};
+    for (int i = 0; i < 3; ++i) {
+        _edges[edges[i]] = {vertices[i], face, edges[(i + 1) % 3], NONE};
+    }
+    const std::vector<glm::vec3> &points = *_points;
+    const glm::vec3 n =
+        glm::cross(points[b] - points[a], points[c] - points[a]);
+    const float length = glm::length(n);
+    // A sliver has no direction to speak of, nothing will be outside it.
+    const glm::vec3 normal = length > FLT_MIN ? n / length : glm::vec3{0.0f};
+    _faces[face] = {normal, glm::dot(normal, points[a]), edges[0], NONE, NONE,
+                    0.0f,   false,  false};
+    return face;
 }
 
-// assumes s is centered around the origin
-void lix::quick_hull(const std::vector<glm::vec3> &points,
-                     std::vector<glm::vec3> &vertices,
-                     std::vector<unsigned int> &faces) {
-    std::vector<glm::vec3> P{points.begin(), points.end()};
-
-    // float BIG = 1.0e32f;
-    glm::vec3 dir = glm::ballRand(1.0f);
-    glm::vec3 A = popAlongDirection(P, dir);
-    glm::vec3 B = popAlongDirection(P, -A);
-
-    glm::vec3 AB = B - A;
-    float t = -(glm::dot(AB, A) / glm::dot(AB, AB));
-    glm::vec3 r = A + AB * t;
-
-    assert(glm::dot(r, r) > 0);
-
-    glm::vec3 C = popAlongDirection(P, -r);
-
-    glm::vec3 AC = C - A;
-    glm::vec3 ABC = glm::cross(AB, AC);
-
-    if (glm::dot(ABC, -A) > 0) {
-        std::swap(B, C);
-        std::swap(AC, AB);
-        ABC = -ABC;
+void lix::QuickHull::removeFace(uint32_t face) {
+    uint32_t edge = _faces[face].edge;
+    for (int i = 0; i < 3; ++i) {
+        _freeEdges.push_back(edge);
+        edge = _edges[edge].next;
     }
+    _faces[face].deleted = true;
+    _freeFaces.push_back(face);
+}
 
-    glm::vec3 D = popAlongDirection(P, -ABC);
-
-    // const glm::vec3 AD = D - A;
-    // const glm::vec3 ABD = glm::cross(AB, AD);
-
-    vertices.insert(vertices.end(), {A, B, C, D});
-
-    faces.insert(faces.end(), {
-                                  0, 1, 2, // ABC
-                                  0, 2, 3, // ACD
-                                  0, 3, 1, // ADB
-                                  1, 3, 2  // BDC
-                              });
+void lix::QuickHull::assign(uint32_t point, const uint32_t *faces,
+                            size_t numFaces) {
+    const glm::vec3 &p = (*_points)[point];
+    uint32_t best{NONE};
+    float bestDistance{_tolerance};
+    for (size_t i{0}; i < numFaces; ++i) {
+        const float d = distance(faces[i], p);
+        if (d > bestDistance) {
+            best = faces[i];
+            bestDistance = d;
+        }
+    }
+    if (best == NONE) {
+        return; // inside, for good
+    }
+    Face &face = _faces[best];
+    _next[point] = face.conflicts;
+    face.conflicts = point;
+    if (face.furthest == NONE || bestDistance > face.furthestDistance) {
+        face.furthest = point;
+        face.furthestDistance = bestDistance;
+    }
+}
 
-    std::vector<glm::vec3> normals;
+// Depth first over the faces eye sees, leaving the edges between a visible
+// and a hidden face in _horizon, in order around the hole. Any face the eye
+// is in front of goes, not only those past the tolerance, so a nearly
+// coplanar face is replaced rather than left to make a reflex edge.
+void lix::QuickHull::findHorizon(uint32_t eye, uint32_t crossed,
+                                 uint32_t face) {
+    _faces[face].visible = true;
+    _visible.push_back(face);
+    const uint32_t start =
+        crossed == NONE ? _faces[face].edge : _edges[crossed].next;
+    uint32_t edge{start};
+    do {
+        const uint32_t twin = _edges[edge].twin;
+        const uint32_t neighbour = _edges[twin].face;
+        if (!_faces[neighbour].visible) {
+            if (distance(neighbour, (*_points)[eye]) > 0.0f) {
+                findHorizon(eye, twin, neighbour);
+            } else {
+                _horizon.push_back(edge);
+            }
+        }
+        edge = _edges[edge].next;
+    } while (edge != start);
+}
 
-    for (size_t f{0UL}; f < faces.size(); f += 3UL) {
-        const glm::vec3 &U = vertices.at(faces.at(f));
-        const glm::vec3 &V = vertices.at(faces.at(f + 1));
-        const glm::vec3 &W = vertices.at(faces.at(f + 2));
-        normals.push_back(glm::cross(V - U, W - U));
+void lix::QuickHull::addVertex(uint32_t face) {
+    const uint32_t eye = _faces[face].furthest;
+    _horizon.clear();
+    _visible.clear();
+    findHorizon(eye, NONE, face);
+
+    // A fan of faces from the eye to the horizon, each sharing its first
+    // edge with the hidden face beyond it and its sides with its neighbours.
+    _newFaces.clear();
+    for (uint32_t edge : _horizon) {
+        const uint32_t from = _edges[edge].vertex;
+        const uint32_t to = _edges[_edges[edge].next].vertex;
+        const uint32_t twin = _edges[edge].twin;
+        const uint32_t added = addFace(from, to, eye);
+        const uint32_t base = _faces[added].edge;
+        _edges[base].twin = twin;
+        _edges[twin].twin = base;
+        _newFaces.push_back(added);
+    }
+    for (size_t i{0}; i < _newFaces.size(); ++i) {
+        const uint32_t previous =
+            _newFaces[i == 0 ? _newFaces.size() - 1 : i - 1];
+        const uint32_t toEye = _edges[_faces[previous].edge].next;
+        const uint32_t eyeFrom =
+            _edges[_edges[_faces[_newFaces[i]].edge].next].next;
+        _edges[toEye].twin = eyeFrom;
+        _edges[eyeFrom].twin = toEye;
     }
 
-    std::vector<unsigned int> Q = {0, 1, 2, 3};
+    for (uint32_t visible : _visible) {
+        for (uint32_t point = _faces[visible].conflicts; point != NONE;) {
+            const uint32_t next = _next[point];
+            if (point != eye) {
+                assign(point, _newFaces.data(), _newFaces.size());
+            }
+            point = next;
+        }
+        removeFace(visible);
+    }
+    for (uint32_t added : _newFaces) {
+        if (_faces[added].conflicts != NONE) {
+            _pending.push_back(added);
+        }
+    }
+}
 
-    while (!Q.empty()) {
-        auto face = Q.front();
-        Q.erase(Q.begin());
+bool lix::QuickHull::build(const std::vector<glm::vec3> &points) {
+    _points = &points;
+    _edges.clear();
+    _faces.clear();
+    _freeEdges.clear();
+    _freeFaces.clear();
+    _pending.clear();
+    _vertices.clear();
+    _indices.clear();
+    const uint32_t n = static_cast<uint32_t>(points.size());
+    if (n < 4) {
+        return false;
+    }
 
-        int pIdx = -1;
-        float pVal = 0.0f;
-        for (size_t i{0UL}; i < P.size(); ++i) {
-            float val = glm::dot(normals[face], P[i]);
-            if (val > pVal) {
-                pVal = val;
-                pIdx = static_cast<int>(i);
+    // Extremes along the axes, they also scale the tolerance.
+    uint32_t lowest[3]{0, 0, 0};
+    uint32_t highest[3]{0, 0, 0};
+    glm::vec3 largest{0.0f};
+    for (uint32_t i{0}; i < n; ++i) {
+        for (int k = 0; k < 3; ++k) {
+            if (points[i][k] < points[lowest[k]][k]) {
+                lowest[k] = i;
+            }
+            if (points[i][k] > points[highest[k]][k]) {
+                highest[k] = i;
             }
         }
-        if (pIdx < 0) {
-            continue;
+        largest = glm::max(largest, glm::abs(points[i]));
+    }
+    _tolerance = 3.0f * FLT_EPSILON * (largest.x + largest.y + largest.z);
+
+    // The initial tetrahedron: the widest pair of extremes, the point
+    // furthest from their line and the one furthest from that plane.
+    uint32_t a{lowest[0]};
+    uint32_t b{highest[0]};
+    float widest{-1.0f};
+    for (int k = 0; k < 3; ++k) {
+        const glm::vec3 d = points[highest[k]] - points[lowest[k]];
+        if (glm::dot(d, d) > widest) {
+            widest = glm::dot(d, d);
+            a = lowest[k];
+            b = highest[k];
         }
-        std::vector<unsigned int> visibleFaces;
-        std::vector<unsigned int> invisibleFaces;
-        const auto numFaces = (faces.size() / 3UL);
-        for (size_t i{0UL}; i < numFaces; ++i) {
-            if (glm::dot(normals[i], P[pIdx]) > 0) {
-                visibleFaces.push_back(static_cast<unsigned int>(i));
-            } else {
-                invisibleFaces.push_back(static_cast<unsigned int>(i));
-            }
+    }
+    if (widest <= _tolerance * _tolerance) {
+        return false;
+    }
+    uint32_t c{a};
+    float furthest{0.0f};
+    const glm::vec3 ab = points[b] - points[a];
+    for (uint32_t i{0}; i < n; ++i) {
+        const glm::vec3 off = glm::cross(points[i] - points[a], ab);
+        if (glm::dot(off, off) > furthest) {
+            furthest = glm::dot(off, off);
+            c = i;
+        }
+    }
+    if (std::sqrt(furthest) <= _tolerance * std::sqrt(widest)) {
+        return false;
+    }
+    const glm::vec3 normal =
+        glm::normalize(glm::cross(ab, points[c] - points[a]));
+    uint32_t d{a};
+    float height{0.0f};
+    for (uint32_t i{0}; i < n; ++i) {
+        const float h = glm::dot(normal, points[i] - points[a]);
+        if (std::fabs(h) > std::fabs(height)) {
+            height = h;
+            d = i;
         }
-        for (unsigned int visible : visibleFaces) {
-            for (unsigned int invisible : invisibleFaces) {
-                Edge e;
-                if (lix::isAdjacent(&faces[visible * 3], &faces[invisible * 3],
-                                    e)) {
+    }
+    if (std::fabs(height) <= _tolerance) {
+        return false;
+    }
+    if (height > 0.0f) {
+        std::swap(b, c); // d goes behind abc
+    }
+
+    const uint32_t initial[4]{addFace(a, b, c), addFace(a, c, d),
+                              addFace(a, d, b), addFace(b, d, c)};
+    for (uint32_t f : initial) {
+        for (uint32_t g : initial) {
+            uint32_t e = _faces[f].edge;
+            for (int i = 0; i < 3; ++i, e = _edges[e].next) {
+                uint32_t o = _faces[g].edge;
+                for (int j = 0; j < 3; ++j, o = _edges[o].next) {
+                    if (_edges[e].vertex == _edges[_edges[o].next].vertex &&
+                        _edges[o].vertex == _edges[_edges[e].next].vertex) {
+                        _edges[e].twin = o;
+                    }
                 }
             }
         }
     }
-}
\ No newline at end of file
+    _next.assign(n, NONE);
+    for (uint32_t i{0}; i < n; ++i) {
+        if (i != a && i != b && i != c && i != d) {
+            assign(i, initial, 4);
+        }
+    }
+    for (uint32_t f : initial) {
+        if (_faces[f].conflicts != NONE) {
+            _pending.push_back(f);
+        }
+    }
+
+    while (!_pending.empty()) {
+        const uint32_t face = _pending.back();
+        _pending.pop_back();
+        // Faces that went away, or were pooled and came back empty.
+        if (!_faces[face].deleted && _faces[face].conflicts != NONE) {
+            addVertex(face);
+        }
+    }
+
+    std::vector<uint32_t> &remap = _next;
+    remap.assign(n, NONE);
+    for (const Face &face : _faces) {
+        if (face.deleted) {
+            continue;
+        }
+        uint32_t edge = face.edge;
+        for (int i = 0; i < 3; ++i, edge = _edges[edge].next) {
+            uint32_t &index = remap[_edges[edge].vertex];
+            if (index == NONE) {
+                index = static_cast<uint32_t>(_vertices.size());
+                _vertices.push_back(points[_edges[edge].vertex]);
+            }
+            _indices.push_back(index);
+        }
+    }
+    return true;
+}
+
+void lix::quick_hull(const std::vector<glm::vec3> &points,
+                     std::vector<glm::vec3> &vertices,
+                     std::vector<unsigned int> &faces) {
+    thread_local lix::QuickHull hull;
+    if (!hull.build(points)) {
+        return;
+    }
+    const unsigned int offset = static_cast<unsigned int>(vertices.size());
+    vertices.insert(vertices.end(), hull.vertices().begin(),
+                    hull.vertices().end());
+    for (uint32_t index : hull.indices()) {
+        faces.push_back(offset + index);
+    }
+}
@@ -1,11 +1,75 @@
 #pragma once
 
 #include "glm/glm.hpp"
+#include <cstdint>
 #include <vector>
 
 namespace lix {
+// 3D QuickHull with a conflict list per face: every point outside the hull
+// waits on one face, and only the points of the faces a new vertex sees are
+// looked at again. A point has to be in front of a face by more than a
+// tolerance scaled to the cloud to count as outside, so nearly coplanar points
+// don't fold the hull. Faces and half edges come from pools that keep their
+// storage between builds, keep one builder around when building many hulls.
+class QuickHull {
+  public:
+    // False, with no output, when the points don't span a volume.
+    bool build(const std::vector<glm::vec3> &points);
+
+    // Hull vertices, and triangles counter clockwise seen from outside.
+    const std::vector<glm::vec3> &vertices() const { return _vertices; }
+
+    const std::vector<uint32_t> &indices() const { return _indices; }
+
+  private:
+    static constexpr uint32_t NONE{UINT32_MAX};
+
+    struct HalfEdge {
+        uint32_t vertex; // the point it leaves from
+        uint32_t face;
+        uint32_t next;
+        uint32_t twin;
+    };
+
+    struct Face {
+        glm::vec3 normal;
+        float offset;
+        uint32_t edge;
+        uint32_t conflicts; // first point of the list threaded by _next
+        uint32_t furthest;
+        float furthestDistance;
+        bool visible;
+        bool deleted;
+    };
+
+    float distance(uint32_t face, const glm::vec3 &p) const {
+        return glm::dot(_faces[face].normal, p) - _faces[face].offset;
+    }
+
+    uint32_t addFace(uint32_t a, uint32_t b, uint32_t c);
+    void removeFace(uint32_t face);
+    void assign(uint32_t point, const uint32_t *faces, size_t numFaces);
+    void findHorizon(uint32_t eye, uint32_t crossed, uint32_t face);
+    void addVertex(uint32_t face);
+
+    const std::vector<glm::vec3> *_points{nullptr};
+    float _tolerance{0.0f};
+    std::vector<HalfEdge> _edges;
+    std::vector<Face> _faces;
+    std::vector<uint32_t> _freeEdges;
+    std::vector<uint32_t> _freeFaces;
+    std::vector<uint32_t> _next;
+    std::vector<uint32_t> _pending;
+    std::vector<uint32_t> _horizon;
+    std::vector<uint32_t> _visible;
+    std::vector<uint32_t> _newFaces;
+    std::vector<glm::vec3> _vertices;
+    std::vector<uint32_t> _indices;
+};
+
 void quickHull(const std::vector<glm::vec3> &s, std::vector<glm::vec3> &ch);
 
+// Appends the hull of points to vertices and indices.
 void quick_hull(const std::vector<glm::vec3> &points,
                 std::vector<glm::vec3> &vertices,
                 std::vector<unsigned int> &indices);
@@ -25,5 +25,13 @@ struct DynamicBody : RigidBody {
     glm::mat3 inertiaTensor_inv;
     glm::vec3 velocity;
     glm::vec3 angularVelocity;
+    // Sweeps the motion of each step against static bodies and stops at the
+    // first contact, so fast bodies don't pass through thin geometry.
+    bool continuous{false};
+    // Set by PhysicsEngine::step once the body and everything touching it
+    // have been slow for a while, it's then left out of the step. Give a
+    // sleeping body a velocity to wake it and everything touching it.
+    bool sleeping{false};
+    float sleepTime{0.0f}; // seconds below the sleep thresholds
 };
 } // namespace lix
\ No newline at end of file
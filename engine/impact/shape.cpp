@@ -4,7 +4,14 @@ lix::Shape::Shape(lix::TRS *trs) : _trs{trs} {}
 
 lix::Shape::Shape(const lix::Shape &other)
     : _trs{other._trs},
-      _simplified{other._simplified ? other._simplified->clone() : nullptr} {}
+      _simplified{other._simplified ? other._simplified->clone() : nullptr} {
+    for (const auto &positive : other._positives) {
+        _positives.emplace_back(positive->clone());
+    }
+    for (const auto &negative : other._negatives) {
+        _negatives.emplace_back(negative->clone());
+    }
+}
 
 lix::Shape::~Shape() noexcept { _simplified.reset(); }
 
@@ -14,6 +21,22 @@ void lix::Shape::setSimplified(std::shared_ptr<lix::Shape> simplified) {
 
 lix::Shape *lix::Shape::simplified() { return _simplified.get(); }
 
+lix::Bounds lix::Shape::bounds() {
+    if (_simplified) {
+        return _simplified->bounds();
+    }
+    return supportBounds();
+}
+
+lix::Bounds lix::Shape::supportBounds() {
+    return {{supportPoint({-1.0f, 0.0f, 0.0f}).x,
+             supportPoint({0.0f, -1.0f, 0.0f}).y,
+             supportPoint({0.0f, 0.0f, -1.0f}).z},
+            {supportPoint({1.0f, 0.0f, 0.0f}).x,
+             supportPoint({0.0f, 1.0f, 0.0f}).y,
+             supportPoint({0.0f, 0.0f, 1.0f}).z}};
+}
+
 bool lix::Shape::test(lix::Shape &shape) {
     bool anyPositive = doTest(shape);
     if (!anyPositive) {
@@ -1,12 +1,18 @@
 #pragma once
 
+#include "bounds.h"
 #include "glm/glm.hpp"
 #include "gltrs.h"
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <vector>
 
 namespace lix {
+// What the narrow phase knows about a shape. Convex shapes only offer support
+// points, the others also have a closed form contact test.
+enum class ShapeType { Convex, Sphere, Capsule, Box, Count };
+
 class Shape {
   public:
     Shape(lix::TRS *trs);
@@ -20,7 +26,20 @@ class Shape {
 
     virtual ~Shape() noexcept;
 
+    virtual lix::ShapeType type() const { return lix::ShapeType::Convex; }
+
     virtual glm::vec3 supportPoint(const glm::vec3 &dir) = 0;
+    // Same, for a caller asking along nearby directions. Shapes that search
+    // a vertex graph start at hint and leave the vertex found there, the
+    // others ignore it. The caller keeps one hint per shape.
+    virtual glm::vec3 hintedSupportPoint(const glm::vec3 &dir, uint32_t &) {
+        return supportPoint(dir);
+    }
+    // World space bounds, by default those of the simplified shape when there
+    // is one, otherwise from the support points along the axes.
+    virtual lix::Bounds bounds();
+    // World space bounds from the support points along the axes only.
+    lix::Bounds supportBounds();
 
     virtual bool intersects(class Capsule &sphere) = 0;
     virtual bool intersects(class Sphere &sphere) = 0;
@@ -42,6 +61,10 @@ class Shape {
         _negatives.push_back(negative);
     }
 
+    const std::vector<std::shared_ptr<Shape>> &positives() const {
+        return _positives;
+    }
+
     lix::TRS *trs() const { return _trs; }
 
     void setTRS(lix::TRS *trs) {
@@ -49,6 +72,12 @@ class Shape {
         if (_simplified) {
             _simplified->setTRS(trs);
         }
+        for (auto &positive : _positives) {
+            positive->setTRS(trs);
+        }
+        for (auto &negative : _negatives) {
+            negative->setTRS(trs);
+        }
     }
 
   protected:
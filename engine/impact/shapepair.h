@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <utility>
+
+namespace lix {
+class Shape;
+
+// Key for state kept per pair of shapes between steps.
+using ShapePair = std::pair<const lix::Shape *, const lix::Shape *>;
+
+struct ShapePairHash {
+    size_t operator()(const ShapePair &pair) const {
+        std::hash<const lix::Shape *> hasher;
+        size_t seed = hasher(pair.first);
+        seed ^= hasher(pair.second) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+        return seed;
+    }
+};
+} // namespace lix
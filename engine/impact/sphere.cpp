@@ -1,21 +1,79 @@
 #include "sphere.h"
 
-#include <stdexcept>
+#include <algorithm>
+#include <cmath>
 
 #include "aabb.h"
 #include "capsule.h"
+#include "polygon.h"
+#include "primitivecollision.h"
 
 lix::Sphere::Sphere(const lix::Sphere &other)
-    : Shape{other}, _radii{other._radii} {}
+    : Shape{other}, _radii{other._radii}, _center{other._center},
+      _fitted{other._fitted} {}
 
 lix::Sphere::Sphere(lix::TRS *trs, float radii) : Shape{trs}, _radii{radii} {}
 
+lix::Sphere::Sphere(lix::TRS *trs, const lix::Polygon &polygon)
+    : Shape{trs}, _fitted{true} {
+    // Ritter's sphere: start from a far apart pair of points and grow to
+    // take in any point left outside.
+    const std::vector<glm::vec3> &points = polygon.points();
+    auto furthest = [&points](const glm::vec3 &from) {
+        float d2{-1.0f};
+        glm::vec3 p{from};
+        for (const glm::vec3 &q : points) {
+            const glm::vec3 d = q - from;
+            if (glm::dot(d, d) > d2) {
+                d2 = glm::dot(d, d);
+                p = q;
+            }
+        }
+        return p;
+    };
+    const glm::vec3 a = furthest(points.front());
+    const glm::vec3 b = furthest(a);
+    _center = (a + b) * 0.5f;
+    _radii = glm::length(b - a) * 0.5f;
+    for (const glm::vec3 &p : points) {
+        const float d = glm::length(p - _center);
+        if (d > _radii) {
+            const float radius = (_radii + d) * 0.5f;
+            _center += (p - _center) * ((radius - _radii) / d);
+            _radii = radius;
+        }
+    }
+}
+
 lix::Sphere::~Sphere() noexcept {}
 
 lix::Sphere *lix::Sphere::clone() const { return new lix::Sphere(*this); }
 
+glm::vec3 lix::Sphere::center() const {
+    if (!_fitted) {
+        return _trs->translation();
+    }
+    return _trs->translation() +
+           glm::mat3(_trs->rotationMatrix()) * (_center * _trs->scale());
+}
+
+float lix::Sphere::worldRadius() const {
+    if (!_fitted) {
+        return _radii;
+    }
+    const glm::vec3 &scale = _trs->scale();
+    return _radii * std::max(std::max(std::fabs(scale.x), std::fabs(scale.y)),
+                             std::fabs(scale.z));
+}
+
 glm::vec3 lix::Sphere::supportPoint(const glm::vec3 &dir) {
-    return trs()->translation() + glm::normalize(dir) * _radii;
+    return center() + glm::normalize(dir) * worldRadius();
+}
+
+lix::Bounds lix::Sphere::bounds() {
+    const glm::vec3 c = center();
+    const glm::vec3 r{worldRadius()};
+    return {c - r, c + r};
 }
 
 bool lix::Sphere::intersects(lix::Capsule &capsule) {
@@ -23,17 +81,17 @@ bool lix::Sphere::intersects(lix::Capsule &capsule) {
 }
 
 bool lix::Sphere::intersects(Sphere &sphere) {
-    glm::vec3 delta = trs()->translation() - sphere.trs()->translation();
+    glm::vec3 delta = center() - sphere.center();
     float d2 = glm::dot(delta, delta);
-    float srad = _radii + sphere._radii;
+    float srad = worldRadius() + sphere.worldRadius();
     float r2 = srad * srad;
     return d2 <= r2;
 }
 
 bool lix::Sphere::intersects(lix::AABB &aabb) { return aabb.intersects(*this); }
 
-bool lix::Sphere::intersects(Polygon & /*polygon*/) {
-    throw std::runtime_error("sphere-polygon collision not implemented");
+bool lix::Sphere::intersects(Polygon &polygon) {
+    return lix::overlaps(*this, polygon);
 }
 
 bool lix::Sphere::doTest(Shape &shape) { return shape.intersects(*this); }
\ No newline at end of file
@@ -7,12 +7,21 @@ class Sphere : public Shape {
   public:
     Sphere(const Sphere &other);
     Sphere(lix::TRS *trs, float radii);
+    // Encloses the polygon's local points. Unlike a plain sphere it is
+    // centered off the translation and scales with the TRS, so it follows
+    // any transform without a refit.
+    Sphere(lix::TRS *trs, const class Polygon &polygon);
 
     virtual ~Sphere() noexcept;
 
     virtual Sphere *clone() const override;
 
+    virtual lix::ShapeType type() const override {
+        return lix::ShapeType::Sphere;
+    }
+
     virtual glm::vec3 supportPoint(const glm::vec3 &dir) override;
+    virtual lix::Bounds bounds() override;
     virtual bool intersects(Capsule &capsule) override;
     virtual bool intersects(Sphere &sphere) override;
     virtual bool intersects(AABB &aabb) override;
@@ -21,7 +30,13 @@ class Sphere : public Shape {
 
     float radii() const { return _radii; }
 
+    // World space center and radius.
+    glm::vec3 center() const;
+    float worldRadius() const;
+
   private:
     float _radii{0.0f};
+    glm::vec3 _center{0.0f}; // in model space
+    bool _fitted{false};
 };
 } // namespace lix
\ No newline at end of file
@@ -0,0 +1,82 @@
+#include "timeofimpact.h"
+
+namespace {
+std::optional<lix::TimeOfImpact>
+advance(lix::Shape &moving, const glm::vec3 &velocity, float angularSpeed,
+        lix::Shape &target, float duration, lix::CollisionQuery &query,
+        float tolerance) {
+    static constexpr int MAX_ITERATIONS{32};
+    lix::TRS &trs = *moving.trs();
+    const glm::vec3 start = trs.translation();
+    // Furthest any point of moving is from its origin, rotation moves a
+    // point at most angularSpeed times that.
+    const lix::Bounds bounds = moving.bounds();
+    const float radius = glm::length(
+        glm::max(glm::abs(bounds.min - start), glm::abs(bounds.max - start)));
+
+    // Towards target. Only turning, take the center line instead, a zero
+    // direction has no support.
+    const glm::vec3 heading = glm::dot(velocity, velocity) > 1e-12f
+                                  ? velocity
+                                  : lix::seedDirection(moving, target);
+
+    std::optional<lix::TimeOfImpact> impact;
+    float time{0.0f};
+    for (int i{0}; i < MAX_ITERATIONS; ++i) {
+        trs.setTranslation(start + velocity * time)->modelMatrix();
+        glm::vec3 normal;
+        const float distance =
+            query.distance(moving, target, -heading, normal);
+        if (distance == 0.0f) {
+            if (time > 0.0f) {
+                // Rounding stepped into contact, normal wasn't set.
+                impact = lix::TimeOfImpact{time, -glm::normalize(heading)};
+            }
+            break; // already touching, for the contact solver to resolve
+        }
+        // normal points towards moving, approaching is along -normal.
+        const float approach =
+            -glm::dot(velocity, normal) + angularSpeed * radius;
+        if (distance < tolerance) {
+            impact = lix::TimeOfImpact{time, normal};
+            break;
+        }
+        if (approach <= 0.0f) {
+            break;
+        }
+        time += (distance - tolerance * 0.5f) / approach;
+        if (time > duration) {
+            break;
+        }
+    }
+    trs.setTranslation(start)->modelMatrix();
+    return impact;
+}
+} // namespace
+
+std::optional<lix::TimeOfImpact>
+lix::timeOfImpact(lix::Shape &moving, const glm::vec3 &velocity,
+                  float angularSpeed, lix::Shape &target, float duration,
+                  lix::CollisionQuery &query, float tolerance) {
+    // Nothing moves, so nothing can come closer.
+    if (glm::dot(velocity, velocity) < 1e-12f && angularSpeed < 1e-6f) {
+        return std::nullopt;
+    }
+    // The parts of compounds are swept pair by pair, the earliest wins.
+    auto part = [](lix::Shape &shape, size_t i) -> lix::Shape & {
+        return i == 0 ? shape : *shape.positives()[i - 1];
+    };
+    std::optional<lix::TimeOfImpact> first;
+    for (size_t i{0}; i <= moving.positives().size(); ++i) {
+        for (size_t j{0}; j <= target.positives().size(); ++j) {
+            auto impact = advance(part(moving, i), velocity, angularSpeed,
+                                  part(target, j),
+                                  first ? first->time : duration, query,
+                                  tolerance);
+            if (impact && (!first || impact->time < first->time)) {
+                first = impact;
+            }
+        }
+    }
+    return first;
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <optional>
+
+#include "collisionquery.h"
+#include "shape.h"
+
+namespace lix {
+struct TimeOfImpact {
+    float time;       // since the start of the motion
+    glm::vec3 normal; // unit, from target to the moving shape
+};
+
+// First time in [0, duration] at which moving, translating with velocity and
+// turning at angularSpeed, comes within tolerance of target. Conservative
+// advancement: step by the GJK distance over the fastest approach speed any
+// point of moving can have, which never steps past the contact. Only the
+// translation of moving is swept, the rotation is accounted for in the
+// speed bound. Nothing is returned if they don't meet or move apart.
+// Compound shapes are swept part by part.
+std::optional<lix::TimeOfImpact>
+timeOfImpact(lix::Shape &moving, const glm::vec3 &velocity, float angularSpeed,
+             lix::Shape &target, float duration, lix::CollisionQuery &query,
+             float tolerance = 1e-3f);
+} // namespace lix
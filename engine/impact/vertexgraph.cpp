@@ -0,0 +1,44 @@
+#include "vertexgraph.h"
+
+#include <algorithm>
+#include <array>
+
+uint32_t lix::VertexGraph::climb(const glm::vec3 &D, uint32_t start) const {
+    uint32_t current = start;
+    float best = glm::dot(points[current], D);
+    for (bool moved{true}; moved;) {
+        moved = false;
+        const uint32_t from = current;
+        for (uint32_t i{offsets[from]}; i < offsets[from + 1]; ++i) {
+            const float value = glm::dot(points[neighbours[i]], D);
+            if (value > best) {
+                best = value;
+                current = neighbours[i];
+                moved = true;
+            }
+        }
+    }
+
+    // The top can be a flat face, its vertices are connected by edges of
+    // equal value. Pick the lowest index there so the answer doesn't depend
+    // on where the climb started.
+    static constexpr size_t MAX_PLATEAU{32};
+    std::array<uint32_t, MAX_PLATEAU> plateau;
+    plateau[0] = current;
+    size_t size{1};
+    uint32_t lowest = current;
+    for (size_t k{0}; k < size; ++k) {
+        for (uint32_t i{offsets[plateau[k]]}; i < offsets[plateau[k] + 1];
+             ++i) {
+            const uint32_t n = neighbours[i];
+            if (size == MAX_PLATEAU || glm::dot(points[n], D) != best ||
+                std::find(plateau.begin(), plateau.begin() + size, n) !=
+                    plateau.begin() + size) {
+                continue;
+            }
+            plateau[size++] = n;
+            lowest = std::min(lowest, n);
+        }
+    }
+    return lowest;
+}
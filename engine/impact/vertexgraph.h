@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+namespace lix {
+// Vertices of a convex hull and the vertices they share an edge with. The
+// neighbours of vertex i are neighbours[offsets[i]] up to
+// neighbours[offsets[i + 1]].
+struct VertexGraph {
+    // Walks from start to the vertex furthest along direction, moving to the
+    // best neighbour until none is better. On a convex hull that is the
+    // global maximum. Ties go to the lowest index, as with a full scan.
+    uint32_t climb(const glm::vec3 &direction, uint32_t start) const;
+
+    std::vector<glm::vec3> points;
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> neighbours;
+};
+} // namespace lix
@@ -1,5 +1,7 @@
 #include "glnode.h"
 
+#include <algorithm>
+
 inline static const std::string noName{""};
 
 lix::Node::Node() : TRS(), _name{noName} {}
@@ -18,6 +20,9 @@ lix::Node::Node(const glm::vec3 &position, const glm::quat &rotation,
     : TRS{position, rotation, scale}, _name{noName} {}
 
 lix::Node::~Node() noexcept {
+    if (_hierarchy) {
+        _hierarchy->forget(this, _hierarchyIndex);
+    }
     _children.clear();
     _parent = nullptr;
 }
@@ -41,9 +46,28 @@ std::shared_ptr<lix::Node> lix::Node::clone() const {
 void lix::Node::appendChild(NodePtr child) {
     _children.emplace_back(child);
     child->_parent = this;
+    if (_hierarchy) {
+        _hierarchy->restructure();
+    }
 }
 
-std::vector<lix::NodePtr> &lix::Node::children() { return _children; }
+bool lix::Node::removeChild(const NodePtr &child) {
+    auto it = std::find(_children.begin(), _children.end(), child);
+    if (it == _children.end()) {
+        return false;
+    }
+    // child may refer to the erased element.
+    NodePtr removed = *it;
+    _children.erase(it);
+    removed->_parent = nullptr;
+    removed->_fresch = false;
+    removed->forEachChildRecursive(
+        [](lix::Node &node) { node._fresch = false; });
+    if (_hierarchy) {
+        _hierarchy->restructure();
+    }
+    return true;
+}
 
 const std::vector<lix::NodePtr> &lix::Node::children() const {
     return _children;
@@ -74,7 +98,14 @@ lix::Node *lix::Node::find(const std::string &name) {
     return nullptr;
 }
 
-const glm::mat4 &lix::Node::globalMatrix() {
+glm::mat4 lix::Node::globalMatrix() {
+    if (_hierarchy) {
+        _hierarchy->update();
+    }
+    // An update may rebuild the hierarchy without this node.
+    if (_hierarchy) {
+        return _hierarchy->world(_hierarchyIndex);
+    }
     updateGlobalMatrix();
     return _globalMatrix;
 }
@@ -114,7 +145,11 @@ bool lix::Node::visible() const { return _visible; }
 bool lix::Node::updateModelMatrix() {
     if (TRS::updateModelMatrix()) {
         _fresch = false;
-        forEachChildRecursive([](lix::Node &child) { child._fresch = false; });
+        // The hierarchy updates the children of tracked nodes itself.
+        if (!_hierarchy) {
+            forEachChildRecursive(
+                [](lix::Node &child) { child._fresch = false; });
+        }
         return true;
     }
     return false;
@@ -123,6 +158,9 @@ bool lix::Node::updateModelMatrix() {
 void lix::Node::invalidate() {
     TRS::invalidate();
     _fresch = false;
+    if (_hierarchy) {
+        _hierarchy->markMoved(_hierarchyIndex);
+    }
 }
 
 bool lix::Node::updateGlobalMatrix() {
@@ -7,6 +7,7 @@
 
 #include "glmesh.h"
 #include "glskin.h"
+#include "gltransformhierarchy.h"
 #include "gltrs.h"
 #include "shape.h"
 
@@ -36,7 +37,9 @@ class Node : public TRS {
 
     void appendChild(NodePtr child);
 
-    std::vector<NodePtr> &children();
+    // Detaches child, which keeps its local transform. False if it isn't a
+    // child of this node.
+    bool removeChild(const NodePtr &child);
 
     const std::vector<NodePtr> &children() const;
 
@@ -56,7 +59,11 @@ class Node : public TRS {
 
     Node *find(const std::string &name);
 
-    const glm::mat4 &globalMatrix();
+    // Read from the node's TransformHierarchy when it is tracked by one.
+    glm::mat4 globalMatrix();
+
+    // Index in the TransformHierarchy tracking the node.
+    uint32_t hierarchyIndex() const { return _hierarchyIndex; }
 
     std::list<Node *> listNodes();
 
@@ -75,6 +82,8 @@ class Node : public TRS {
     bool updateGlobalMatrix();
 
   private:
+    friend class TransformHierarchy;
+
     Node(const Node &other);
 
     const std::string &_name;
@@ -86,5 +95,7 @@ class Node : public TRS {
     std::shared_ptr<Skin> _skin{nullptr};
     std::shared_ptr<lix::Shape> _shape;
     bool _visible{true};
+    lix::TransformHierarchy *_hierarchy{nullptr};
+    uint32_t _hierarchyIndex{0};
 };
 } // namespace lix
\ No newline at end of file
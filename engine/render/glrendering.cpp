@@ -74,6 +74,18 @@ void lix::renderNode(lix::ShaderProgram &shaderProgram, lix::Node &node,
     }
 }
 
+void lix::renderHierarchy(lix::ShaderProgram &shaderProgram,
+                          lix::TransformHierarchy &hierarchy,
+                          lix::ThreadPool *pool) {
+    hierarchy.forEachVisible(
+        [&shaderProgram](lix::Node &node, const glm::mat4 &world) {
+            if (node.mesh()) {
+                renderMesh(shaderProgram, *node.mesh(), world);
+            }
+        },
+        pool);
+}
+
 struct JointBlock {
     glm::mat4 jointMatrices[24];
 };
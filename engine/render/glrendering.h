@@ -6,6 +6,7 @@
 #include "glmesh.h"
 #include "glnode.h"
 #include "glshaderprogram.h"
+#include "gltransformhierarchy.h"
 
 namespace lix {
 void renderScreen();
@@ -16,6 +17,11 @@ void renderMesh(lix::ShaderProgram &shaderProgram, lix::Mesh &mesh,
                 const glm::mat4 &model);
 void renderNode(lix::ShaderProgram &shaderProgram, lix::Node &node,
                 bool recursive = true, bool globalMatrices = true);
+// Renders every tree the hierarchy tracks, reading the world matrices from
+// its arrays in order.
+void renderHierarchy(lix::ShaderProgram &shaderProgram,
+                     lix::TransformHierarchy &hierarchy,
+                     lix::ThreadPool *pool = nullptr);
 void renderSkinAnimationNode(lix::ShaderProgram &shaderProgram,
                              lix::Node &node);
 } // namespace lix
\ No newline at end of file
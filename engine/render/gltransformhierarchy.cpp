@@ -0,0 +1,120 @@
+#include "gltransformhierarchy.h"
+
+#include <algorithm>
+
+#include "glnode.h"
+#include "glthreadpool.h"
+
+lix::TransformHierarchy::~TransformHierarchy() noexcept {
+    for (lix::Node *node : _nodes) {
+        if (node) {
+            node->_hierarchy = nullptr;
+            node->_fresch = false;
+        }
+    }
+}
+
+void lix::TransformHierarchy::build(const std::vector<lix::Node *> &roots) {
+    _roots = roots;
+    rebuild();
+}
+
+void lix::TransformHierarchy::refresh(lix::ThreadPool *pool) {
+    if (_restructure) {
+        rebuild();
+    }
+    if (!_stale) {
+        return;
+    }
+    // The trees of consecutive roots follow each other in the arrays.
+    auto range = [this](size_t begin, size_t end) {
+        updateRange(_rootBegins[begin], _rootBegins[end]);
+    };
+    const size_t numRoots = _roots.size();
+    if (pool && numRoots > 1) {
+        pool->parallelFor(numRoots,
+                          std::max<size_t>(1, numRoots / (pool->size() * 4)),
+                          range);
+    } else {
+        range(0, numRoots);
+    }
+    _stale = false;
+}
+
+void lix::TransformHierarchy::forEachVisible(
+    const std::function<void(lix::Node &, const glm::mat4 &)> &callback,
+    lix::ThreadPool *pool) {
+    update(pool);
+    for (uint32_t i{0}; i < _nodes.size();) {
+        if (!_nodes[i]->visible()) {
+            i = _ends[i];
+            continue;
+        }
+        callback(*_nodes[i], _worlds[i]);
+        ++i;
+    }
+}
+
+void lix::TransformHierarchy::forget(lix::Node *node, uint32_t index) {
+    _nodes[index] = nullptr;
+    _roots.erase(std::remove(_roots.begin(), _roots.end(), node),
+                 _roots.end());
+    _restructure = true;
+}
+
+void lix::TransformHierarchy::rebuild() {
+    // Nodes that leave compute their global matrix themselves again.
+    for (lix::Node *node : _nodes) {
+        if (node) {
+            node->_hierarchy = nullptr;
+            node->_fresch = false;
+        }
+    }
+    _nodes.clear();
+    _parents.clear();
+    _ends.clear();
+    _rootBegins.clear();
+    for (lix::Node *root : _roots) {
+        _rootBegins.push_back(static_cast<uint32_t>(_nodes.size()));
+        flatten(root, NONE);
+    }
+    _rootBegins.push_back(static_cast<uint32_t>(_nodes.size()));
+    _locals.resize(_nodes.size());
+    _worlds.resize(_nodes.size());
+    _moved.assign(_nodes.size(), 1);
+    _stale = true;
+    _restructure = false;
+}
+
+void lix::TransformHierarchy::flatten(lix::Node *node, uint32_t parent) {
+    const uint32_t index = static_cast<uint32_t>(_nodes.size());
+    node->_hierarchy = this;
+    node->_hierarchyIndex = index;
+    _nodes.push_back(node);
+    _parents.push_back(parent);
+    _ends.push_back(0);
+    for (const auto &child : node->children()) {
+        flatten(child.get(), index);
+    }
+    _ends[index] = static_cast<uint32_t>(_nodes.size());
+}
+
+void lix::TransformHierarchy::updateRange(uint32_t begin, uint32_t end) {
+    for (uint32_t i{begin}; i < end;) {
+        if (!_moved[i]) {
+            ++i;
+            continue;
+        }
+        // Everything under a moved node moves with it.
+        for (uint32_t j{i}; j < _ends[i]; ++j) {
+            if (_moved[j]) {
+                _locals[j] = _nodes[j]->modelMatrix();
+                _moved[j] = 0;
+            }
+            _worlds[j] = _parents[j] == NONE
+                             ? _locals[j]
+                             : _worlds[_parents[j]] * _locals[j];
+        }
+        i = _ends[i];
+    }
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+namespace lix {
+class Node;
+class ThreadPool;
+
+// World matrices of node trees kept in flat arrays, parents before their
+// children, so that each subtree is a contiguous range. A node that moves
+// only flags itself. The next update walks the flags once and recomputes
+// the ranges under flagged nodes, reading parents' world matrices from the
+// arrays instead of through the nodes.
+//
+// Node::globalMatrix() of a tracked node reads from here, updating first if
+// anything moved, but a frame should read the arrays in order through
+// forEachVisible() or renderHierarchy(). Appending or removing a child of a
+// tracked node, or destroying one, rebuilds the arrays on the next update.
+// The nodes must not be used from other threads while an update runs.
+class TransformHierarchy {
+  public:
+    TransformHierarchy() = default;
+    ~TransformHierarchy() noexcept;
+
+    TransformHierarchy(const TransformHierarchy &other) = delete;
+    TransformHierarchy &operator=(const TransformHierarchy &other) = delete;
+
+    // Tracks the trees under roots, top level nodes not tracked by another
+    // hierarchy.
+    void build(const std::vector<lix::Node *> &roots);
+
+    // Brings the world matrices up to date. Each root's tree is independent
+    // of the others, with a pool they are updated in parallel.
+    void update(lix::ThreadPool *pool = nullptr) {
+        if (_stale || _restructure) {
+            refresh(pool);
+        }
+    }
+
+    // World matrix of the node at index as of the last update, see
+    // Node::hierarchyIndex().
+    const glm::mat4 &world(uint32_t index) const { return _worlds[index]; }
+
+    size_t size() const { return _nodes.size(); }
+
+    const std::vector<lix::Node *> &nodes() const { return _nodes; }
+
+    // Updates, then calls callback with each visible node and its world
+    // matrix, parents first. Like renderNode(), nothing under an invisible
+    // node is visited.
+    void forEachVisible(
+        const std::function<void(lix::Node &, const glm::mat4 &)> &callback,
+        lix::ThreadPool *pool = nullptr);
+
+  private:
+    friend class Node;
+
+    static constexpr uint32_t NONE{UINT32_MAX};
+
+    void markMoved(uint32_t index) {
+        _moved[index] = 1;
+        _stale = true;
+    }
+
+    void refresh(lix::ThreadPool *pool);
+    void forget(lix::Node *node, uint32_t index);
+    void restructure() { _restructure = true; }
+    void rebuild();
+    void flatten(lix::Node *node, uint32_t parent);
+    void updateRange(uint32_t begin, uint32_t end);
+
+    std::vector<lix::Node *> _roots;
+    std::vector<lix::Node *> _nodes;
+    std::vector<uint32_t> _parents; // NONE for roots
+    std::vector<uint32_t> _ends;    // the subtree of i is [i, _ends[i])
+    std::vector<uint32_t> _rootBegins; // and _nodes.size() last
+    std::vector<glm::mat4> _locals;
+    std::vector<glm::mat4> _worlds;
+    std::vector<uint8_t> _moved;
+    bool _stale{false};
+    bool _restructure{false};
+};
+} // namespace lix
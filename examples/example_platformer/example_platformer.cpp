@@ -1,5 +1,6 @@
 #include "glapplication.h"
 #include "gleditor.h"
+#include <algorithm>
 #include <fstream>
 
 #include "glrendering.h"
@@ -9,6 +10,7 @@
 #include "json.h"
 
 #include "aabb.h"
+#include "broadphase.h"
 #include "charactercontroller.h"
 #include "collision.h"
 #include "convexhull.h"
@@ -427,6 +429,14 @@ class App : public lix::Application, public lix::Editor {
     virtual void onSubjectTransformed(lix::Node *subject,
                                       Transformation transformation) override;
 
+    void trackObjectNodes() {
+        std::vector<lix::Node *> roots;
+        for (const auto &node : objectNodes) {
+            roots.push_back(node.get());
+        }
+        objectHierarchy.build(roots);
+    }
+
     lix::NodePtr createNode(const gltf::Mesh &gltfMesh,
                             const glm::vec3 &position,
                             const glm::vec3 &rotation, const glm::vec3 &scale) {
@@ -468,7 +478,10 @@ class App : public lix::Application, public lix::Editor {
 
     std::shared_ptr<lix::StaticBody>
     emplaceStaticBody(std::shared_ptr<lix::Shape> shape) {
-        return staticBodies.emplace_back(new lix::StaticBody(shape));
+        auto &staticBody =
+            staticBodies.emplace_back(new lix::StaticBody(shape));
+        broadPhase.track(*shape, staticBodies.size() - 1, false);
+        return staticBody;
     }
 
     lix::NodePtr emplaceHUDElement(const glm::vec2 &pos,
@@ -561,6 +574,8 @@ class App : public lix::Application, public lix::Editor {
     lix::ShaderProgramPtr skyboxShader;
     lix::ShaderProgramPtr hudShader;
     std::vector<lix::NodePtr> objectNodes;
+    // The trees of objectNodes, draw() reads their world matrices from here.
+    lix::TransformHierarchy objectHierarchy;
     std::vector<lix::NodePtr> skinnedNodes;
     std::vector<lix::NodePtr> hudObjects;
 
@@ -571,6 +586,8 @@ class App : public lix::Application, public lix::Editor {
     std::vector<std::shared_ptr<lix::CharacterController>> characterControllers;
     std::array<std::shared_ptr<Platform>, 3> platforms;
     std::vector<std::shared_ptr<lix::StaticBody>> staticBodies;
+    lix::BroadPhase broadPhase;
+    std::vector<uint32_t> staticCandidates;
     std::shared_ptr<lix::VAO> closestFaceVAO;
     std::shared_ptr<lix::VAO> platformConvexVAO;
     std::vector<std::shared_ptr<lix::Node>> gimbalArrows;
@@ -815,6 +832,7 @@ void App::init() {
             objectNodes.push_back(node);
         }
     }
+    trackObjectNodes();
     auto lilbroNode = loadCharacter(assets::objects::lilbro::Lilbro_node,
                                     assets::objects::lilbro::Lilbro_skin,
                                     assets::objects::lilbro::Cube_004_mesh,
@@ -849,12 +867,15 @@ void App::tick(float dt) {
     for (auto &consumable : consumables) {
         if (consumable.fadeOut.active()) {
             if (consumable.fadeOut.elapsed()) {
-                objectNodes.erase(
+                auto removed =
                     std::remove_if(objectNodes.begin(), objectNodes.end(),
                                    [&consumable](const auto &o) {
                                        return o.get() == consumable.node.get();
-                                   }),
-                    objectNodes.end());
+                                   });
+                if (removed != objectNodes.end()) {
+                    objectNodes.erase(removed, objectNodes.end());
+                    trackObjectNodes();
+                }
                 continue;
             } else {
                 float f = sinf(consumable.fadeOut.progress() * 1.0f *
@@ -908,6 +929,11 @@ void App::tick(float dt) {
         playerCtrl->dynamicBody->velocity = glm::vec3{0.0f};
     }
 
+    // Static bodies whose node moved are refit, track() skips the others.
+    for (size_t i{0}; i < staticBodies.size(); ++i) {
+        broadPhase.track(*staticBodies[i]->shape, i, false);
+    }
+
     static lix::Collision collision;
     for (auto &cctrl : characterControllers) {
         auto dyn = cctrl->dynamicBody.get();
@@ -958,7 +984,14 @@ void App::tick(float dt) {
             // apply gravity
             dyn->velocity.y += -9.82f * dt;
             static lix::TRS lastTRS;
-            for (auto &staticBody : staticBodies) {
+            staticCandidates.clear();
+            broadPhase.query(dyn->shape->bounds(),
+                             [this](uint32_t index, bool) {
+                                 staticCandidates.push_back(index);
+                             });
+            std::sort(staticCandidates.begin(), staticCandidates.end());
+            for (uint32_t index : staticCandidates) {
+                auto &staticBody = staticBodies[index];
                 if (lix::collides(*dyn->shape, *staticBody->shape,
                                   &collision)) {
                     dyn->velocity.y = 0.0f;
@@ -1087,9 +1120,7 @@ void App::draw() {
     if (xrayMode) {
         glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
     }
-    for (const auto &obj : objectNodes) {
-        lix::renderNode(*objectShader, *obj);
-    }
+    lix::renderHierarchy(*objectShader, objectHierarchy);
     skinnedShader->bind();
     for (const auto &skinned : skinnedNodes) {
         lix::renderSkinAnimationNode(*skinnedShader, *skinned);
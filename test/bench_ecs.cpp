@@ -0,0 +1,143 @@
+#include "unit_test.h"
+
+#include "ecscomponent.h"
+#include "ecsentity.h"
+#include "ecssystem.h"
+
+#include <cmath>
+
+struct Position {
+    float x, y, z;
+};
+
+struct Velocity {
+    float x, y, z;
+};
+
+struct Target {
+    float distance;
+};
+
+using CPosition = ecs::Component<Position>;
+using CVelocity = ecs::Component<Velocity>;
+using CTarget = ecs::Component<Target>;
+
+static_assert(!ecs::Conflicts<ecs::System<const CPosition>,
+                              ecs::System<const CPosition, CVelocity>>::value);
+static_assert(ecs::Conflicts<ecs::System<CPosition>,
+                             ecs::System<const CPosition>>::value);
+
+static void benchParallel(std::vector<ecs::Entity> &entities) {
+    Velocity velocity{1.0f, 0.0f, 0.0f};
+    for (size_t threads : {1UL, 2UL, 4UL, 8UL, 16UL}) {
+        lix::ThreadPool pool{threads};
+        ecs::System<CPosition, const CVelocity> system;
+        for (auto entity : entities) {
+            CVelocity::set(velocity, entity); // make every entity stale
+        }
+        std::string label = "parallel update threads=" + std::to_string(threads);
+        benchmark(label.c_str(), entities.size(), [&]() {
+            system.updateParallel(
+                [](ecs::Entity, Position &p, const Velocity &v) {
+                    for (int i{0}; i < 64; ++i) {
+                        p.y = std::sin(p.y + v.x);
+                    }
+                },
+                pool);
+        });
+    }
+}
+
+void TEST() {
+    for (size_t n : {1000UL, 10000UL, 100000UL}) {
+        std::cout << "--- entities=" << n << std::endl;
+        std::vector<ecs::Entity> entities;
+        entities.reserve(n);
+
+        Velocity velocity{1.0f, 0.0f, 0.0f};
+        benchmark("create+attach", n, [&]() {
+            for (size_t i{0}; i < n; ++i) {
+                ecs::Entity entity =
+                    entities.emplace_back(ecs::EntityRegistry::createEntity());
+                ecs::attach<CPosition, CVelocity>(entity);
+                CVelocity::set(velocity, entity);
+            }
+        });
+
+        float sum{0.0f};
+        benchmark("slice iterate", n, [&]() {
+            ecs::Slice<CPosition, CVelocity>::forEach(
+                entities,
+                [&sum](ecs::Entity, Position &p, Velocity &v) {
+                    p.x += v.x;
+                    sum += p.x;
+                });
+        });
+
+        ecs::System<CPosition, const CVelocity> system;
+        benchmark("system update", n, [&]() {
+            system.update(entities,
+                          [](ecs::Entity, Position &p, const Velocity &v) {
+                              p.x += v.x;
+                          });
+        });
+
+        EXPECT_EQ(CPosition::get(entities.back()).x, 2.0f);
+        print_var(sum);
+
+        // 2% of the entities match the sparse query.
+        size_t matching{0};
+        for (size_t i{0}; i < n; i += 50) {
+            CTarget::attach(entities[i]);
+            ++matching;
+        }
+        size_t visited{0};
+        benchmark("sparse mask scan", n, [&]() {
+            ecs::Slice<CPosition, CTarget>::forEach(
+                entities, [&visited](ecs::Entity, Position &p, Target &t) {
+                    t.distance = p.x;
+                    ++visited;
+                });
+        });
+        EXPECT_EQ(visited, matching);
+        visited = 0;
+        benchmark("sparse query", n, [&]() {
+            ecs::Slice<CPosition, CTarget>::forEach(
+                [&visited](ecs::Entity, Position &p, Target &t) {
+                    t.distance = p.x;
+                    ++visited;
+                });
+        });
+        EXPECT_EQ(visited, matching);
+        for (size_t i{0}; i < n; i += 50) {
+            CTarget::detach(entities[i]);
+        }
+        size_t remaining = ecs::Query<CPosition, CTarget>::entities().size();
+        EXPECT_EQ(remaining, 0UL);
+
+        // 1% of the velocities change between updates.
+        ecs::System<const CVelocity> watcher;
+        auto touch = [&]() {
+            for (size_t i{0}; i < n; i += 100) {
+                CVelocity::set(velocity, entities[i]);
+            }
+        };
+        watcher.updateChanged([](ecs::Entity, const Velocity &) {});
+        touch();
+        visited = 0;
+        benchmark("version scan update", n, [&]() {
+            watcher.update(
+                [&visited](ecs::Entity, const Velocity &) { ++visited; });
+        });
+        EXPECT_EQ(visited, n / 100);
+        touch();
+        visited = 0;
+        benchmark("change log update", n, [&]() {
+            watcher.updateChanged(
+                [&visited](ecs::Entity, const Velocity &) { ++visited; });
+        });
+        EXPECT_EQ(visited, n / 100);
+
+        benchParallel(entities);
+    }
+}
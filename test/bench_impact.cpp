@@ -0,0 +1,659 @@
+#include "unit_test.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cfloat>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <deque>
+#include <new>
+#include <random>
+#include <vector>
+
+#include "aabb.h"
+#include "box.h"
+#include "broadphase.h"
+#include "capsule.h"
+#include "collision.h"
+#include "collisionquery.h"
+#include "convexdecomposition.h"
+#include "convexhull.h"
+#include "glgeometry.h"
+#include "gltrs.h"
+#include "physicsengine.h"
+#include "physicsquery.h"
+#include "polygon.h"
+#include "primer.h"
+#include "primitivecollision.h"
+#include "quickhull.h"
+#include "sphere.h"
+
+static std::atomic<size_t> allocations{0};
+
+// Every form of the global operators is replaced, so that whatever the
+// library picks is counted and freed by the matching function.
+static void *allocate(size_t size, size_t alignment = 0) {
+    ++allocations;
+    size = std::max<size_t>(size, 1);
+    void *p = alignment > alignof(std::max_align_t)
+                  ? std::aligned_alloc(alignment, (size + alignment - 1) /
+                                                      alignment * alignment)
+                  : std::malloc(size);
+    if (!p) {
+        throw std::bad_alloc{};
+    }
+    return p;
+}
+
+void *operator new(size_t size) { return allocate(size); }
+
+void *operator new[](size_t size) { return allocate(size); }
+
+void *operator new(size_t size, std::align_val_t alignment) {
+    return allocate(size, static_cast<size_t>(alignment));
+}
+
+void *operator new[](size_t size, std::align_val_t alignment) {
+    return allocate(size, static_cast<size_t>(alignment));
+}
+
+// GCC sees the free() behind the inlined delete and takes it for a mismatch
+// with operator new, although both are the replacements above.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+void operator delete(void *p) noexcept { std::free(p); }
+
+void operator delete[](void *p) noexcept { std::free(p); }
+
+void operator delete(void *p, size_t) noexcept { std::free(p); }
+
+void operator delete[](void *p, size_t) noexcept { std::free(p); }
+
+void operator delete(void *p, std::align_val_t) noexcept { std::free(p); }
+
+void operator delete[](void *p, std::align_val_t) noexcept { std::free(p); }
+
+void operator delete(void *p, size_t, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void *p, size_t, std::align_val_t) noexcept {
+    std::free(p);
+}
+#pragma GCC diagnostic pop
+
+static void benchBroadPhase(size_t numStatic, size_t numDynamic) {
+    std::cout << "--- static=" << numStatic << " dynamic=" << numDynamic
+              << std::endl;
+    std::mt19937 rng{3};
+    std::uniform_real_distribution<float> position{-200.0f, 200.0f};
+    std::vector<lix::TRS> trs(numStatic + numDynamic);
+    std::vector<lix::DynamicBody> dynamicBodies;
+    std::vector<lix::StaticBody> staticBodies;
+    for (size_t i{0}; i < trs.size(); ++i) {
+        trs[i].setTranslation({position(rng), position(rng), position(rng)});
+        if (i < numDynamic) {
+            dynamicBodies.emplace_back(
+                std::make_shared<lix::Sphere>(&trs[i], 1.0f), 1.0f,
+                glm::mat3{1.0f});
+        } else {
+            auto box = std::make_shared<lix::AABB>(
+                &trs[i], glm::vec3{-2.0f}, glm::vec3{2.0f});
+            staticBodies.emplace_back(box);
+        }
+    }
+
+    size_t bruteForce{0};
+    benchmark("brute force", numStatic * numDynamic, [&]() {
+        for (auto &dynamicBody : dynamicBodies) {
+            for (auto &staticBody : staticBodies) {
+                if (dynamicBody.shape->test(*staticBody.shape)) {
+                    ++bruteForce;
+                }
+            }
+        }
+    });
+
+    lix::BroadPhase broadPhase;
+    benchmark("broad phase build", numStatic + numDynamic,
+              [&]() { broadPhase.update(dynamicBodies, staticBodies); });
+    size_t candidates{0};
+    benchmark("broad phase update", numStatic * numDynamic, [&]() {
+        for (size_t i{0}; i < numDynamic; ++i) {
+            trs[i].applyTranslation({0.05f, 0.0f, 0.0f});
+        }
+        candidates = broadPhase.update(dynamicBodies, staticBodies).size();
+    });
+    print_var(bruteForce);
+    print_var(candidates);
+}
+
+// GJK/EPA on every broad phase pair of a pile of rotated cubes.
+static void benchCollisionQueries() {
+    std::cout << "--- collision queries" << std::endl;
+    std::mt19937 rng{7};
+    std::uniform_real_distribution<float> spread{-4.0f, 4.0f};
+    std::uniform_real_distribution<float> angle{0.0f, 6.28f};
+    const std::vector<glm::vec3> cube =
+        lix::cube_corner_points(glm::vec3{-0.5f}, glm::vec3{0.5f});
+    std::deque<lix::TRS> trs;
+    std::vector<lix::DynamicBody> pile;
+    std::vector<lix::StaticBody> none;
+    for (size_t i{0}; i < 400; ++i) {
+        trs.emplace_back(
+            glm::vec3{spread(rng), spread(rng), spread(rng)},
+            glm::angleAxis(angle(rng),
+                           glm::normalize(glm::vec3{spread(rng), 1.0f,
+                                                    spread(rng)})),
+            glm::vec3{1.0f});
+        pile.emplace_back(std::make_shared<lix::Polygon>(&trs.back(), cube),
+                          1.0f, glm::mat3{1.0f});
+    }
+    lix::BroadPhase broadPhase;
+    const auto pairs = broadPhase.update(pile, none);
+    static constexpr size_t ROUNDS{20};
+    auto direction = [&](const lix::BroadPhase::Pair &pair) {
+        return glm::normalize(
+            lix::seedDirection(*pile[pair.a].shape, *pile[pair.b].shape));
+    };
+
+    size_t hits{0};
+    size_t before = allocations;
+    std::vector<glm::vec3> simplex;
+    lix::Collision collision;
+    double ns = benchmark("gjk + epa", ROUNDS * pairs.size(), [&]() {
+        for (size_t round{0}; round < ROUNDS; ++round) {
+            for (const auto &pair : pairs) {
+                lix::Shape &a = *pile[pair.a].shape;
+                lix::Shape &b = *pile[pair.b].shape;
+                simplex.clear();
+                if (lix::gjk(a, b, simplex, direction(pair), &collision) &&
+                    lix::epa(a, b, simplex, &collision)) {
+                    ++hits;
+                }
+            }
+        }
+    });
+    double allocationsPerQuery =
+        static_cast<double>(allocations - before) / (ROUNDS * pairs.size());
+    double queriesPerSecond = 1.0e9 / ns;
+    print_var(queriesPerSecond);
+    print_var(allocationsPerQuery);
+    print_var(hits);
+
+    hits = 0;
+    before = allocations;
+    lix::CollisionQuery query;
+    ns = benchmark("collision query", ROUNDS * pairs.size(), [&]() {
+        for (size_t round{0}; round < ROUNDS; ++round) {
+            for (const auto &pair : pairs) {
+                if (query.collides(*pile[pair.a].shape, *pile[pair.b].shape,
+                                   direction(pair), &collision)) {
+                    ++hits;
+                }
+            }
+        }
+    });
+    allocationsPerQuery =
+        static_cast<double>(allocations - before) / (ROUNDS * pairs.size());
+    queriesPerSecond = 1.0e9 / ns;
+    print_var(queriesPerSecond);
+    print_var(allocationsPerQuery);
+    print_var(hits);
+
+    // Whole narrow phase, cold and then seeded from the previous round.
+    std::vector<lix::PhysicsEngine::Contact> contacts;
+    auto iterationsPerQuery = [&]() {
+        size_t iterations{0};
+        for (const auto &contact : contacts) {
+            iterations += contact.gjkIterations + contact.epaIterations;
+        }
+        return static_cast<double>(iterations) / contacts.size();
+    };
+    benchmark("narrow phase cold", ROUNDS * pairs.size(), [&]() {
+        for (size_t round{0}; round < ROUNDS; ++round) {
+            lix::PhysicsEngine::narrowPhase(pairs, pile, none, contacts);
+        }
+    });
+    double coldIterations = iterationsPerQuery();
+    print_var(coldIterations);
+    lix::PairCache cache;
+    benchmark("narrow phase warm", ROUNDS * pairs.size(), [&]() {
+        for (size_t round{0}; round < ROUNDS; ++round) {
+            lix::PhysicsEngine::narrowPhase(pairs, pile, none, contacts,
+                                            nullptr, &cache);
+        }
+    });
+    double warmIterations = iterationsPerQuery();
+    size_t cacheHits{0};
+    for (const auto &contact : contacts) {
+        cacheHits += contact.cached ? 1 : 0;
+    }
+    double hitRate = static_cast<double>(cacheHits) / contacts.size();
+    print_var(warmIterations);
+    print_var(hitRate);
+}
+
+static void benchSupportPoints(size_t numPoints) {
+    std::cout << "--- support points=" << numPoints << std::endl;
+    std::mt19937 rng{7};
+    std::uniform_real_distribution<float> coordinate{-1.0f, 1.0f};
+    std::vector<glm::vec3> points;
+    for (size_t i{0}; i < numPoints; ++i) {
+        points.push_back(
+            glm::normalize(glm::vec3{coordinate(rng), coordinate(rng),
+                                     coordinate(rng)}));
+    }
+    std::vector<glm::vec3> directions;
+    for (size_t i{0}; i < 64; ++i) {
+        directions.push_back(
+            {coordinate(rng), coordinate(rng), coordinate(rng)});
+    }
+    lix::TRS trs{glm::vec3{0.0f}};
+    lix::Polygon polygon{&trs, points};
+    static constexpr size_t FRAMES{200};
+    glm::vec3 sum{0.0f};
+
+    // The body moves every frame and GJK makes a handful of queries.
+    benchmark("transformed points", FRAMES * directions.size(), [&]() {
+        for (size_t frame{0}; frame < FRAMES; ++frame) {
+            trs.setTranslation(glm::vec3{frame * 0.01f})->modelMatrix();
+            for (const glm::vec3 &D : directions) {
+                const auto &transformed = polygon.transformedPoints();
+                size_t best{0};
+                for (size_t i{1}; i < transformed.size(); ++i) {
+                    if (glm::dot(transformed[i], D) >
+                        glm::dot(transformed[best], D)) {
+                        best = i;
+                    }
+                }
+                sum += transformed[best];
+            }
+        }
+    });
+    benchmark("local direction", FRAMES * directions.size(), [&]() {
+        for (size_t frame{0}; frame < FRAMES; ++frame) {
+            trs.setTranslation(glm::vec3{frame * 0.01f})->modelMatrix();
+            for (const glm::vec3 &D : directions) {
+                sum += polygon.supportPoint(D);
+            }
+        }
+    });
+    print_var(sum.x);
+}
+
+static void benchHillClimbing(size_t numPoints) {
+    std::cout << "--- hill climbing points=" << numPoints << std::endl;
+    std::mt19937 rng{7};
+    std::uniform_real_distribution<float> coordinate{-1.0f, 1.0f};
+    std::vector<glm::vec3> points;
+    for (size_t i{0}; i < numPoints; ++i) {
+        points.push_back(
+            glm::normalize(glm::vec3{coordinate(rng), coordinate(rng),
+                                     coordinate(rng)}));
+    }
+    const lix::VertexGraph graph = lix::ConvexHull{points}.vertexGraph();
+    size_t hullVertices = graph.points.size();
+    print_var(hullVertices);
+    lix::TRS trs{glm::vec3{0.0f}};
+    lix::Polygon scanned{&trs, graph.points};
+    lix::Polygon climbed{&trs, graph};
+
+    // A body turning a little every frame, GJK looking along about the same
+    // directions, and uncorrelated directions as the worst case.
+    static constexpr size_t QUERIES{100000};
+    std::vector<glm::vec3> coherent;
+    std::vector<glm::vec3> random;
+    for (size_t i{0}; i < QUERIES; ++i) {
+        const float angle = i * 0.001f;
+        coherent.push_back({std::cos(angle), 0.3f, std::sin(angle)});
+        random.push_back({coordinate(rng), coordinate(rng), coordinate(rng)});
+    }
+    glm::vec3 sum{0.0f};
+    for (const auto &[label, directions] :
+         {std::make_pair("coherent", &coherent),
+          std::make_pair("random", &random)}) {
+        std::cout << label << std::endl;
+        benchmark("scan", QUERIES, [&]() {
+            for (const glm::vec3 &D : *directions) {
+                sum += scanned.supportPoint(D);
+            }
+        });
+        benchmark("climb", QUERIES, [&]() {
+            for (const glm::vec3 &D : *directions) {
+                sum += climbed.supportPoint(D);
+            }
+        });
+        benchmark("hinted climb", QUERIES, [&]() {
+            uint32_t hint{0};
+            for (const glm::vec3 &D : *directions) {
+                sum += climbed.hintedSupportPoint(D, hint);
+            }
+        });
+    }
+    print_var(sum.x);
+}
+
+static void benchRaycasts(size_t numStatic, size_t numRays) {
+    std::cout << "--- raycasts static=" << numStatic << " rays=" << numRays
+              << std::endl;
+    std::mt19937 rng{7};
+    std::uniform_real_distribution<float> spread{-50.0f, 50.0f};
+    std::uniform_real_distribution<float> coordinate{-1.0f, 1.0f};
+    const std::vector<glm::vec3> cube =
+        lix::cube_corner_points(glm::vec3{-0.5f}, glm::vec3{0.5f});
+    std::deque<lix::TRS> trs;
+    std::vector<lix::StaticBody> statics;
+    std::vector<lix::DynamicBody> none;
+    for (size_t i{0}; i < numStatic; ++i) {
+        trs.emplace_back(glm::vec3{spread(rng), spread(rng), spread(rng)});
+        statics.emplace_back(
+            std::make_shared<lix::Polygon>(&trs.back(), cube));
+    }
+    std::vector<lix::PhysicsQuery::Ray> rays;
+    for (size_t i{0}; i < numRays; ++i) {
+        rays.push_back({glm::vec3{spread(rng), spread(rng), spread(rng)},
+                        glm::normalize(glm::vec3{coordinate(rng),
+                                                 coordinate(rng),
+                                                 coordinate(rng)}),
+                        50.0f});
+    }
+    lix::BroadPhase broadPhase;
+    lix::PhysicsQuery query{broadPhase, none, statics};
+    std::vector<std::optional<lix::PhysicsQuery::Hit>> hits;
+    benchmark("serial", numRays, [&]() { query.raycast(rays, hits); });
+    benchmark("thread pool", numRays, [&]() {
+        query.raycast(rays, hits, &lix::ThreadPool::global());
+    });
+    size_t numHits = std::count_if(
+        hits.begin(), hits.end(),
+        [](const auto &hit) { return hit.has_value(); });
+    print_var(numHits);
+}
+
+static void benchSleeping() {
+    std::cout << "--- resting stacks" << std::endl;
+    const std::vector<glm::vec3> cube =
+        lix::cube_corner_points(glm::vec3{-0.5f}, glm::vec3{0.5f});
+    std::deque<lix::TRS> trs;
+    std::vector<lix::StaticBody> ground;
+    trs.emplace_back(glm::vec3{0.0f, -0.5f, 0.0f},
+                     glm::quat{1.0f, 0.0f, 0.0f, 0.0f},
+                     glm::vec3{100.0f, 1.0f, 100.0f});
+    ground.emplace_back(std::make_shared<lix::Polygon>(&trs.back(), cube));
+    std::vector<lix::DynamicBody> awake;
+    std::vector<lix::DynamicBody> asleep;
+    for (auto *bodies : {&awake, &asleep}) {
+        for (size_t i{0}; i < 400; ++i) {
+            trs.emplace_back(glm::vec3{(i % 10) * 2.0f, 0.51f + i / 100,
+                                       (i / 10 % 10) * 2.0f});
+            bodies->push_back(lix::PhysicsEngine::createDynamicBody(
+                std::make_shared<lix::Polygon>(&trs.back(), cube), 1.0f,
+                1.0f));
+        }
+    }
+    lix::PhysicsEngine::Context awakeContext;
+    awakeContext.sleep.timeToSleep = FLT_MAX;
+    lix::PhysicsEngine::Context asleepContext;
+    for (size_t frame{0}; frame < 120; ++frame) {
+        lix::PhysicsEngine::step(awake, ground, 1.0f / 60.0f, awakeContext);
+        lix::PhysicsEngine::step(asleep, ground, 1.0f / 60.0f, asleepContext);
+    }
+    size_t sleeping = asleepContext.timings.sleeping;
+    print_var(sleeping);
+    benchmark("step awake", 60, [&]() {
+        for (size_t frame{0}; frame < 60; ++frame) {
+            lix::PhysicsEngine::step(awake, ground, 1.0f / 60.0f,
+                                     awakeContext);
+        }
+    });
+    benchmark("step asleep", 60, [&]() {
+        for (size_t frame{0}; frame < 60; ++frame) {
+            lix::PhysicsEngine::step(asleep, ground, 1.0f / 60.0f,
+                                     asleepContext);
+        }
+    });
+}
+
+// Closed form contacts against GJK/EPA on the same overlapping pairs.
+static void benchPrimitiveContacts(size_t numPairs) {
+    std::mt19937 rng{5};
+    std::uniform_real_distribution<float> coordinate{-0.8f, 0.8f};
+    std::uniform_real_distribution<float> angle{0.0f, 6.28f};
+    std::deque<lix::TRS> trs;
+    std::vector<std::shared_ptr<lix::Shape>> shapes;
+    for (size_t i{0}; i < 2 * numPairs; ++i) {
+        trs.emplace_back(
+            glm::vec3{coordinate(rng), coordinate(rng), coordinate(rng)},
+            glm::angleAxis(angle(rng),
+                           glm::normalize(glm::vec3{coordinate(rng), 1.0f,
+                                                    coordinate(rng)})),
+            glm::vec3{1.0f});
+        trs.back().modelMatrix();
+    }
+    auto bench = [&](const char *analyticLabel, const char *gjkLabel,
+                     auto makeShape) {
+        shapes.clear();
+        for (auto &t : trs) {
+            shapes.push_back(makeShape(&t));
+        }
+        lix::Collision collision;
+        size_t hits{0};
+        benchmark(analyticLabel, numPairs, [&]() {
+            for (size_t i{0}; i < numPairs; ++i) {
+                lix::Shape &a = *shapes[2 * i];
+                lix::Shape &b = *shapes[2 * i + 1];
+                hits += lix::primitiveContact(a, b)(a, b, collision);
+            }
+        });
+        lix::CollisionQuery query;
+        benchmark(gjkLabel, numPairs, [&]() {
+            for (size_t i{0}; i < numPairs; ++i) {
+                lix::Shape &a = *shapes[2 * i];
+                lix::Shape &b = *shapes[2 * i + 1];
+                hits += query.collides(a, b, lix::seedDirection(a, b),
+                                       &collision);
+            }
+        });
+        print_var(hits);
+    };
+    bench("sphere-sphere closed form", "sphere-sphere GJK/EPA",
+          [](lix::TRS *t) { return std::make_shared<lix::Sphere>(t, 0.5f); });
+    bench("capsule-capsule closed form", "capsule-capsule GJK/EPA",
+          [](lix::TRS *t) {
+              return std::make_shared<lix::Capsule>(
+                  t, glm::vec3{0.0f, -0.5f, 0.0f}, glm::vec3{0.0f, 0.5f, 0.0f},
+                  0.3f);
+          });
+    bench("box-box closed form", "box-box GJK/EPA", [](lix::TRS *t) {
+        return std::make_shared<lix::Box>(t, glm::vec3{0.5f});
+    });
+}
+
+// Broad phase bounds of a spinning polygon, from its points and from fitted
+// bounding volumes.
+static void benchBoundingVolumes(size_t numPoints) {
+    std::cout << "--- bounding volumes points=" << numPoints << std::endl;
+    std::mt19937 rng{3};
+    std::uniform_real_distribution<float> coordinate{-1.0f, 1.0f};
+    std::vector<glm::vec3> points;
+    for (size_t i{0}; i < numPoints; ++i) {
+        points.push_back(
+            {coordinate(rng), coordinate(rng) * 0.5f, coordinate(rng)});
+    }
+    lix::TRS trs{glm::vec3{0.0f}};
+    lix::Polygon polygon{&trs, points};
+    static constexpr size_t FRAMES{10000};
+    auto bench = [&](const char *label, std::shared_ptr<lix::Shape> volume) {
+        polygon.setSimplified(volume);
+        glm::vec3 sum{0.0f};
+        size_t before = allocations;
+        benchmark(label, FRAMES, [&]() {
+            for (size_t frame{0}; frame < FRAMES; ++frame) {
+                trs.setRotation(glm::angleAxis(
+                    frame * 0.01f, glm::vec3{0.0f, 1.0f, 0.0f}));
+                trs.modelMatrix();
+                const lix::Bounds bounds = polygon.bounds();
+                sum += bounds.max - bounds.min;
+            }
+        });
+        size_t allocated = allocations - before;
+        print_var(allocated);
+        print_var(sum);
+    };
+    bench("support points", nullptr);
+    bench("fitted aabb", std::make_shared<lix::AABB>(&trs, &polygon));
+    bench("fitted obb", std::make_shared<lix::Box>(&trs, polygon));
+    bench("fitted sphere", std::make_shared<lix::Sphere>(&trs, polygon));
+}
+
+// Hulls of clouds filling a ball, most points end up inside, and of points
+// on a sphere, where all of them are vertices.
+static void benchQuickHull(size_t numPoints) {
+    std::cout << "--- quick hull points=" << numPoints << std::endl;
+    std::mt19937 rng{11};
+    std::uniform_real_distribution<float> coordinate{-1.0f, 1.0f};
+    std::vector<glm::vec3> filled;
+    std::vector<glm::vec3> surface;
+    while (filled.size() < numPoints) {
+        const glm::vec3 p{coordinate(rng), coordinate(rng), coordinate(rng)};
+        const float length2 = glm::dot(p, p);
+        if (length2 <= 1.0f && length2 > 1e-6f) {
+            filled.push_back(p);
+            surface.push_back(p / std::sqrt(length2));
+        }
+    }
+    lix::QuickHull quickHull;
+    for (const auto *cloud : {&filled, &surface}) {
+        benchmark(cloud == &filled ? "quick hull ball" : "quick hull sphere",
+                  numPoints, [&]() { quickHull.build(*cloud); });
+        size_t vertices = quickHull.vertices().size();
+        print_var(vertices);
+    }
+}
+
+// A triangle soup like a loaded level mesh: every grid vertex repeated by
+// the six triangles around it.
+static void benchWelding(size_t numVertices) {
+    std::cout << "--- welding vertices=" << numVertices << std::endl;
+    std::vector<glm::vec3> soup;
+    const size_t side = static_cast<size_t>(std::sqrt(numVertices / 6.0));
+    for (size_t i{0}; soup.size() < numVertices; ++i) {
+        const size_t cell = i % (side * side);
+        soup.push_back({static_cast<float>(cell % side) * 0.5f,
+                        std::sin(cell * 0.1f),
+                        static_cast<float>(cell / side) * 0.5f});
+    }
+    std::vector<uint32_t> remap;
+    size_t welded{0};
+    benchmark("weld", soup.size(),
+              [&]() { welded = lix::weldVertices(soup, remap).size(); });
+    print_var(welded);
+    const std::vector<glm::vec3> head(soup.begin(), soup.begin() + 5000);
+    benchmark("pairwise scan of 5000", head.size(), [&]() {
+        std::vector<glm::vec3> unique;
+        for (const glm::vec3 &p : head) {
+            if (!lix::containsVertex(unique, p)) {
+                unique.push_back(p);
+            }
+        }
+        welded = unique.size();
+    });
+    print_var(welded);
+}
+
+static void benchDecomposition(uint32_t segments) {
+    std::cout << "--- convex decomposition segments=" << segments << std::endl;
+    // A torus: its single hull fills the hole, its vertices make a slow
+    // polygon that GJK treats as that same hull.
+    std::vector<glm::vec3> vertices;
+    std::vector<uint32_t> indices;
+    const uint32_t rings{segments / 4};
+    for (uint32_t i{0}; i < segments; ++i) {
+        for (uint32_t j{0}; j < rings; ++j) {
+            const float u = 6.2831853f * i / segments;
+            const float v = 6.2831853f * j / rings;
+            const float r = 2.0f + 0.5f * std::cos(v);
+            vertices.push_back(
+                {r * std::cos(u), 0.5f * std::sin(v), r * std::sin(u)});
+            const uint32_t next = (i + 1) % segments;
+            const uint32_t up = (j + 1) % rings;
+            indices.insert(indices.end(),
+                           {i * rings + j, next * rings + j, next * rings + up,
+                            i * rings + j, next * rings + up, i * rings + up});
+        }
+    }
+    std::vector<std::vector<glm::vec3>> hulls;
+    benchmark("decompose", 1,
+              [&]() { hulls = lix::convexDecomposition(vertices, indices); });
+    size_t hullPoints{0};
+    for (const auto &hull : hulls) {
+        hullPoints += hull.size();
+    }
+    print_var(hulls.size());
+    print_var(hullPoints);
+
+    std::mt19937 rng{7};
+    std::uniform_real_distribution<float> around{0.0f, 6.28f};
+    std::uniform_real_distribution<float> offset{-1.0f, 1.0f};
+    std::deque<lix::TRS> trs;
+    trs.emplace_back(glm::vec3{0.0f});
+    std::vector<lix::DynamicBody> boxes;
+    std::vector<lix::BroadPhase::Pair> pairs;
+    for (uint32_t i{0}; i < 1000; ++i) {
+        const float u = around(rng);
+        const float r = 2.0f + offset(rng) * 1.5f;
+        trs.emplace_back(
+            glm::vec3{r * std::cos(u), offset(rng), r * std::sin(u)});
+        boxes.push_back(lix::PhysicsEngine::createDynamicBody(
+            std::make_shared<lix::Box>(&trs.back(), glm::vec3{0.2f}), 1.0f,
+            0.4f));
+        pairs.push_back({i, 0, false});
+    }
+    static constexpr size_t ROUNDS{20};
+    std::vector<lix::PhysicsEngine::Contact> contacts;
+    auto bench = [&](const char *label, std::shared_ptr<lix::Shape> shape) {
+        std::vector<lix::StaticBody> level{
+            lix::PhysicsEngine::createStaticBody(shape)};
+        benchmark(label, ROUNDS * pairs.size(), [&]() {
+            for (size_t round{0}; round < ROUNDS; ++round) {
+                lix::PhysicsEngine::narrowPhase(pairs, boxes, level,
+                                                contacts);
+            }
+        });
+        size_t colliding{0};
+        for (const auto &contact : contacts) {
+            colliding += contact.colliding ? 1 : 0;
+        }
+        print_var(colliding);
+    };
+    std::vector<uint32_t> remap;
+    const std::vector<glm::vec3> unique = lix::weldVertices(vertices, remap);
+    bench("all vertices", std::make_shared<lix::Polygon>(&trs[0], unique));
+    bench("compound", lix::compoundShape(&trs[0], hulls));
+}
+
+void TEST() {
+    for (size_t numStatic : {1000UL, 5000UL, 20000UL}) {
+        benchBroadPhase(numStatic, 100);
+    }
+    benchCollisionQueries();
+    for (size_t numPoints : {8UL, 64UL, 512UL}) {
+        benchSupportPoints(numPoints);
+    }
+    for (size_t numPoints : {100UL, 1000UL}) {
+        benchHillClimbing(numPoints);
+    }
+    benchRaycasts(5000, 10000);
+    benchSleeping();
+    benchPrimitiveContacts(10000);
+    benchBoundingVolumes(1000);
+    for (size_t numPoints : {10000UL, 100000UL, 1000000UL}) {
+        benchQuickHull(numPoints);
+    }
+    benchWelding(50000);
+    for (uint32_t segments : {64U, 256U}) {
+        benchDecomposition(segments);
+    }
+}
@@ -0,0 +1,107 @@
+#include "unit_test.h"
+
+#include "glnode.h"
+#include "glthreadpool.h"
+#include "gltransformhierarchy.h"
+
+#include <random>
+
+// numRoots trees of depth levels, each node with branching children.
+static std::vector<lix::NodePtr> makeScene(size_t numRoots, int depth,
+                                           int branching) {
+    std::vector<lix::NodePtr> roots;
+    std::vector<lix::Node *> level;
+    for (size_t i{0}; i < numRoots; ++i) {
+        roots.push_back(std::make_shared<lix::Node>(glm::vec3{1.0f}));
+        level.push_back(roots.back().get());
+    }
+    for (int d{1}; d < depth; ++d) {
+        std::vector<lix::Node *> next;
+        for (lix::Node *parent : level) {
+            for (int c{0}; c < branching; ++c) {
+                auto child = std::make_shared<lix::Node>(
+                    glm::vec3{0.1f * static_cast<float>(c), 0.5f, 0.0f});
+                parent->appendChild(child);
+                next.push_back(child.get());
+            }
+        }
+        level = std::move(next);
+    }
+    return roots;
+}
+
+static std::vector<lix::Node *> listScene(std::vector<lix::NodePtr> &roots) {
+    std::vector<lix::Node *> nodes;
+    for (auto &root : roots) {
+        for (lix::Node *node : root->listNodes()) {
+            nodes.push_back(node);
+        }
+    }
+    return nodes;
+}
+
+// Moves a share of the nodes and then reads every global matrix, as a frame
+// with animated nodes would before rendering. With a hierarchy the matrices
+// are read from its arrays unless throughNodes.
+static void benchFrames(const char *label, std::vector<lix::Node *> &nodes,
+                        float moved, lix::TransformHierarchy *hierarchy,
+                        lix::ThreadPool *pool, bool throughNodes = false) {
+    std::mt19937 rng{3};
+    const size_t numMoved = static_cast<size_t>(moved * nodes.size());
+    const int frames{20};
+    float sink{0.0f};
+    benchmark(label, nodes.size() * frames, [&]() {
+        for (int f{0}; f < frames; ++f) {
+            for (size_t i{0}; i < numMoved; ++i) {
+                nodes[rng() % nodes.size()]->applyTranslation(
+                    glm::vec3{0.0f, 0.001f, 0.0f});
+            }
+            if (hierarchy && !throughNodes) {
+                hierarchy->update(pool);
+                for (uint32_t i{0}; i < hierarchy->size(); ++i) {
+                    sink += hierarchy->world(i)[3][1];
+                }
+                continue;
+            }
+            for (lix::Node *node : nodes) {
+                sink += node->globalMatrix()[3][1];
+            }
+        }
+    });
+    if (sink == 0.0f) {
+        std::cout << "unexpected" << std::endl;
+    }
+}
+
+void TEST() {
+    // 50k nodes in total either way.
+    struct Shape {
+        size_t numRoots;
+        int depth;
+        int branching;
+    };
+    for (Shape shape : {Shape{6250, 4, 1}, Shape{1613, 5, 2}}) {
+        std::cout << "--- roots=" << shape.numRoots
+                  << " depth=" << shape.depth << std::endl;
+        for (float moved : {0.01f, 1.0f}) {
+            std::cout << "moved=" << moved << std::endl;
+            auto roots = makeScene(shape.numRoots, shape.depth,
+                                   shape.branching);
+            auto nodes = listScene(roots);
+            benchFrames("node globalMatrix", nodes, moved, nullptr, nullptr);
+
+            std::vector<lix::Node *> top;
+            for (auto &root : roots) {
+                top.push_back(root.get());
+            }
+            lix::TransformHierarchy hierarchy;
+            hierarchy.build(top);
+            benchFrames("hierarchy via nodes", nodes, moved, &hierarchy,
+                        nullptr, true);
+            benchFrames("hierarchy", nodes, moved, &hierarchy, nullptr);
+            lix::ThreadPool pool{4};
+            benchFrames("hierarchy threads=4", nodes, moved, &hierarchy,
+                        &pool);
+        }
+    }
+}
@@ -0,0 +1,254 @@
+#include "unit_test.h"
+
+#include "ecscommandbuffer.h"
+#include "ecscomponent.h"
+#include "ecsentity.h"
+#include "ecssystem.h"
+#include "glthreadpool.h"
+
+#include <atomic>
+#include <set>
+#include <sstream>
+#include <string>
+#include <type_traits>
+
+struct Projectile {
+    float x;
+    float speed;
+};
+
+using CProjectile = ecs::Component<Projectile>;
+
+struct Health {
+    int points;
+};
+
+using CHealth = ecs::Component<Health>;
+
+struct Gravity {
+    float g;
+};
+
+using CGravity = ecs::Component<Gravity, 0, true>;
+
+struct Motion {
+    float x;
+    float v;
+};
+
+using CMotion = ecs::Component<Motion>;
+
+// A copy would share the cursors the change logs point at.
+static_assert(!std::is_copy_constructible_v<ecs::System<CMotion>> &&
+              !std::is_move_constructible_v<ecs::System<CMotion>>);
+
+void TEST() {
+    auto &registry = ecs::EntityRegistry::instance();
+
+    // Stale handles are detected once a slot is recycled.
+    ecs::Entity first = ecs::EntityRegistry::createEntity();
+    CProjectile::attach(first);
+    CProjectile::get(first).speed = 5.0f;
+    EXPECT_EQ(ecs::EntityRegistry::destroyEntity(first), true);
+    EXPECT_EQ(ecs::EntityRegistry::destroyEntity(first), false);
+    EXPECT_EQ(registry.alive(first), false);
+    ecs::Entity second = ecs::EntityRegistry::createEntity();
+    EXPECT_EQ(ecs::entityIndex(second), ecs::entityIndex(first));
+    EXPECT_LT(first, second);
+    EXPECT_EQ(CProjectile::has(first), false);
+    EXPECT_EQ(CProjectile::has(second), false);
+    CProjectile::attach(second);
+    EXPECT_EQ(CProjectile::get(second).speed, 0.0f); // no leftover state
+    ecs::EntityRegistry::destroyEntity(second);
+
+    // Components that were never attached or set read as zero.
+    ecs::Entity bare = ecs::EntityRegistry::createEntity();
+    for (size_t i{0}; i < 5000; ++i) {
+        ecs::EntityRegistry::createEntity(); // past the first page
+    }
+    ecs::Entity beyond = ecs::EntityRegistry::createEntity();
+    EXPECT_EQ(CHealth::get(bare).points, 0);
+    EXPECT_EQ(CHealth::get(beyond).points, 0);
+    EXPECT_EQ(CGravity::get().g, 0.0f);
+    Gravity gravity{9.8f};
+    CGravity::set(gravity);
+    EXPECT_EQ(CGravity::get(beyond).g, 9.8f);
+
+    // Churn spawns and despawns; the slot count must stay flat.
+    static constexpr size_t BATCH{1000};
+    static constexpr size_t ROUNDS{2000};
+    std::vector<ecs::Entity> live;
+    live.reserve(BATCH);
+    size_t slots{0};
+    size_t matching{0};
+    for (size_t round{0}; round < ROUNDS; ++round) {
+        for (size_t i{0}; i < BATCH; ++i) {
+            ecs::Entity entity = live.emplace_back(
+                ecs::EntityRegistry::createEntity());
+            CProjectile::attach(entity);
+        }
+        matching = ecs::Query<CProjectile>::entities().size();
+        EXPECT_EQ(matching, BATCH);
+        for (ecs::Entity entity : live) {
+            ecs::EntityRegistry::destroyEntity(entity);
+        }
+        live.clear();
+        if (round == 0) {
+            slots = registry.slots();
+        }
+        EXPECT_EQ(registry.slots(), slots);
+    }
+    matching = ecs::Query<CProjectile>::entities().size();
+    EXPECT_EQ(matching, 0UL);
+
+    // Structural changes made during an update are deferred to applyAll().
+    for (size_t i{0}; i < 10; ++i) {
+        ecs::Entity entity = ecs::EntityRegistry::createEntity();
+        CProjectile::attach(entity);
+        Projectile projectile{static_cast<float>(i), 1.0f};
+        CProjectile::set(projectile, entity);
+    }
+    ecs::System<CProjectile> system;
+    system.update([](ecs::Entity entity, Projectile &projectile) {
+        auto &commands = ecs::CommandBuffer::local();
+        if (projectile.x >= 5.0f) {
+            commands.destroy(entity);
+            auto spawned = commands.create();
+            commands.attach<CProjectile>(spawned);
+            commands.set<CProjectile>(spawned, Projectile{-1.0f, 2.0f});
+        }
+    });
+    matching = ecs::Query<CProjectile>::entities().size();
+    EXPECT_EQ(matching, 10UL);
+    ecs::CommandBuffer::applyAll();
+    EXPECT_EQ(ecs::CommandBuffer::local().empty(), true);
+    size_t spawned{0};
+    ecs::Query<CProjectile>::forEach(
+        [&spawned](ecs::Entity, Projectile &projectile) {
+            EXPECT_LT(projectile.x, 5.0f);
+            if (projectile.speed == 2.0f) {
+                ++spawned;
+            }
+        });
+    EXPECT_EQ(spawned, 5UL);
+    matching = ecs::Query<CProjectile>::entities().size();
+    EXPECT_EQ(matching, 10UL);
+
+    // A mostly static world only visits what changed.
+    std::vector<ecs::Entity> units;
+    for (size_t i{0}; i < 100; ++i) {
+        ecs::Entity entity = units.emplace_back(
+            ecs::EntityRegistry::createEntity());
+        CHealth::attach(entity);
+    }
+    ecs::System<const CHealth> watcher;
+    size_t visited{0};
+    auto count = [&visited](ecs::Entity, const Health &) { ++visited; };
+    watcher.updateChanged(count); // first call rescans
+    EXPECT_EQ(visited, 100UL);
+    visited = 0;
+    watcher.updateChanged(count);
+    EXPECT_EQ(visited, 0UL);
+    Health wounded{50};
+    CHealth::set(wounded, units[3]);
+    CHealth::set(wounded, units[7]);
+    CHealth::set(wounded, units[7]);
+    CHealth::set(wounded, units[42]);
+    ecs::EntityRegistry::destroyEntity(units[42]);
+    watcher.updateChanged(count);
+    EXPECT_EQ(visited, 2UL);
+
+    // A parallel update leaves the same components and change log entries
+    // as a serial one. Nested parallelFor calls run inline.
+    lix::ThreadPool pool{4};
+    std::vector<ecs::Entity> movers;
+    for (size_t i{0}; i < 5000; ++i) {
+        ecs::Entity entity = movers.emplace_back(
+            ecs::EntityRegistry::createEntity());
+        CMotion::attach(entity);
+        if (i % 3 != 0) {
+            CHealth::attach(entity);
+            Health health{static_cast<int>(i % 7)};
+            CHealth::set(health, entity);
+        }
+    }
+    auto step = [&pool](ecs::Entity, Motion &motion, const Health &health) {
+        std::atomic<int> push{0};
+        pool.parallelFor(4, 1, [&push, &health](size_t begin, size_t end) {
+            push += static_cast<int>(end - begin) * health.points;
+        });
+        motion.x += motion.v + static_cast<float>(push);
+    };
+    ecs::System<const CMotion> motionWatcher;
+    std::set<ecs::Entity> changed;
+    auto collect = [&changed](ecs::Entity entity, const Motion &) {
+        changed.insert(entity);
+    };
+    std::vector<std::vector<float>> xs;
+    std::vector<std::set<ecs::Entity>> logged;
+    for (bool parallel : {false, true}) {
+        for (size_t i{0}; i < movers.size(); ++i) {
+            Motion motion{0.0f, static_cast<float>(i)};
+            CMotion::set(motion, movers[i]);
+        }
+        motionWatcher.updateChanged([](ecs::Entity, const Motion &) {});
+        ecs::System<CMotion, const CHealth> mover;
+        if (parallel) {
+            mover.updateParallel(step, pool, 64);
+        } else {
+            mover.update(step);
+        }
+        changed.clear();
+        motionWatcher.updateChanged(collect);
+        logged.push_back(changed);
+        xs.emplace_back();
+        for (ecs::Entity entity : movers) {
+            xs.back().push_back(CMotion::get(entity).x);
+        }
+    }
+    EXPECT_EQ(logged[0].size(), 3333UL);
+    EXPECT_EQ((logged[0] == logged[1]), true);
+    EXPECT_EQ((xs[0] == xs[1]), true);
+
+    // Systems conflict when one writes what the other reads or writes.
+    using Reader = ecs::System<const CMotion, const CHealth>;
+    using Writer = ecs::System<CMotion, const CHealth>;
+    using Healer = ecs::System<CHealth>;
+    using Shooter = ecs::System<CProjectile>;
+    EXPECT_EQ((ecs::Conflicts<Reader, Reader>::value), false);
+    EXPECT_EQ((ecs::Conflicts<Reader, Writer>::value), true);
+    EXPECT_EQ((ecs::Conflicts<Writer, Reader>::value), true);
+    EXPECT_EQ((ecs::Conflicts<Writer, Writer>::value), true);
+    EXPECT_EQ((ecs::Conflicts<Writer, Healer>::value), true);
+    EXPECT_EQ((ecs::Conflicts<Writer, Shooter>::value), false);
+    EXPECT_EQ((ecs::Conflicts<Healer, Shooter>::value), false);
+
+    // Wide signatures behave like the integer ones across word boundaries.
+    using Wide = ecs::WideSignature<2>;
+    const Wide low = ecs::signatureBit<Wide>(3);
+    const Wide high = ecs::signatureBit<Wide>(70);
+    const Wide both = low | high;
+    EXPECT_EQ(both.words[0], uint64_t{1} << 3);
+    EXPECT_EQ(both.words[1], uint64_t{1} << 6);
+    EXPECT_EQ((both & high), high);
+    EXPECT_EQ((both & ~high), low);
+    EXPECT_EQ((low & high), Wide{});
+    Wide mask = both;
+    mask &= ~low;
+    EXPECT_EQ(mask, high);
+    mask |= low;
+    EXPECT_EQ(mask, both);
+    EXPECT_EQ((mask != high), true);
+    std::ostringstream text;
+    text << both;
+    EXPECT_EQ(text.str(), std::string{"0x00000000000000400000000000000008"});
+
+    // The configured width holds a bit per component.
+    const ecs::Signature last =
+        ecs::signatureBit(ecs::GLOBAL_MAX_COMPONENTS - 1);
+    EXPECT_EQ((last != ecs::Signature{}), true);
+    EXPECT_EQ(((last & ecs::signatureBit(0)) == ecs::Signature{}), true);
+    EXPECT_EQ(((CHealth::bitSignature() & CProjectile::bitSignature()) ==
+               ecs::Signature{}),
+              true);
+}
@@ -0,0 +1,104 @@
+#include "unit_test.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <vector>
+
+#include "colliderproc.h"
+#include "gltfloader.h"
+
+// An L made of two boxes, the shape of a concave mesh in a gltf::Mesh.
+struct LMesh {
+    std::vector<glm::vec3> positions;
+    std::vector<GLushort> indices;
+    gltf::Buffer positionBuffer;
+    gltf::Buffer indexBuffer;
+    const gltf::Buffer *attributes[1];
+    gltf::Primitive primitive;
+    gltf::Mesh mesh;
+
+    LMesh() {
+        appendBox({0.0f, 0.0f, 0.0f}, {4.0f, 2.0f, 2.0f});
+        appendBox({0.0f, 2.0f, 0.0f}, {2.0f, 4.0f, 2.0f});
+        positionBuffer = {0, gltf::Buffer::VEC3, 0, GL_FLOAT,
+                          reinterpret_cast<unsigned char *>(positions.data()),
+                          positions.size() * sizeof(glm::vec3)};
+        indexBuffer = {1, gltf::Buffer::SCALAR, 0, GL_UNSIGNED_SHORT,
+                       reinterpret_cast<unsigned char *>(indices.data()),
+                       indices.size() * sizeof(GLushort)};
+        attributes[0] = &positionBuffer;
+        primitive = {nullptr, attributes, 1, &indexBuffer};
+        mesh = {"l", &primitive, 1, nullptr};
+    }
+
+    void appendBox(const glm::vec3 &min, const glm::vec3 &max) {
+        const GLushort base = static_cast<GLushort>(positions.size());
+        for (int i = 0; i < 8; ++i) {
+            positions.push_back({i & 1 ? max.x : min.x, i & 2 ? max.y : min.y,
+                                 i & 4 ? max.z : min.z});
+        }
+        static const GLushort faces[]{0, 2, 3, 0, 3, 1, 4, 5, 7, 4, 7, 6,
+                                      0, 1, 5, 0, 5, 4, 2, 6, 7, 2, 7, 3,
+                                      0, 4, 6, 0, 6, 2, 1, 3, 7, 1, 7, 5};
+        for (GLushort index : faces) {
+            indices.push_back(base + index);
+        }
+    }
+};
+
+void TEST() {
+    LMesh l;
+
+    // A concave mesh decomposes into a compound, usable once the TRS is set.
+    auto compound = gltf::loadDecomposedCollider(l.mesh);
+    EXPECT_EQ(static_cast<bool>(compound), true);
+    EXPECT_LT(0UL, compound->positives().size());
+    lix::TRS trs{glm::vec3{10.0f, 0.0f, 0.0f}};
+    compound->setTRS(&trs);
+    lix::Bounds bounds = compound->bounds();
+    EXPECT_LT(std::abs(bounds.min.x - 10.0f), 1e-3f);
+    EXPECT_LT(std::abs(bounds.max.y - 4.0f), 1e-3f);
+    for (const auto &part : compound->positives()) {
+        lix::Bounds partBounds = part->bounds();
+        EXPECT_LT(bounds.min.x - 1e-3f, partBounds.min.x);
+        EXPECT_LT(partBounds.max.x, bounds.max.x + 1e-3f);
+    }
+
+    // Other settings decompose again instead of sharing the cached hulls.
+    lix::DecompositionSettings single;
+    single.maxHulls = 1;
+    auto hull = gltf::loadDecomposedCollider(l.mesh, single);
+    EXPECT_EQ(hull->positives().size(), 0UL);
+    auto again = gltf::loadDecomposedCollider(l.mesh);
+    EXPECT_EQ(again->positives().size(), compound->positives().size());
+
+    // Hulls find the same support points as a scan of the mesh.
+    auto expectHull = [&trs](lix::Polygon &hull, const LMesh &mesh) {
+        for (const glm::vec3 &dir : {glm::vec3{1.0f, 0.2f, 0.1f},
+                                     glm::vec3{-0.3f, 1.0f, 0.2f},
+                                     glm::vec3{0.7f, 0.7f, -0.4f},
+                                     glm::vec3{-1.0f, -0.5f, 0.3f}}) {
+            float best{-FLT_MAX};
+            for (const glm::vec3 &p : mesh.positions) {
+                best = std::max(best, glm::dot(p + trs.translation(), dir));
+            }
+            EXPECT_LT(std::abs(glm::dot(hull.supportPoint(dir), dir) - best),
+                      1e-3f);
+        }
+    };
+    auto convex = gltf::loadMeshCollider(l.mesh, true);
+    convex->setTRS(&trs);
+    expectHull(*convex, l);
+
+    // A hull baked by asproc loads back through the baked path.
+    LMesh b;
+    b.mesh.collider = colliderproc::bakeCollider(b.mesh);
+    EXPECT_EQ(static_cast<bool>(b.mesh.collider), true);
+    EXPECT_EQ(b.mesh.collider->points_size, 10UL); // the L without its corner
+    auto baked = gltf::loadMeshCollider(b.mesh, true);
+    baked->setTRS(&trs);
+    expectHull(*baked, b);
+    bounds = baked->bounds();
+    EXPECT_LT(std::abs(bounds.min.x - 10.0f), 1e-3f);
+    EXPECT_LT(std::abs(bounds.max.y - 4.0f), 1e-3f);
+}
@@ -0,0 +1,948 @@
+#include "unit_test.h"
+
+#include <algorithm>
+#include <deque>
+#include <random>
+#include <vector>
+
+#include "aabb.h"
+#include "aabbtree.h"
+#include "box.h"
+#include "broadphase.h"
+#include "capsule.h"
+#include "collisionquery.h"
+#include "convexdecomposition.h"
+#include "convexhull.h"
+#include "glgeometry.h"
+#include "gltrs.h"
+#include "physicsengine.h"
+#include "physicsquery.h"
+#include "physicsworld.h"
+#include "pointsoa.h"
+#include "polygon.h"
+#include "primer.h"
+#include "primitivecollision.h"
+#include "quickhull.h"
+#include "sphere.h"
+#include "timeofimpact.h"
+
+static lix::Bounds randomBounds(std::mt19937 &rng, float extent, float size) {
+    std::uniform_real_distribution<float> position{-extent, extent};
+    std::uniform_real_distribution<float> side{0.1f, size};
+    glm::vec3 min{position(rng), position(rng), position(rng)};
+    return {min, min + glm::vec3{side(rng), side(rng), side(rng)}};
+}
+
+// Twelve triangles of an axis aligned box, wound outwards.
+static void appendBox(const glm::vec3 &min, const glm::vec3 &max,
+                      std::vector<glm::vec3> &vertices,
+                      std::vector<uint32_t> &indices) {
+    const uint32_t base = static_cast<uint32_t>(vertices.size());
+    for (int i = 0; i < 8; ++i) {
+        vertices.push_back({i & 1 ? max.x : min.x, i & 2 ? max.y : min.y,
+                            i & 4 ? max.z : min.z});
+    }
+    static const uint32_t faces[]{0, 2, 3, 0, 3, 1, 4, 5, 7, 4, 7, 6,
+                                  0, 1, 5, 0, 5, 4, 2, 6, 7, 2, 7, 3,
+                                  0, 4, 6, 0, 6, 2, 1, 3, 7, 1, 7, 5};
+    for (uint32_t index : faces) {
+        indices.push_back(base + index);
+    }
+}
+
+// How far p is outside the hull of points, negative inside.
+static float outsideHull(const std::vector<glm::vec3> &points,
+                         const glm::vec3 &p) {
+    lix::QuickHull hull;
+    hull.build(points);
+    const auto &v = hull.vertices();
+    const auto &i = hull.indices();
+    float outside{-FLT_MAX};
+    for (size_t k{0}; k < i.size(); k += 3) {
+        const glm::vec3 normal = glm::normalize(
+            glm::cross(v[i[k + 1]] - v[i[k]], v[i[k + 2]] - v[i[k]]));
+        outside = std::max(outside, glm::dot(normal, p - v[i[k]]));
+    }
+    return outside;
+}
+
+void TEST() {
+    std::mt19937 rng{7};
+
+    // The tree reports exactly what a brute force scan finds.
+    lix::AABBTree tree;
+    std::vector<lix::Bounds> boxes;
+    std::vector<lix::AABBTree::Proxy> proxies;
+    for (uint32_t i{0}; i < 1000; ++i) {
+        boxes.push_back(randomBounds(rng, 100.0f, 5.0f));
+        proxies.push_back(tree.insert(boxes.back(), i));
+    }
+    EXPECT_EQ(tree.size(), 1000UL);
+    EXPECT_LT(tree.height(), 30);
+
+    auto verify = [&](size_t queries) {
+        for (size_t q{0}; q < queries; ++q) {
+            lix::Bounds query = randomBounds(rng, 100.0f, 20.0f);
+            std::vector<uint32_t> expected;
+            for (uint32_t i{0}; i < boxes.size(); ++i) {
+                if (proxies[i] != lix::AABBTree::NULL_NODE &&
+                    boxes[i].overlaps(query)) {
+                    expected.push_back(i);
+                }
+            }
+            std::vector<uint32_t> found;
+            tree.query(query, [&](lix::AABBTree::Proxy proxy) {
+                found.push_back(tree.userData(proxy));
+            });
+            std::sort(found.begin(), found.end());
+            bool same = found == expected;
+            EXPECT_EQ(same, true);
+        }
+    };
+    verify(200);
+
+    // Move half the boxes and remove a quarter.
+    for (uint32_t i{0}; i < boxes.size(); i += 2) {
+        boxes[i] = randomBounds(rng, 100.0f, 5.0f);
+        tree.move(proxies[i], boxes[i]);
+    }
+    for (uint32_t i{1}; i < boxes.size(); i += 4) {
+        tree.remove(proxies[i]);
+        proxies[i] = lix::AABBTree::NULL_NODE;
+    }
+    EXPECT_EQ(tree.size(), 750UL);
+    EXPECT_LT(tree.height(), 30);
+    verify(200);
+
+    // Small moves stay inside the fat bounds.
+    lix::AABBTree fat;
+    lix::Bounds box{glm::vec3{0.0f}, glm::vec3{1.0f}};
+    auto proxy = fat.insert(box, 0, 0.5f);
+    lix::Bounds nudged{glm::vec3{0.2f}, glm::vec3{1.2f}};
+    EXPECT_EQ(fat.move(proxy, nudged, 0.5f), false);
+    lix::Bounds moved{glm::vec3{5.0f}, glm::vec3{6.0f}};
+    EXPECT_EQ(fat.move(proxy, moved, 0.5f), true);
+
+    // Broad phase pairs cover every overlapping sphere pair.
+    static constexpr size_t NUM_DYNAMIC{64};
+    static constexpr size_t NUM_STATIC{512};
+    std::uniform_real_distribution<float> position{-20.0f, 20.0f};
+    std::vector<lix::TRS> trs(NUM_DYNAMIC + NUM_STATIC);
+    std::vector<std::shared_ptr<lix::Sphere>> spheres;
+    for (auto &t : trs) {
+        t.setTranslation({position(rng), position(rng), position(rng)});
+        spheres.push_back(std::make_shared<lix::Sphere>(&t, 1.0f));
+    }
+    lix::BroadPhase broadPhase;
+    std::vector<lix::BroadPhase::Pair> pairs;
+    for (size_t frame{0}; frame < 3; ++frame) {
+        for (size_t i{0}; i < NUM_DYNAMIC; ++i) {
+            trs[i].applyTranslation({0.5f, -0.25f, 0.1f});
+        }
+        for (size_t i{0}; i < spheres.size(); ++i) {
+            bool dynamic = i < NUM_DYNAMIC;
+            broadPhase.track(*spheres[i],
+                             static_cast<uint32_t>(
+                                 dynamic ? i : i - NUM_DYNAMIC),
+                             dynamic);
+        }
+        broadPhase.prune();
+        broadPhase.findPairs(pairs);
+        for (size_t i{0}; i < NUM_DYNAMIC; ++i) {
+            for (size_t j{0}; j < spheres.size(); ++j) {
+                if (i == j || !spheres[i]->intersects(*spheres[j])) {
+                    continue;
+                }
+                bool dynamic = j < NUM_DYNAMIC;
+                uint32_t a =
+                    static_cast<uint32_t>(dynamic ? std::min(i, j) : i);
+                uint32_t b = static_cast<uint32_t>(
+                    dynamic ? std::max(i, j) : j - NUM_DYNAMIC);
+                bool found = std::any_of(
+                    pairs.begin(), pairs.end(),
+                    [a, b, dynamic](const lix::BroadPhase::Pair &pair) {
+                        return pair.a == a && pair.b == b &&
+                               pair.dynamic == dynamic;
+                    });
+                EXPECT_EQ(found, true);
+            }
+        }
+    }
+    EXPECT_EQ(broadPhase.size(), NUM_DYNAMIC + NUM_STATIC);
+    broadPhase.prune(); // nothing tracked since the last prune
+    EXPECT_EQ(broadPhase.size(), 0UL);
+
+    // A stack of cubes comes to rest on the ground.
+    static constexpr size_t NUM_CUBES{3};
+    const std::vector<glm::vec3> cube =
+        lix::cube_corner_points(glm::vec3{-0.5f}, glm::vec3{0.5f});
+    std::deque<lix::TRS> stackTrs;
+    std::vector<lix::StaticBody> ground;
+    std::vector<lix::DynamicBody> cubes;
+    stackTrs.emplace_back(glm::vec3{0.0f, -0.5f, 0.0f},
+                          glm::quat{1.0f, 0.0f, 0.0f, 0.0f},
+                          glm::vec3{20.0f, 1.0f, 20.0f});
+    ground.push_back(lix::PhysicsEngine::createStaticBody(
+        std::make_shared<lix::Polygon>(&stackTrs.back(), cube)));
+    const glm::quat yaw =
+        glm::angleAxis(0.3f, glm::normalize(glm::vec3{0.05f, 1.0f, 0.03f}));
+    for (size_t i{0}; i < NUM_CUBES; ++i) {
+        stackTrs.emplace_back(glm::vec3{0.0f, 0.51f + i, 0.0f}, yaw,
+                              glm::vec3{1.0f});
+        cubes.push_back(lix::PhysicsEngine::createDynamicBody(
+            std::make_shared<lix::Polygon>(&stackTrs.back(), cube), 1.0f,
+            1.0f));
+    }
+    lix::PhysicsEngine::Context context;
+    context.sleep.timeToSleep = FLT_MAX;
+    for (size_t frame{0}; frame < 300; ++frame) {
+        lix::PhysicsEngine::step(cubes, ground, 1.0f / 60.0f, context);
+    }
+    EXPECT_EQ(context.timings.pairs, NUM_CUBES);
+    EXPECT_LT(3 * NUM_CUBES - 1, context.timings.contacts);
+    for (size_t i{0}; i < NUM_CUBES; ++i) {
+        const glm::vec3 &position = cubes[i].shape->trs()->translation();
+        EXPECT_LT(glm::abs(position.y - (0.5f + i)), 0.02f);
+        EXPECT_LT(glm::length(glm::vec2{position.x, position.z}), 0.1f);
+        EXPECT_LT(glm::length(cubes[i].velocity), 0.01f);
+    }
+
+    // Left to sleep, the resting stack drops out of the step as one island
+    // and wakes as one.
+    lix::PhysicsEngine::Context sleepContext;
+    for (size_t frame{0}; frame < 120; ++frame) {
+        lix::PhysicsEngine::step(cubes, ground, 1.0f / 60.0f, sleepContext);
+    }
+    EXPECT_EQ(sleepContext.timings.sleeping, NUM_CUBES);
+    EXPECT_EQ(sleepContext.timings.pairs, 0UL);
+    const glm::vec3 restingTop = cubes.back().shape->trs()->translation();
+    lix::PhysicsEngine::step(cubes, ground, 1.0f / 60.0f, sleepContext);
+    bool unmoved = cubes.back().shape->trs()->translation() == restingTop;
+    EXPECT_EQ(unmoved, true);
+    cubes.back().velocity = glm::vec3{0.0f, 0.5f, 0.0f};
+    lix::PhysicsEngine::step(cubes, ground, 1.0f / 60.0f, sleepContext);
+    EXPECT_EQ(sleepContext.timings.sleeping, 0UL);
+    EXPECT_EQ(sleepContext.timings.pairs, NUM_CUBES);
+
+    // A body woken mid-step still falls with the step's gravity.
+    std::deque<lix::TRS> wakeTrs;
+    std::vector<lix::DynamicBody> touching;
+    for (float x : {0.0f, 0.9f}) {
+        wakeTrs.emplace_back(glm::vec3{x, 10.0f, 0.0f});
+        touching.push_back(lix::PhysicsEngine::createDynamicBody(
+            std::make_shared<lix::Sphere>(&wakeTrs.back(), 0.5f), 1.0f,
+            1.0f));
+    }
+    lix::PhysicsEngine::Context wakeContext;
+    lix::PhysicsEngine::step(touching, ground, 1.0f / 60.0f, wakeContext);
+    for (auto &body : touching) {
+        body.velocity = glm::vec3{0.0f};
+        body.angularVelocity = glm::vec3{0.0f};
+    }
+    touching.back().sleeping = true;
+    lix::PhysicsEngine::step(touching, ground, 1.0f / 60.0f, wakeContext);
+    EXPECT_EQ(touching.back().sleeping, false);
+    EXPECT_LT(touching[0].velocity.y + touching[1].velocity.y,
+              -1.9f * 9.82f / 60.0f);
+
+    // The threaded narrow phase matches the serial one pair for pair.
+    static constexpr size_t NUM_PILED{400};
+    std::uniform_real_distribution<float> spread{-4.0f, 4.0f};
+    std::uniform_real_distribution<float> angle{0.0f, 6.28f};
+    std::deque<lix::TRS> pileTrs;
+    std::vector<lix::DynamicBody> pile;
+    for (size_t i{0}; i < NUM_PILED; ++i) {
+        pileTrs.emplace_back(
+            glm::vec3{spread(rng), spread(rng), spread(rng)},
+            glm::angleAxis(angle(rng),
+                           glm::normalize(glm::vec3{spread(rng), 1.0f,
+                                                    spread(rng)})),
+            glm::vec3{1.0f});
+        pile.push_back(lix::PhysicsEngine::createDynamicBody(
+            std::make_shared<lix::Polygon>(&pileTrs.back(), cube), 1.0f,
+            1.0f));
+    }
+    lix::BroadPhase pileBroadPhase;
+    const auto &pilePairs = pileBroadPhase.update(pile, ground);
+    std::vector<lix::PhysicsEngine::Contact> serial;
+    std::vector<lix::PhysicsEngine::Contact> threaded;
+    lix::PhysicsEngine::narrowPhase(pilePairs, pile, ground, serial);
+    lix::ThreadPool pool{4};
+    lix::PhysicsEngine::narrowPhase(pilePairs, pile, ground, threaded, &pool);
+    EXPECT_EQ(threaded.size(), serial.size());
+    size_t colliding{0};
+    for (size_t i{0}; i < serial.size(); ++i) {
+        EXPECT_EQ(threaded[i].colliding, serial[i].colliding);
+        if (serial[i].colliding) {
+            ++colliding;
+            const lix::Collision &a = serial[i].collision;
+            const lix::Collision &b = threaded[i].collision;
+            bool same = a.normal == b.normal &&
+                        a.contactPoint == b.contactPoint &&
+                        a.penetrationDepth == b.penetrationDepth;
+            EXPECT_EQ(same, true);
+        }
+    }
+    EXPECT_LT(100UL, colliding);
+
+    // Seeded from the cache, apart pairs are rejected on the first support
+    // query and colliding pairs give the same answer.
+    lix::PairCache pairCache;
+    std::vector<lix::PhysicsEngine::Contact> warm;
+    lix::PhysicsEngine::narrowPhase(pilePairs, pile, ground, warm, nullptr,
+                                    &pairCache);
+    lix::PhysicsEngine::narrowPhase(pilePairs, pile, ground, warm, nullptr,
+                                    &pairCache);
+    EXPECT_EQ(pairCache.size(), pilePairs.size());
+    size_t coldIterations{0};
+    size_t warmIterations{0};
+    for (size_t i{0}; i < serial.size(); ++i) {
+        EXPECT_EQ(warm[i].cached, true);
+        EXPECT_EQ(warm[i].colliding, serial[i].colliding);
+        if (serial[i].colliding) {
+            EXPECT_LT(glm::abs(warm[i].collision.penetrationDepth -
+                               serial[i].collision.penetrationDepth),
+                      1e-3f);
+        } else if (serial[i].gjkIterations <
+                   lix::CollisionQuery::MAX_GJK_ITERATIONS) {
+            EXPECT_EQ(warm[i].gjkIterations, 1U);
+        }
+        coldIterations += serial[i].gjkIterations;
+        warmIterations += warm[i].gjkIterations;
+    }
+    EXPECT_LT(warmIterations, coldIterations);
+
+    // The fixed size GJK/EPA finds the depth of overlapping boxes and spheres.
+    lix::CollisionQuery query;
+    std::uniform_real_distribution<float> offset{-1.2f, 1.2f};
+    lix::TRS originTrs{glm::vec3{0.0f}};
+    lix::TRS otherTrs{glm::vec3{0.0f}};
+    lix::Polygon originCube{&originTrs, cube};
+    lix::Polygon otherCube{&otherTrs, cube};
+    lix::Sphere originSphere{&originTrs, 1.0f};
+    lix::Sphere otherSphere{&otherTrs, 0.5f};
+    for (size_t i{0}; i < 1000; ++i) {
+        const glm::vec3 position{offset(rng), offset(rng), offset(rng)};
+        otherTrs.setTranslation(position)->modelMatrix(); // flush for otherCube
+        const glm::vec3 D =
+            glm::normalize(lix::seedDirection(originCube, otherCube));
+        const glm::vec3 overlap = glm::vec3{1.0f} - glm::abs(position);
+        float depth = std::min({overlap.x, overlap.y, overlap.z});
+        lix::Collision collision;
+        bool hit = query.collides(otherCube, originCube, -D, &collision);
+        if (glm::abs(depth) > 1e-3f) {
+            bool overlapping = depth > 0.0f;
+            EXPECT_EQ(hit, overlapping);
+        }
+        if (hit && depth > 1e-3f) {
+            EXPECT_LT(glm::abs(collision.penetrationDepth - depth), 1e-3f);
+            // Pushes the other cube away from the origin.
+            EXPECT_LT(0.0f, glm::dot(collision.normal, position));
+        }
+
+        depth = 1.5f - glm::length(position);
+        hit = query.collides(otherSphere, originSphere, -D, &collision);
+        if (glm::abs(depth) > 1e-3f) {
+            bool overlapping = depth > 0.0f;
+            EXPECT_EQ(hit, overlapping);
+        }
+        // Deeper than this EPA runs out of vertices on the curved surface
+        // before it gets as exact.
+        if (hit && depth > 1e-3f && depth < 0.5f) {
+            EXPECT_LT(glm::abs(collision.penetrationDepth - depth), 1e-3f);
+        }
+    }
+
+    // Shape::test answers for every pair, closed form or by GJK.
+    lix::Capsule originCapsule{&originTrs, glm::vec3{0.0f, -0.5f, 0.0f},
+                               glm::vec3{0.0f, 0.5f, 0.0f}, 0.5f};
+    lix::Capsule otherCapsule{&otherTrs, glm::vec3{0.0f, -0.5f, 0.0f},
+                              glm::vec3{0.0f, 0.5f, 0.0f}, 0.5f};
+    lix::TRS mirroredTrs{glm::vec3{0.0f}, glm::quat{1.0f, 0.0f, 0.0f, 0.0f},
+                         glm::vec3{-2.0f, 1.0f, 0.5f}};
+    lix::Capsule mirroredCapsule{&mirroredTrs, glm::vec3{0.0f, -0.5f, 0.0f},
+                                 glm::vec3{0.0f, 0.5f, 0.0f}, 0.5f};
+    EXPECT_EQ(mirroredCapsule.worldRadius(), 1.0f);
+    for (float x : {0.8f, 1.2f}) {
+        otherTrs.setTranslation({x, 0.0f, 0.0f})->modelMatrix();
+        const bool touching = x < 1.0f;
+        EXPECT_EQ(otherSphere.test(originCube), touching);
+        EXPECT_EQ(originCube.test(otherSphere), touching);
+        EXPECT_EQ(otherCapsule.test(originCube), touching);
+        EXPECT_EQ(originCube.test(otherCapsule), touching);
+        EXPECT_EQ(otherCube.test(originCube), touching);
+        EXPECT_EQ(otherCapsule.test(originCapsule), touching);
+    }
+
+    // The SIMD support search finds the furthest point, whatever the padding.
+    std::uniform_real_distribution<float> coordinate{-1.0f, 1.0f};
+    for (size_t count : {1UL, 5UL, 37UL, 1000UL}) {
+        std::vector<glm::vec3> cloud;
+        for (size_t i{0}; i < count; ++i) {
+            cloud.push_back(
+                {coordinate(rng), coordinate(rng), coordinate(rng)});
+        }
+        lix::PointSoA soa{cloud};
+        EXPECT_EQ(soa.size(), count);
+        for (size_t i{0}; i < 100; ++i) {
+            const glm::vec3 D{coordinate(rng), coordinate(rng),
+                              coordinate(rng)};
+            size_t expected{0};
+            for (size_t k{1}; k < count; ++k) {
+                if (glm::dot(cloud[k], D) > glm::dot(cloud[expected], D)) {
+                    expected = k;
+                }
+            }
+            EXPECT_EQ(soa.argMaxDot(D), expected);
+        }
+
+        // Searching in model space matches searching the transformed points.
+        const glm::vec3 axis = glm::normalize(glm::vec3{1.0f, 2.0f, 3.0f});
+        lix::TRS cloudTrs{glm::vec3{1.0f, -2.0f, 3.0f},
+                          glm::angleAxis(0.7f, axis),
+                          glm::vec3{2.0f, 0.5f, 1.0f}};
+        lix::Polygon polygon{&cloudTrs, cloud};
+        for (size_t i{0}; i < 100; ++i) {
+            const glm::vec3 D{coordinate(rng), coordinate(rng),
+                              coordinate(rng)};
+            float expected = -FLT_MAX;
+            for (const glm::vec3 &p : polygon.transformedPoints()) {
+                expected = std::max(expected, glm::dot(p, D));
+            }
+            EXPECT_LT(glm::abs(glm::dot(polygon.supportPoint(D), D) - expected),
+                      1e-4f);
+        }
+    }
+
+    // Hill climbing over the hull finds what a full scan finds, and on a
+    // flat top the same vertex wherever it starts.
+    std::vector<glm::vec3> ball;
+    for (size_t i{0}; i < 200; ++i) {
+        ball.push_back(glm::normalize(
+            glm::vec3{coordinate(rng), coordinate(rng), coordinate(rng)}));
+    }
+    for (const auto &cloud : {ball, cube}) {
+        const lix::VertexGraph graph = lix::ConvexHull{cloud}.vertexGraph();
+        EXPECT_EQ(graph.offsets.size(), graph.points.size() + 1);
+        lix::PointSoA soa{graph.points};
+        const glm::vec3 axes[] = {{1.0f, 0.0f, 0.0f}, {0.0f, -1.0f, 0.0f}};
+        for (const glm::vec3 &D : axes) {
+            const size_t expected = soa.argMaxDot(D);
+            for (uint32_t start{0}; start < graph.points.size(); ++start) {
+                EXPECT_EQ(static_cast<size_t>(graph.climb(D, start)),
+                          expected);
+            }
+        }
+        lix::TRS hullTrs{glm::vec3{1.0f, -2.0f, 3.0f},
+                         glm::angleAxis(0.7f, glm::vec3{0.0f, 1.0f, 0.0f}),
+                         glm::vec3{2.0f, 0.5f, 1.0f}};
+        lix::Polygon scanned{&hullTrs, graph.points};
+        lix::Polygon climbed{&hullTrs, graph};
+        for (size_t i{0}; i < 200; ++i) {
+            const glm::vec3 D{coordinate(rng), coordinate(rng),
+                              coordinate(rng)};
+            EXPECT_LT(glm::abs(glm::dot(climbed.supportPoint(D), D) -
+                               glm::dot(scanned.supportPoint(D), D)),
+                      1e-5f);
+            // Wherever the hint points, the same vertex comes out.
+            uint32_t hint = static_cast<uint32_t>(i % graph.points.size());
+            bool same = climbed.hintedSupportPoint(D, hint) ==
+                        climbed.supportPoint(D);
+            EXPECT_EQ(same, true);
+        }
+    }
+
+    // The legacy GJK/EPA finds the depth CollisionQuery does, and a flat
+    // simplex is no contact rather than a hull that can't be built.
+    lix::TRS legacyTrsA{glm::vec3{0.0f}};
+    lix::TRS legacyTrsB{
+        glm::vec3{0.3f, 0.8f, 0.1f},
+        glm::angleAxis(0.4f, glm::normalize(glm::vec3{1.0f, 2.0f, 3.0f})),
+        glm::vec3{1.0f}};
+    lix::Polygon legacyA{&legacyTrsA, cube};
+    lix::Polygon legacyB{&legacyTrsB, cube};
+    lix::Collision legacy;
+    EXPECT_EQ(lix::collides(legacyA, legacyB, &legacy), true);
+    lix::Collision queried;
+    query.collides(legacyA, legacyB, lix::seedDirection(legacyA, legacyB),
+                   &queried);
+    EXPECT_LT(glm::abs(legacy.penetrationDepth - queried.penetrationDepth),
+              1e-3f);
+    const std::vector<glm::vec3> flatSimplex{{0.0f, 0.0f, 0.0f},
+                                             {1.0f, 0.0f, 0.0f},
+                                             {0.0f, 1.0f, 0.0f},
+                                             {1.0f, 1.0f, 0.0f}};
+    EXPECT_EQ(lix::epa(legacyA, legacyB, flatSimplex, &legacy), false);
+
+    // GJK distance and the time of impact of a sphere flying at a wall.
+    lix::TRS wallTrs{glm::vec3{2.5f, 0.0f, 0.0f},
+                     glm::quat{1.0f, 0.0f, 0.0f, 0.0f},
+                     glm::vec3{1.0f, 4.0f, 4.0f}};
+    lix::Polygon wall{&wallTrs, cube};
+    lix::TRS ballTrs{glm::vec3{0.0f, 0.3f, -0.2f}};
+    lix::Sphere shot{&ballTrs, 0.5f};
+    glm::vec3 normal;
+    EXPECT_LT(glm::abs(query.distance(shot, wall, glm::vec3{1.0f, 0.0f, 0.0f},
+                                      normal) -
+                       1.5f),
+              1e-3f);
+    EXPECT_LT(glm::abs(normal.x + 1.0f), 1e-3f);
+    auto impact = lix::timeOfImpact(shot, glm::vec3{10.0f, 0.0f, 0.0f}, 0.0f,
+                                    wall, 1.0f, query);
+    bool impacted = impact.has_value();
+    EXPECT_EQ(impacted, true);
+    EXPECT_LT(glm::abs(impact->time - 0.15f), 1e-3f);
+    bool restored = ballTrs.translation() == glm::vec3{0.0f, 0.3f, -0.2f};
+    EXPECT_EQ(restored, true);
+    impacted = lix::timeOfImpact(shot, glm::vec3{10.0f, 0.0f, 0.0f}, 0.0f,
+                                 wall, 0.1f, query)
+                   .has_value();
+    EXPECT_EQ(impacted, false);
+    // Without translation the search starts from the center line. A turning
+    // shape within tolerance is hit at once, a resting one never is.
+    ballTrs.setTranslation({1.4995f, 0.3f, -0.2f});
+    impact = lix::timeOfImpact(shot, glm::vec3{0.0f}, 1.0f, wall, 1.0f, query);
+    impacted = impact.has_value();
+    EXPECT_EQ(impacted, true);
+    EXPECT_LT(glm::abs(impact->normal.x + 1.0f), 1e-3f);
+    impacted = lix::timeOfImpact(shot, glm::vec3{0.0f}, 0.0f, wall, 1.0f, query)
+                   .has_value();
+    EXPECT_EQ(impacted, false);
+
+    // A fast continuous body stops at a thin wall a discrete one tunnels
+    // through.
+    for (bool continuous : {false, true}) {
+        std::deque<lix::TRS> shotTrs;
+        shotTrs.emplace_back(glm::vec3{5.0f, 0.0f, 0.0f},
+                             glm::quat{1.0f, 0.0f, 0.0f, 0.0f},
+                             glm::vec3{0.05f, 4.0f, 4.0f});
+        shotTrs.emplace_back(glm::vec3{0.0f}, glm::quat{1.0f, 0.0f, 0.0f, 0.0f},
+                             glm::vec3{0.2f});
+        std::vector<lix::StaticBody> thin{lix::PhysicsEngine::createStaticBody(
+            std::make_shared<lix::Polygon>(&shotTrs[0], cube))};
+        std::vector<lix::DynamicBody> bullet{
+            lix::PhysicsEngine::createDynamicBody(
+                std::make_shared<lix::Polygon>(&shotTrs[1], cube), 0.1f,
+                0.2f)};
+        bullet[0].velocity = glm::vec3{290.0f, 0.0f, 0.0f};
+        bullet[0].continuous = continuous;
+        lix::PhysicsEngine::Context shotContext;
+        for (size_t i{0}; i < 10; ++i) {
+            lix::PhysicsEngine::step(bullet, thin, 1.0f / 60.0f, shotContext);
+        }
+        const float x = shotTrs[1].translation().x;
+        bool stopped = x > 4.8f && x < 4.9f; // the wall's face is at 4.975
+        EXPECT_EQ(stopped, continuous);
+    }
+
+    // Scene queries against a row of static cubes.
+    std::deque<lix::TRS> rowTrs;
+    std::vector<lix::StaticBody> row;
+    for (size_t i{0}; i < 3; ++i) {
+        rowTrs.emplace_back(glm::vec3{5.0f + i * 5.0f, 0.0f, 0.0f});
+        row.push_back(lix::PhysicsEngine::createStaticBody(
+            std::make_shared<lix::Polygon>(&rowTrs.back(), cube)));
+    }
+    std::vector<lix::DynamicBody> noDynamics;
+    lix::BroadPhase rowBroadPhase;
+    lix::PhysicsQuery physicsQuery{rowBroadPhase, noDynamics, row};
+    const lix::PhysicsQuery::Ray alongRow{glm::vec3{0.0f, 0.2f, 0.1f},
+                                          glm::vec3{1.0f, 0.0f, 0.0f}, 100.0f};
+    auto hit = physicsQuery.raycast(alongRow);
+    bool found = hit.has_value();
+    EXPECT_EQ(found, true);
+    EXPECT_EQ(hit->index, 0U);
+    EXPECT_LT(glm::abs(hit->distance - 4.5f), 2e-3f);
+    EXPECT_LT(glm::abs(hit->normal.x + 1.0f), 1e-3f);
+    hit = physicsQuery.sphereCast(alongRow, 0.5f);
+    EXPECT_LT(glm::abs(hit->distance - 4.0f), 2e-3f);
+    EXPECT_LT(glm::abs(hit->point.x - 4.5f), 2e-3f);
+    // Starting inside the first cube only the second is hit.
+    hit = physicsQuery.raycast({glm::vec3{5.0f, 0.0f, 0.0f},
+                                glm::vec3{1.0f, 0.0f, 0.0f}, 100.0f});
+    EXPECT_EQ(hit->index, 1U);
+    found = physicsQuery
+                .raycast({glm::vec3{0.0f}, glm::vec3{0.0f, 1.0f, 0.0f}, 100.0f})
+                .has_value();
+    EXPECT_EQ(found, false);
+    found = physicsQuery.raycast({alongRow.origin, alongRow.direction, 4.0f})
+                .has_value();
+    EXPECT_EQ(found, false);
+
+    lix::TRS probeTrs{glm::vec3{10.0f, 0.9f, 0.0f}};
+    lix::Sphere probe{&probeTrs, 0.5f};
+    std::vector<lix::PhysicsQuery::Overlap> overlaps;
+    physicsQuery.overlap(probe, overlaps);
+    EXPECT_EQ(overlaps.size(), 1UL);
+    EXPECT_EQ(overlaps.front().index, 1U);
+
+    // The batch gives the same answers on any number of threads.
+    std::vector<lix::PhysicsQuery::Ray> rays;
+    for (size_t i{0}; i < 1000; ++i) {
+        rays.push_back({glm::vec3{0.0f},
+                        glm::normalize(glm::vec3{1.0f, coordinate(rng) * 0.2f,
+                                                 coordinate(rng) * 0.2f}),
+                        100.0f});
+    }
+    std::vector<std::optional<lix::PhysicsQuery::Hit>> serialHits;
+    std::vector<std::optional<lix::PhysicsQuery::Hit>> threadedHits;
+    physicsQuery.raycast(rays, serialHits);
+    physicsQuery.raycast(rays, threadedHits, &pool);
+    size_t numHits{0};
+    for (size_t i{0}; i < rays.size(); ++i) {
+        bool same = serialHits[i].has_value() == threadedHits[i].has_value();
+        if (same && serialHits[i]) {
+            ++numHits;
+            same = serialHits[i]->index == threadedHits[i]->index &&
+                   serialHits[i]->distance == threadedHits[i]->distance;
+        }
+        EXPECT_EQ(same, true);
+    }
+    EXPECT_LT(100UL, numHits);
+
+    // However the frame time is cut up, and on any number of threads, the
+    // world takes the same fixed steps and ends up with the same bodies. Also
+    // with hull backed boxes, whose support searches tie on every face.
+    const lix::VertexGraph cubeGraph = lix::ConvexHull{cube}.vertexGraph();
+    auto simulate = [&](const std::vector<float> &frames,
+                        lix::ThreadPool *threadPool,
+                        const lix::VertexGraph *graph) {
+        std::deque<lix::TRS> worldTrs;
+        std::vector<lix::StaticBody> floor;
+        std::vector<lix::DynamicBody> falling;
+        worldTrs.emplace_back(glm::vec3{0.0f, -0.5f, 0.0f},
+                              glm::quat{1.0f, 0.0f, 0.0f, 0.0f},
+                              glm::vec3{20.0f, 1.0f, 20.0f});
+        floor.push_back(lix::PhysicsEngine::createStaticBody(
+            std::make_shared<lix::Polygon>(&worldTrs.back(), cube)));
+        for (size_t i{0}; i < 27; ++i) {
+            worldTrs.emplace_back(
+                glm::vec3{i % 3 * 1.1f, 1.0f + i / 9 * 1.2f, i / 3 % 3 * 1.1f},
+                glm::angleAxis(i * 0.1f, glm::vec3{0.0f, 1.0f, 0.0f}),
+                glm::vec3{1.0f});
+            auto box =
+                graph ? std::make_shared<lix::Polygon>(&worldTrs.back(), *graph)
+                      : std::make_shared<lix::Polygon>(&worldTrs.back(), cube);
+            falling.push_back(
+                lix::PhysicsEngine::createDynamicBody(box, 1.0f, 1.0f));
+        }
+        lix::PhysicsWorld world{falling, floor, {1.0f / 64.0f, 2, 8}};
+        world.context().threadPool = threadPool;
+        for (float frame : frames) {
+            world.update(frame);
+        }
+        std::vector<glm::vec3> positions;
+        for (const auto &body : falling) {
+            positions.push_back(body.shape->trs()->translation());
+        }
+        return positions;
+    };
+    const std::vector<float> even(64, 1.0f / 64.0f);
+    std::vector<float> uneven;
+    for (size_t i{0}; i < 4; ++i) {
+        uneven.insert(uneven.end(), {3.0f / 64.0f, 0.0f, 5.0f / 64.0f,
+                                     1.0f / 128.0f, 15.0f / 128.0f});
+    }
+    const auto reference = simulate(even, nullptr, nullptr);
+    bool same = simulate(uneven, nullptr, nullptr) == reference &&
+                simulate(even, &pool, nullptr) == reference;
+    EXPECT_EQ(same, true);
+    const auto climbed = simulate(even, nullptr, &cubeGraph);
+    same = simulate(uneven, nullptr, &cubeGraph) == climbed &&
+           simulate(even, &pool, &cubeGraph) == climbed;
+    EXPECT_EQ(same, true);
+
+    // Drawn between the last two steps.
+    std::vector<lix::DynamicBody> drop{lix::PhysicsEngine::createDynamicBody(
+        std::make_shared<lix::Sphere>(&probeTrs, 0.5f), 1.0f, 1.0f)};
+    std::vector<lix::StaticBody> nothing;
+    lix::PhysicsWorld dropWorld{drop, nothing, {0.25f, 1, 8}};
+    EXPECT_EQ(dropWorld.update(0.625f), 2U);
+    EXPECT_EQ(dropWorld.alpha(), 0.5f);
+    const glm::vec3 second = probeTrs.translation();
+    lix::TRS drawn;
+    dropWorld.interpolate(0, drawn);
+    bool between = drawn.translation().y > second.y;
+    EXPECT_EQ(between, true);
+    dropWorld.update(0.125f);
+    EXPECT_EQ(dropWorld.steps(), 3UL);
+    EXPECT_EQ(dropWorld.alpha(), 0.0f);
+    dropWorld.interpolate(0, drawn);
+    bool atSecond = drawn.translation() == second;
+    EXPECT_EQ(atSecond, true);
+
+    // The closed form contacts agree with GJK/EPA on the same shapes.
+    lix::TRS trsA;
+    lix::TRS trsB;
+    std::vector<std::shared_ptr<lix::Shape>> primitivesA{
+        std::make_shared<lix::Sphere>(&trsA, 0.6f),
+        std::make_shared<lix::Capsule>(&trsA, glm::vec3{0.0f, -0.5f, 0.0f},
+                                       glm::vec3{0.0f, 0.5f, 0.0f}, 0.3f),
+        std::make_shared<lix::Box>(&trsA, glm::vec3{0.5f, 0.3f, 0.7f})};
+    std::vector<std::shared_ptr<lix::Shape>> primitivesB;
+    for (const auto &shape : primitivesA) {
+        primitivesB.emplace_back(shape->clone())->setTRS(&trsB);
+    }
+    lix::CollisionQuery referenceQuery;
+    size_t numCompared{0};
+    for (size_t i{0}; i < 3000; ++i) {
+        trsA.setTranslation(
+            glm::vec3{coordinate(rng), coordinate(rng), coordinate(rng)});
+        trsA.setRotation(glm::angleAxis(
+            angle(rng), glm::normalize(glm::vec3{coordinate(rng), 1.0f,
+                                                 coordinate(rng)})));
+        trsB.setRotation(glm::angleAxis(
+            angle(rng), glm::normalize(glm::vec3{1.0f, coordinate(rng),
+                                                 coordinate(rng)})));
+        trsA.modelMatrix();
+        trsB.modelMatrix();
+        lix::Shape &a = *primitivesA[i % 3];
+        lix::Shape &b = *primitivesB[i / 3 % 3];
+        lix::Collision analytic;
+        lix::Collision reference;
+        const bool hit = lix::primitiveContact(a, b)(a, b, analytic);
+        const bool referenceHit = referenceQuery.collides(
+            a, b, glm::normalize(lix::seedDirection(a, b)), &reference);
+        EXPECT_EQ(hit, referenceHit);
+        if (!hit) {
+            continue;
+        }
+        ++numCompared;
+        // EPA is approximate on the round shapes, and the box pair favours
+        // face axes by 2%.
+        const float depthError =
+            glm::abs(analytic.penetrationDepth - reference.penetrationDepth);
+        EXPECT_LT(depthError, reference.penetrationDepth * 0.02f + 5e-3f);
+        // The contact point is the deepest point of a, and one depth along
+        // the normal is b's surface.
+        const glm::vec3 &n = analytic.normal;
+        const float deepestA =
+            glm::dot(analytic.contactPoint - a.supportPoint(-n), n);
+        const float surfaceB =
+            glm::dot(analytic.contactPoint + n * analytic.penetrationDepth -
+                         b.supportPoint(n),
+                     n);
+        EXPECT_LT(glm::abs(deepestA), 1e-4f);
+        EXPECT_LT(glm::abs(surfaceB), 1e-4f);
+    }
+    EXPECT_LT(1000UL, numCompared);
+    bool convexFallsBack =
+        lix::primitiveContact(*primitivesA[0], *pile[0].shape) == nullptr;
+    EXPECT_EQ(convexFallsBack, true);
+
+    // A box dropped on a box comes to rest on the closed form contacts.
+    std::deque<lix::TRS> boxTrs;
+    boxTrs.emplace_back(glm::vec3{0.0f, -0.5f, 0.0f});
+    boxTrs.emplace_back(
+        glm::vec3{0.0f, 1.0f, 0.0f},
+        glm::angleAxis(0.4f, glm::vec3{0.0f, 1.0f, 0.0f}), glm::vec3{1.0f});
+    std::vector<lix::StaticBody> boxFloor{lix::PhysicsEngine::createStaticBody(
+        std::make_shared<lix::Box>(&boxTrs[0], glm::vec3{10.0f, 0.5f, 10.0f}))};
+    std::vector<lix::DynamicBody> dropped{lix::PhysicsEngine::createDynamicBody(
+        std::make_shared<lix::Box>(&boxTrs[1], glm::vec3{0.5f}), 1.0f, 1.0f)};
+    lix::PhysicsEngine::Context boxContext;
+    boxContext.sleep.timeToSleep = FLT_MAX;
+    for (size_t i{0}; i < 120; ++i) {
+        lix::PhysicsEngine::step(dropped, boxFloor, 1.0f / 60.0f, boxContext);
+    }
+    EXPECT_LT(glm::abs(boxTrs[1].translation().y - 0.5f), 0.02f);
+    EXPECT_EQ(boxContext.timings.gjkIterations, 0UL);
+    EXPECT_LT(0UL, boxContext.timings.contacts);
+
+    // Bounding volumes fitted to a polygon keep enclosing it however it
+    // turns, scales or mirrors, without going over its points again.
+    std::vector<glm::vec3> offCenter;
+    for (size_t i{0}; i < 200; ++i) {
+        offCenter.push_back(glm::vec3{2.0f, 1.0f, -1.0f} +
+                            glm::vec3{coordinate(rng) * 1.5f, coordinate(rng),
+                                      coordinate(rng) * 0.5f});
+    }
+    lix::TRS spinning{glm::vec3{3.0f, -2.0f, 1.0f},
+                      glm::quat{1.0f, 0.0f, 0.0f, 0.0f},
+                      glm::vec3{1.0f, 2.0f, 0.5f}};
+    lix::Polygon exact{&spinning, offCenter};
+    std::vector<std::shared_ptr<lix::Shape>> fittedVolumes{
+        std::make_shared<lix::AABB>(&spinning, &exact),
+        std::make_shared<lix::Box>(&spinning, exact),
+        std::make_shared<lix::Sphere>(&spinning, exact)};
+    for (size_t i{0}; i < 100; ++i) {
+        if (i % 10 == 9) {
+            const float mirror = i % 20 == 19 ? -1.0f : 1.0f;
+            spinning.setScale(glm::vec3{mirror, 2.0f, 0.5f} *
+                              (2.0f + coordinate(rng)));
+        } else {
+            spinning.setRotation(glm::angleAxis(
+                angle(rng), glm::normalize(glm::vec3{coordinate(rng), 1.0f,
+                                                     coordinate(rng)})));
+        }
+        spinning.modelMatrix();
+        const lix::Bounds tight = exact.bounds();
+        for (const auto &volume : fittedVolumes) {
+            lix::Polygon simplified{exact};
+            simplified.setSimplified(volume);
+            const lix::Bounds fitted = simplified.bounds();
+            bool encloses = fitted.expanded(1e-4f).contains(tight);
+            EXPECT_EQ(encloses, true);
+        }
+    }
+    // The box has nothing to spare along its own axes.
+    const glm::vec3 along = fittedVolumes[1]->supportPoint(
+        glm::mat3(spinning.rotationMatrix())[0]);
+    const float reach =
+        glm::dot(along - exact.supportPoint(
+                             glm::mat3(spinning.rotationMatrix())[0]),
+                 glm::mat3(spinning.rotationMatrix())[0]);
+    EXPECT_LT(glm::abs(reach), 1e-4f);
+
+    // QuickHull keeps every point inside and drops the ones on faces.
+    std::vector<glm::vec3> boxed{cube};
+    for (size_t i{0}; i < 2000; ++i) {
+        boxed.push_back(
+            glm::vec3{coordinate(rng), coordinate(rng), coordinate(rng)} *
+            0.5f);
+        boxed.push_back({0.5f, coordinate(rng) * 0.5f, coordinate(rng) * 0.5f});
+    }
+    lix::QuickHull quickHull;
+    bool built = quickHull.build(boxed);
+    EXPECT_EQ(built, true);
+    EXPECT_EQ(quickHull.vertices().size(), 8UL);
+    EXPECT_EQ(quickHull.indices().size(), 36UL);
+    for (const auto &cloud : {ball, offCenter}) {
+        quickHull.build(cloud);
+        const auto &vertices = quickHull.vertices();
+        const auto &indices = quickHull.indices();
+        // A closed triangle mesh of genus 0: V - E + F = 2.
+        const size_t numFaces = indices.size() / 3;
+        EXPECT_EQ(vertices.size() + numFaces - numFaces * 3 / 2, 2UL);
+        float outside{0.0f};
+        for (size_t i{0}; i < indices.size(); i += 3) {
+            const glm::vec3 &a = vertices[indices[i]];
+            const glm::vec3 normal = glm::normalize(
+                glm::cross(vertices[indices[i + 1]] - a,
+                           vertices[indices[i + 2]] - a));
+            for (const glm::vec3 &p : cloud) {
+                outside = std::max(outside, glm::dot(normal, p - a));
+            }
+        }
+        EXPECT_LT(outside, 1e-5f);
+    }
+    EXPECT_EQ(quickHull.build(ball), true);
+    EXPECT_EQ(quickHull.vertices().size(), ball.size());
+    const std::vector<glm::vec3> flat{{0.0f, 0.0f, 0.0f},
+                                      {1.0f, 0.0f, 0.0f},
+                                      {0.0f, 0.0f, 1.0f},
+                                      {1.0f, 0.0f, 1.0f},
+                                      {0.5f, 0.0f, 0.5f}};
+    EXPECT_EQ(quickHull.build(flat), false);
+    EXPECT_EQ(quickHull.indices().size(), 0UL);
+
+    // Welding gives what the pairwise scan gave, and says where each point
+    // went.
+    std::vector<glm::vec3> seams;
+    for (size_t i{0}; i < 3000; ++i) {
+        const glm::vec3 corner =
+            glm::floor(glm::vec3{coordinate(rng), coordinate(rng),
+                                 coordinate(rng)} *
+                       8.0f) *
+            0.125f;
+        seams.push_back(corner + glm::vec3{coordinate(rng) * 1e-3f});
+    }
+    std::vector<glm::vec3> scanned;
+    for (const glm::vec3 &p : seams) {
+        if (!lix::containsVertex(scanned, p)) {
+            scanned.push_back(p);
+        }
+    }
+    std::vector<uint32_t> remap;
+    const std::vector<glm::vec3> welded = lix::weldVertices(seams, remap);
+    bool sameWeld = welded == scanned;
+    EXPECT_EQ(sameWeld, true);
+    EXPECT_EQ(remap.size(), seams.size());
+    for (size_t i{0}; i < seams.size(); ++i) {
+        bool close = lix::isSameVertex(seams[i], welded[remap[i]]);
+        EXPECT_EQ(close, true);
+    }
+
+    // An L decomposes into parts that leave its notch out but keep all of
+    // it in.
+    std::vector<glm::vec3> lVertices;
+    std::vector<uint32_t> lIndices;
+    appendBox({0.0f, 0.0f, 0.0f}, {4.0f, 2.0f, 2.0f}, lVertices, lIndices);
+    appendBox({0.0f, 2.0f, 0.0f}, {2.0f, 4.0f, 2.0f}, lVertices, lIndices);
+    const auto lHulls = lix::convexDecomposition(lVertices, lIndices);
+    EXPECT_LT(1UL, lHulls.size());
+    float notch{FLT_MAX};
+    for (const auto &hull : lHulls) {
+        notch = std::min(notch, outsideHull(hull, {3.0f, 3.0f, 1.0f}));
+    }
+    EXPECT_LT(0.5f, notch);
+    for (const glm::vec3 &vertex : lVertices) {
+        float outside{FLT_MAX};
+        for (const auto &hull : lHulls) {
+            outside = std::min(outside, outsideHull(hull, vertex));
+        }
+        EXPECT_LT(outside, 1e-4f);
+    }
+
+    // A box dropped into the notch rests on the lower arm, where the hull of
+    // the whole L would have held it up on its slope.
+    std::deque<lix::TRS> lTrs;
+    lTrs.emplace_back(glm::vec3{0.0f});
+    lTrs.emplace_back(glm::vec3{3.0f, 4.0f, 1.0f});
+    auto compound = lix::compoundShape(&lTrs[0], lHulls);
+    EXPECT_EQ(compound->positives().size(), lHulls.size() - 1);
+    std::vector<lix::StaticBody> level{
+        lix::PhysicsEngine::createStaticBody(compound)};
+    std::vector<lix::DynamicBody> intoNotch{
+        lix::PhysicsEngine::createDynamicBody(
+            std::make_shared<lix::Box>(&lTrs[1], glm::vec3{0.25f}), 1.0f,
+            0.5f)};
+    lix::PhysicsEngine::Context notchContext;
+    notchContext.sleep.timeToSleep = FLT_MAX;
+    for (size_t i{0}; i < 180; ++i) {
+        lix::PhysicsEngine::step(intoNotch, level, 1.0f / 60.0f,
+                                 notchContext);
+    }
+    EXPECT_LT(glm::abs(lTrs[1].translation().y - 2.25f), 0.05f);
+
+    // A layer of boxes starting on a fresh L lands the same on the pool, the
+    // parts are refit before the workers read their bounds.
+    auto rain = [&](lix::ThreadPool *threadPool) {
+        std::deque<lix::TRS> rainTrs;
+        rainTrs.emplace_back(glm::vec3{0.0f});
+        std::vector<lix::StaticBody> fresh{
+            lix::PhysicsEngine::createStaticBody(
+                lix::compoundShape(&rainTrs[0], lHulls))};
+        std::vector<lix::DynamicBody> drops;
+        for (size_t i{0}; i < 64; ++i) {
+            rainTrs.emplace_back(glm::vec3{0.25f + i % 8 * 0.5f, 4.05f,
+                                           0.125f + i / 8 * 0.25f});
+            drops.push_back(lix::PhysicsEngine::createDynamicBody(
+                std::make_shared<lix::Box>(&rainTrs.back(), glm::vec3{0.1f}),
+                1.0f, 0.2f));
+        }
+        lix::PhysicsEngine::Context rainContext;
+        rainContext.threadPool = threadPool;
+        for (size_t i{0}; i < 30; ++i) {
+            lix::PhysicsEngine::step(drops, fresh, 1.0f / 60.0f, rainContext);
+        }
+        std::vector<glm::vec3> positions;
+        for (const auto &body : drops) {
+            positions.push_back(body.shape->trs()->translation());
+        }
+        return positions;
+    };
+    same = rain(&pool) == rain(nullptr);
+    EXPECT_EQ(same, true);
+
+    // Rays down onto either arm hit the part under them.
+    lix::BroadPhase levelBroadPhase;
+    lix::PhysicsQuery levelQuery{levelBroadPhase, noDynamics, level};
+    for (float x : {1.0f, 3.0f}) {
+        auto top = levelQuery.raycast({glm::vec3{x, 10.0f, 1.0f},
+                                       glm::vec3{0.0f, -1.0f, 0.0f}, 20.0f});
+        found = top.has_value();
+        EXPECT_EQ(found, true);
+        EXPECT_LT(glm::abs(top->point.y - (x < 2.0f ? 4.0f : 2.0f)), 2e-3f);
+    }
+}
@@ -0,0 +1,153 @@
+#include "unit_test.h"
+
+#include <cmath>
+#include <random>
+
+#include "glnode.h"
+#include "glthreadpool.h"
+#include "gltransformhierarchy.h"
+
+static float difference(const glm::mat4 &a, const glm::mat4 &b) {
+    float d{0.0f};
+    for (int c = 0; c < 4; ++c) {
+        for (int r = 0; r < 4; ++r) {
+            d = std::max(d, std::abs(a[c][r] - b[c][r]));
+        }
+    }
+    return d;
+}
+
+// Same random tree twice, one to track and one left to Node itself.
+static void appendTrees(lix::Node &tracked, lix::Node &plain, int depth,
+                        std::mt19937 &rng) {
+    if (depth == 0) {
+        return;
+    }
+    int numChildren = 1 + static_cast<int>(rng() % 3);
+    for (int i = 0; i < numChildren; ++i) {
+        auto a = std::make_shared<lix::Node>();
+        auto b = std::make_shared<lix::Node>();
+        tracked.appendChild(a);
+        plain.appendChild(b);
+        appendTrees(*a, *b, depth - 1, rng);
+    }
+}
+
+static void move(lix::Node &node, std::mt19937 &rng) {
+    std::uniform_real_distribution<float> dist{-1.0f, 1.0f};
+    glm::vec3 t{dist(rng), dist(rng), dist(rng)};
+    glm::quat q = glm::normalize(
+        glm::quat{1.0f + std::abs(dist(rng)), dist(rng), dist(rng), dist(rng)});
+    node.setTranslation(t);
+    node.setRotation(q);
+}
+
+static float maxDifference(const std::vector<lix::Node *> &tracked,
+                           const std::vector<lix::Node *> &plain) {
+    float d{0.0f};
+    for (size_t i = 0; i < tracked.size(); ++i) {
+        d = std::max(d, difference(tracked[i]->globalMatrix(),
+                                   plain[i]->globalMatrix()));
+    }
+    return d;
+}
+
+void TEST() {
+    std::mt19937 rng{7};
+    std::vector<lix::NodePtr> trackedRoots;
+    std::vector<lix::NodePtr> plainRoots;
+    std::vector<lix::Node *> roots;
+    for (int i = 0; i < 8; ++i) {
+        trackedRoots.push_back(std::make_shared<lix::Node>());
+        plainRoots.push_back(std::make_shared<lix::Node>());
+        appendTrees(*trackedRoots.back(), *plainRoots.back(), 4, rng);
+        roots.push_back(trackedRoots.back().get());
+    }
+
+    lix::TransformHierarchy hierarchy;
+    hierarchy.build(roots);
+    std::vector<lix::Node *> tracked;
+    std::vector<lix::Node *> plain;
+    for (size_t i = 0; i < roots.size(); ++i) {
+        for (lix::Node *node : trackedRoots[i]->listNodes()) {
+            tracked.push_back(node);
+        }
+        for (lix::Node *node : plainRoots[i]->listNodes()) {
+            plain.push_back(node);
+        }
+    }
+    EXPECT_EQ(hierarchy.size(), tracked.size());
+
+    // Parents come before their children.
+    for (uint32_t i = 0; i < hierarchy.size(); ++i) {
+        lix::Node *node = hierarchy.nodes()[i];
+        EXPECT_EQ(node->hierarchyIndex(), i);
+        if (node->parent()) {
+            EXPECT_LT(node->parent()->hierarchyIndex(), i);
+        }
+    }
+
+    // Random moves, read through globalMatrix and after pooled updates.
+    lix::ThreadPool pool{4};
+    for (int round = 0; round < 20; ++round) {
+        for (int i = 0; i < 10; ++i) {
+            size_t index = rng() % tracked.size();
+            move(*plain[index], rng);
+            tracked[index]->setTranslation(plain[index]->translation());
+            tracked[index]->setRotation(plain[index]->rotation());
+        }
+        if (round % 2) {
+            hierarchy.update(&pool);
+        }
+        EXPECT_LT(maxDifference(tracked, plain), 1e-4f);
+    }
+
+    // Appending a child rebuilds the arrays on the next read.
+    auto child = std::make_shared<lix::Node>(glm::vec3{0.0f, 2.0f, 0.0f});
+    lix::Node *parent = tracked.back();
+    parent->appendChild(child);
+    move(*parent, rng);
+    EXPECT_LT(difference(child->globalMatrix(),
+                         parent->globalMatrix() * child->modelMatrix()),
+              1e-4f);
+    EXPECT_EQ(hierarchy.size(), tracked.size() + 1);
+
+    // A removed subtree leaves the hierarchy and keeps its local transform.
+    lix::NodePtr removed = trackedRoots[0]->children().front();
+    EXPECT_EQ(trackedRoots[0]->removeChild(removed), true);
+    EXPECT_EQ(trackedRoots[0]->removeChild(removed), false);
+    move(*trackedRoots[0], rng);
+    EXPECT_LT(difference(trackedRoots[1]->globalMatrix(),
+                         plainRoots[1]->globalMatrix()),
+              1e-4f);
+    EXPECT_LT(difference(removed->globalMatrix(), removed->modelMatrix()),
+              1e-4f);
+    const size_t withoutRemoved = hierarchy.size();
+    EXPECT_LT(withoutRemoved, tracked.size() + 1);
+
+    // Dropped subtrees leave the hierarchy.
+    while (!trackedRoots[2]->children().empty()) {
+        trackedRoots[2]->removeChild(trackedRoots[2]->children().back());
+    }
+    EXPECT_LT(difference(trackedRoots[1]->globalMatrix(),
+                         plainRoots[1]->globalMatrix()),
+              1e-4f);
+    EXPECT_LT(hierarchy.size(), withoutRemoved);
+
+    // Visits parents first with their world matrices, and skips what is
+    // under an invisible node.
+    trackedRoots[1]->children().front()->setVisible(false);
+    size_t visited{0};
+    hierarchy.forEachVisible(
+        [&](lix::Node &node, const glm::mat4 &world) {
+            EXPECT_EQ(node.visible(), true);
+            for (lix::Node *p = node.parent(); p; p = p->parent()) {
+                EXPECT_EQ(p->visible(), true);
+            }
+            EXPECT_LT(difference(world, node.globalMatrix()), 1e-4f);
+            ++visited;
+        },
+        &pool);
+    size_t hidden = trackedRoots[1]->children().front()->listNodes().size();
+    EXPECT_EQ(visited, hierarchy.size() - hidden);
+}
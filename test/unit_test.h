@@ -1,5 +1,6 @@
 #pragma once
 
+#include <chrono>
 #include <fstream>
 #include <iostream>
 
@@ -30,4 +31,17 @@ inline std::ostream &operator<<(std::ostream &os, const glm::vec3 &v) {
     return os;
 }
 
+// Runs callback once and prints the time spent per operation.
+template <typename F>
+static double benchmark(const char *label, size_t operations, F callback) {
+    auto t0 = std::chrono::steady_clock::now();
+    callback();
+    auto t1 = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(t1 - t0).count();
+    double nsPerOp = ns / static_cast<double>(operations);
+    std::cout << label << ": " << operations << " ops, " << nsPerOp
+              << " ns/op" << std::endl;
+    return nsPerOp;
+}
+
 void TEST();
\ No newline at end of file